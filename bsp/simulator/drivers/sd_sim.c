@@ -5,6 +5,9 @@
 #include <string.h>
 #endif
 #include <dfs_def.h>
+#if defined(RT_USING_BLK_QUEUE) || defined(RT_USING_BLK_CACHE)
+#include <rtdevice.h>
+#endif
 
 // #define SD_TRACE     rt_kprintf
 #define SD_TRACE(...)
@@ -179,8 +182,22 @@ rt_err_t rt_hw_sdcard_init(const char *spi_device_name)
     device->control = rt_sdcard_control;
     device->user_data = NULL;
 
+#ifdef RT_USING_BLK_CACHE
+    /* the card is accessed through the sector cache device "sd0" */
+    rt_device_register(device, "sdcard",
+                       RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_REMOVABLE | RT_DEVICE_FLAG_STANDALONE);
+#else
     rt_device_register(device, "sd0",
                        RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_REMOVABLE | RT_DEVICE_FLAG_STANDALONE);
+#endif
+#ifdef RT_USING_BLK_QUEUE
+    /* sort and merge the sector requests of file system */
+    rt_blk_queue_attach(device, 0);
+#endif
+#ifdef RT_USING_BLK_CACHE
+    if (rt_blk_cache_create("sd0", device, 0, RT_BLK_CACHE_READAHEAD) == RT_NULL)
+        return -RT_ERROR;
+#endif
 
     return RT_EOK;
 }
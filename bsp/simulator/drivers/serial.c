@@ -193,7 +193,7 @@ static rt_err_t rt_serial_control(rt_device_t dev, rt_uint8_t cmd, void *args)
 /*
  * serial register
  */
-rt_err_t rt_hw_serial_register(rt_device_t device, const char *name, rt_uint32_t flag)
+static rt_err_t rt_serial_register(rt_device_t device, const char *name, rt_uint32_t flag)
 {
     RT_ASSERT(device != RT_NULL);
     device->type        = RT_Device_Class_Char;
@@ -213,6 +213,6 @@ rt_err_t rt_hw_serial_register(rt_device_t device, const char *name, rt_uint32_t
 
 rt_err_t rt_hw_serial_init(struct serial_device * serial, char * name)
 {
-    return rt_hw_serial_register(RT_DEVICE(serial), name,
+    return rt_serial_register(RT_DEVICE(serial), name,
                                  RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_INT_RX | RT_DEVICE_FLAG_STREAM);
 }
@@ -28,6 +28,139 @@
 struct serial_device serial1;
 
 #define SAVEKEY(key)  seial_save_byte(key, &serial1)
+
+#if defined(RT_USING_SERIAL) && defined(RT_USING_UART1)
+/*
+ * uart1 is a loopback port of serial framework, which receives the data
+ * transmitted by itself in DMA mode:
+ *  - the transmitted data is copied into the DMA receiving buffer, a full
+ *    buffer is completed with RT_SERIAL_EVENT_RX_DMADONE;
+ *  - the line is idle after the data is transmitted, the idle timer ends the
+ *    received frame and completes the transmitting.
+ */
+#define UART1_DMA_SIZE      64
+#define UART1_POOL_SIZE     1024
+
+static struct rt_serial_device uart1;
+static struct serial_dma_rx uart1_dma_rx;
+static rt_uint8_t uart1_pool[UART1_POOL_SIZE];
+static rt_uint8_t uart1_dma_buffer[2][UART1_DMA_SIZE];
+static struct rt_timer uart1_idle_timer;
+
+/* the DMA receiving buffer */
+static char *uart1_rx_buffer;
+static rt_size_t uart1_rx_size, uart1_rx_count;
+
+static void uart1_loopback(const char *buf, rt_size_t size)
+{
+    rt_size_t length;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    while (size && uart1_rx_size)
+    {
+        length = uart1_rx_size - uart1_rx_count;
+        if (length > size)
+            length = size;
+
+        rt_memcpy(uart1_rx_buffer + uart1_rx_count, buf, length);
+        uart1_rx_count += length;
+        buf  += length;
+        size -= length;
+
+        /* the next buffer is started in ISR */
+        if (uart1_rx_count == uart1_rx_size)
+            rt_hw_serial_dma_rx_isr(&uart1, uart1_rx_count, RT_SERIAL_EVENT_RX_DMADONE);
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+static void uart1_idle_timeout(void *parameter)
+{
+    if (uart1_rx_size)
+        rt_hw_serial_dma_rx_isr(&uart1, uart1_rx_count, RT_SERIAL_EVENT_RX_IDLE);
+
+    /*
+     * the next data is transmitted in here, a timer could not be started in
+     * its own timeout, so the periodic timer keeps running until all is sent
+     */
+    rt_hw_serial_dma_tx_isr(&uart1);
+    if (uart1.dma_flag == RT_FALSE)
+        rt_timer_stop(&uart1_idle_timer);
+}
+
+static rt_err_t uart1_configure(struct rt_serial_device *serial, struct serial_configure *cfg)
+{
+    return RT_EOK;
+}
+
+static rt_err_t uart1_control(struct rt_serial_device *serial, int cmd, void *arg)
+{
+    return RT_EOK;
+}
+
+static int uart1_putc(struct rt_serial_device *serial, char c)
+{
+    uart1_loopback(&c, 1);
+    rt_timer_start(&uart1_idle_timer);
+
+    return 1;
+}
+
+static int uart1_getc(struct rt_serial_device *serial)
+{
+    return -1;
+}
+
+static rt_size_t uart1_dma_transmit(struct rt_serial_device *serial, const char *buf, rt_size_t size)
+{
+    uart1_loopback(buf, size);
+    rt_timer_start(&uart1_idle_timer);
+
+    return size;
+}
+
+static rt_size_t uart1_dma_receive(struct rt_serial_device *serial, char *buf, rt_size_t size)
+{
+    uart1_rx_buffer = buf;
+    uart1_rx_size   = size;
+    uart1_rx_count  = 0;
+
+    return size;
+}
+
+static const struct rt_uart_ops uart1_ops =
+{
+    uart1_configure,
+    uart1_control,
+    uart1_putc,
+    uart1_getc,
+    uart1_dma_transmit,
+    uart1_dma_receive,
+};
+
+static void rt_hw_uart1_init(void)
+{
+    struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+
+    uart1_dma_rx.pool          = uart1_pool;
+    uart1_dma_rx.pool_size     = sizeof(uart1_pool);
+    uart1_dma_rx.dma_buffer[0] = uart1_dma_buffer[0];
+    uart1_dma_rx.dma_buffer[1] = uart1_dma_buffer[1];
+    uart1_dma_rx.dma_size      = UART1_DMA_SIZE;
+
+    uart1.ops    = &uart1_ops;
+    uart1.config = config;
+    uart1.dma_rx = &uart1_dma_rx;
+
+    rt_timer_init(&uart1_idle_timer, "uart1", uart1_idle_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+
+    rt_hw_serial_register(&uart1, "uart1",
+                          RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_DMA_RX | RT_DEVICE_FLAG_DMA_TX,
+                          RT_NULL);
+}
+#endif
 #ifdef _WIN32
 /*
  * Handler for OSKey Thread
@@ -39,6 +172,9 @@ static DWORD WINAPI ThreadforKeyGet(LPVOID lpParam);
 void rt_hw_usart_init(void)
 {
     rt_hw_serial_init(&serial1, RT_CONSOLE_DEVICE_NAME);
+#if defined(RT_USING_SERIAL) && defined(RT_USING_UART1)
+    rt_hw_uart1_init();
+#endif
     /*
      * create serial thread that receive key input from keyboard
      */
@@ -81,6 +217,9 @@ static pthread_t OSKey_Thread;
 void rt_hw_usart_init(void)
 {
     int res;
+#if defined(RT_USING_SERIAL) && defined(RT_USING_UART1)
+    rt_hw_uart1_init();
+#endif
     res = pthread_create(&OSKey_Thread, NULL, &ThreadforKeyGet, NULL);
     if (res)
     {
@@ -42,6 +42,9 @@
 /* Tick per Second */
 #define RT_TICK_PER_SECOND	100
 
+/* Using memset/memcpy/memcmp of libcpu, the posix simulator port has SSE2 ones */
+/* #define RT_USING_CPU_MEMOPS */
+
 /* SECTION: RT_DEBUG */
 /* Thread Debug */
 #define RT_DEBUG
@@ -53,13 +56,43 @@
 /* Using Hook */
 #define RT_USING_HOOK
 
+/* Using scheduler statistics of thread and interrupt lock, which are listed
+ * by list_sched, the port shall implement rt_hw_stat_clock */
+/* #define RT_USING_SCHED_STAT */
+/* the shortest interrupt lock accounted to its call site, in microsecond */
+#define RT_SCHED_STAT_IRQ_MIN	1
+
+/* Using stack sampler in idle thread, the high-water mark is listed by list_stack */
+/* #define RT_USING_STACK_SAMPLER */
+/* numbers of stack words scanned in each idle loop */
+#define RT_STACK_SAMPLER_WORDS		32
+/* margin in percent of the suggested stack size over the high-water mark */
+#define RT_STACK_SAMPLER_MARGIN		25
+
 /* Using Software Timer */
 /* #define RT_USING_TIMER_SOFT */
 #define RT_TIMER_THREAD_PRIO		4
 #define RT_TIMER_THREAD_STACK_SIZE	512
 #define RT_TIMER_TICK_PER_SECOND	10
 
+/* Using hierarchical timing wheel for timer, O(1) start/stop */
+/* #define RT_USING_TIMER_WHEEL */
+/* 2^RT_TIMER_WHEEL_BITS slots on each level of the timing wheel */
+#define RT_TIMER_WHEEL_BITS		6
+
+/* Using tickless idle, stop the periodic tick when system is idle */
+/* only supported by the posix simulator port */
+/* #define RT_USING_TICKLESS */
+
+/* Using name hash index for finding object */
+/* #define RT_USING_OBJECT_HASH */
+/* the number of hash buckets of each object class, a power of two */
+#define RT_OBJECT_HASH_SIZE		16
+
 /* SECTION: IPC */
+/* Using priority indexed suspend queue for RT_IPC_FLAG_PRIO_QUEUE objects */
+/* #define RT_USING_IPC_PRIO_QUEUE */
+
 /* Using Semaphore*/
 #define RT_USING_SEMAPHORE
 
@@ -78,6 +111,14 @@
 /* SECTION: Memory Management */
 /* Using Memory Pool Management*/
 /* #define RT_USING_MEMPOOL */
+/* Using lock-free memory pool, interrupt is disabled only to suspend thread */
+/* it needs rt_hw_atomic_cas of cpu, which is in cortex-m3/m4 and simulator */
+/* #define RT_USING_MEMPOOL_LOCKFREE */
+
+/* Using object cache in front of heap for kernel objects, needs mempool */
+/* #define RT_USING_OBJECT_CACHE */
+/* the default number of objects in warm reserve of each object class */
+#define RT_OBJECT_CACHE_RESERVE	4
 
 /* Using Dynamic Heap Management */
 #define RT_USING_HEAP
@@ -86,10 +127,43 @@
 #define RT_USING_SMALL_MEM
 /* #define RT_TINY_SIZE */
 
+/* Using magazines of small chunks for each priority band in Slab MM */
+/* #define RT_USING_SLAB_MAGAZINE */
+#define RT_SLAB_MAGAZINE_SIZE	8
+#define RT_SLAB_MAGAZINE_BAND	4
+
+/* Using TLSF MM, O(1) malloc and free, instead of Small MM */
+/* #define RT_USING_TLSF */
+
+/* Using handle heap of movable blocks, compacted by idle thread */
+/* #define RT_USING_HANDLE_HEAP */
+
+/* Using heap allocation profiler of call sites, listed by list_memprof */
+/* #define RT_USING_MEM_PROFILER */
+#define RT_MEM_PROFILER_SITES	64
+#define RT_MEM_PROFILER_BLOCKS	512
+
 /* SECTION: Device System */
 /* Using Device System */
 #define RT_USING_DEVICE
 #define RT_USING_DEVICE_IPC
+/* Using asynchronous request interface of device, rt_device_submit/cancel */
+/* #define RT_USING_DEVICE_ASYNC */
+/* Using block request queue, which sorts and merges sector requests of DFS */
+/* it needs RT_USING_DEVICE_ASYNC, statistics are listed by list_blkq */
+/* #define RT_USING_BLK_QUEUE */
+/* the max sectors of a merged transfer */
+#define RT_BLK_QUEUE_MAX_SECTORS	16
+/* Using write-back LRU sector cache over block device, listed by list_bcache */
+/* #define RT_USING_BLK_CACHE */
+/* the number of sectors in cache */
+#define RT_BLK_CACHE_SECTORS		64
+/* the sectors read ahead for sequential reading */
+#define RT_BLK_CACHE_READAHEAD		8
+/* the ticks between periodic flush of dirty sectors */
+#define RT_BLK_CACHE_FLUSH_TICKS	(RT_TICK_PER_SECOND * 2)
+/* Using serial framework, uart1 is a loopback port in DMA receiving mode */
+/* #define RT_USING_SERIAL */
 /* #define RT_USING_UART1 */
 
 /* SECTION: Console options */
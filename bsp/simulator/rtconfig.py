@@ -29,6 +29,9 @@ else :
 BUILD = 'debug'
 #BUILD = ''
 
+# memory budget of components, (RAM, ROM) in bytes, checked after linking
+# MEM_BUDGET = {'Total': (4 * 1024 * 1024, None), 'Kernel': (64 * 1024, None)}
+
 if PLATFORM == 'gcc':
     # toolchains
     PREFIX = ''
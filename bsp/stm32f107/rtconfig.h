@@ -59,6 +59,8 @@
 /* Using Device System */
 #define RT_USING_DEVICE
 #define RT_USING_SPI
+/* Using SPI bus message queue for asynchronous transfer, listed by list_spi */
+/* #define RT_USING_SPI_QUEUE */
 
 /* SECTION: Console options */
 #define RT_USING_CONSOLE
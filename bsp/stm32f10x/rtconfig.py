@@ -38,6 +38,9 @@ if os.getenv('RTT_EXEC_PATH'):
 
 BUILD = 'debug'
 
+# memory budget of components, (RAM, ROM) in bytes, checked after linking
+# MEM_BUDGET = {'Total': (64 * 1024, 512 * 1024), 'Kernel': (8 * 1024, 32 * 1024)}
+
 if PLATFORM == 'gcc':
     # toolchains
     PREFIX = 'arm-none-eabi-'
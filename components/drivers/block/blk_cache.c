@@ -0,0 +1,620 @@
+/*
+ * File      : blk_cache.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Sector cache of block device.
+ *
+ * The cache is a block device over another block device. The sectors are kept
+ * in a LRU list and indexed by a hash of sector number:
+ *  - the missed sectors of a read are read from device in one transfer, and
+ *    the following sectors are read ahead if the reading is sequential;
+ *  - a write only updates the cache and marks the sectors dirty, the dirty
+ *    sectors are written back when they are evicted, by the flusher thread
+ *    periodically, or by RT_DEVICE_CTRL_BLK_SYNC;
+ *  - a flush writes the dirty sectors in order of sector, the adjacent ones
+ *    are written in one transfer.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+
+static rt_list_t _blk_cache_list = RT_LIST_OBJECT_INIT(_blk_cache_list);
+
+#define BLK_CACHE(dev)  ((struct rt_blk_cache *)(dev))
+
+rt_inline rt_list_t *_cache_bucket(struct rt_blk_cache *cache, rt_uint32_t sector)
+{
+    return &(cache->hash[sector & cache->hash_mask]);
+}
+
+static struct rt_blk_cache_entry *_cache_lookup(struct rt_blk_cache *cache,
+                                                rt_uint32_t          sector)
+{
+    rt_list_t *bucket, *node;
+    struct rt_blk_cache_entry *entry;
+
+    bucket = _cache_bucket(cache, sector);
+    for (node = bucket->next; node != bucket; node = node->next)
+    {
+        entry = rt_list_entry(node, struct rt_blk_cache_entry, hash);
+        if (entry->sector == sector)
+            return entry;
+    }
+
+    return RT_NULL;
+}
+
+rt_inline void _cache_touch(struct rt_blk_cache *cache, struct rt_blk_cache_entry *entry)
+{
+    rt_list_remove(&(entry->lru));
+    rt_list_insert_after(&(cache->lru), &(entry->lru));
+}
+
+static rt_err_t _cache_writeback(struct rt_blk_cache *cache,
+                                 rt_uint32_t          sector,
+                                 const void          *buffer,
+                                 rt_size_t            count)
+{
+    if (rt_device_write(cache->lower, sector, buffer, count) != count)
+        return -RT_EIO;
+
+    cache->writebacks += count;
+
+    return RT_EOK;
+}
+
+/* get the least recently used entry for sector, it's not valid */
+static struct rt_blk_cache_entry *_cache_alloc(struct rt_blk_cache *cache,
+                                               rt_uint32_t          sector)
+{
+    struct rt_blk_cache_entry *entry;
+
+    entry = rt_list_entry(cache->lru.prev, struct rt_blk_cache_entry, lru);
+    if (entry->valid)
+    {
+        if (entry->dirty)
+        {
+            if (_cache_writeback(cache, entry->sector, entry->data, 1) != RT_EOK)
+                return RT_NULL;
+
+            entry->dirty = 0;
+            cache->dirty --;
+        }
+        rt_list_remove(&(entry->hash));
+    }
+
+    entry->sector = sector;
+    entry->valid  = 0;
+    rt_list_insert_after(_cache_bucket(cache, sector), &(entry->hash));
+    _cache_touch(cache, entry);
+
+    return entry;
+}
+
+static void _cache_invalidate(struct rt_blk_cache *cache, struct rt_blk_cache_entry *entry)
+{
+    rt_list_remove(&(entry->hash));
+    rt_list_init(&(entry->hash));
+    entry->valid = 0;
+
+    /* reused first */
+    rt_list_remove(&(entry->lru));
+    rt_list_insert_before(&(cache->lru), &(entry->lru));
+}
+
+/* write back all the dirty sectors, the lock is taken */
+static rt_err_t _cache_flush(struct rt_blk_cache *cache)
+{
+    rt_uint32_t index, count, number, i, j;
+    struct rt_blk_cache_entry *entry;
+    rt_err_t result = RT_EOK;
+
+    if (cache->dirty == 0)
+        return RT_EOK;
+
+    /* sort the dirty entries by sector */
+    number = 0;
+    for (index = 0; index < cache->count; index ++)
+    {
+        entry = &(cache->entries[index]);
+        if (!entry->valid || !entry->dirty)
+            continue;
+
+        for (i = number; i > 0 && cache->sorted[i - 1]->sector > entry->sector; i --)
+            cache->sorted[i] = cache->sorted[i - 1];
+        cache->sorted[i] = entry;
+        number ++;
+    }
+
+    /* write the adjacent sectors in one transfer */
+    for (index = 0; index < number; index += count)
+    {
+        count = 1;
+        while (index + count < number && count < cache->staging_sectors &&
+               cache->sorted[index + count]->sector == cache->sorted[index]->sector + count)
+            count ++;
+
+        if (count == 1)
+        {
+            if (_cache_writeback(cache, cache->sorted[index]->sector,
+                                 cache->sorted[index]->data, 1) != RT_EOK)
+            {
+                result = -RT_EIO;
+                continue;
+            }
+        }
+        else
+        {
+            for (j = 0; j < count; j ++)
+                rt_memcpy(cache->staging + j * cache->sector_size,
+                          cache->sorted[index + j]->data, cache->sector_size);
+
+            if (_cache_writeback(cache, cache->sorted[index]->sector,
+                                 cache->staging, count) != RT_EOK)
+            {
+                result = -RT_EIO;
+                continue;
+            }
+        }
+
+        for (j = 0; j < count; j ++)
+            cache->sorted[index + j]->dirty = 0;
+        cache->dirty -= count;
+    }
+
+    return result;
+}
+
+static rt_err_t rt_blk_cache_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    return rt_device_open(BLK_CACHE(dev)->lower, oflag);
+}
+
+static rt_err_t rt_blk_cache_close(rt_device_t dev)
+{
+    struct rt_blk_cache *cache = BLK_CACHE(dev);
+
+    rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+    _cache_flush(cache);
+    rt_mutex_release(&(cache->lock));
+
+    return rt_device_close(cache->lower);
+}
+
+static rt_size_t rt_blk_cache_read(rt_device_t dev,
+                                   rt_off_t    pos,
+                                   void       *buffer,
+                                   rt_size_t   size)
+{
+    rt_uint32_t index, count, total, sector, j;
+    rt_uint8_t *ptr = (rt_uint8_t *)buffer;
+    struct rt_blk_cache_entry *entry;
+    struct rt_blk_cache *cache = BLK_CACHE(dev);
+    rt_bool_t sequential;
+
+    rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+    sequential = (rt_uint32_t)pos == cache->next_sector;
+
+    for (index = 0; index < size; index += count)
+    {
+        sector = pos + index;
+
+        entry = _cache_lookup(cache, sector);
+        if (entry != RT_NULL)
+        {
+            rt_memcpy(ptr + index * cache->sector_size, entry->data, cache->sector_size);
+            _cache_touch(cache, entry);
+            cache->hits ++;
+            count = 1;
+            continue;
+        }
+
+        /* the missed sectors */
+        count = 1;
+        while (index + count < size && count < cache->staging_sectors &&
+               _cache_lookup(cache, sector + count) == RT_NULL)
+            count ++;
+
+        /* read ahead the following sectors which are not cached */
+        total = count;
+        if (sequential && index + count == size)
+        {
+            while (total < count + cache->readahead && total < cache->staging_sectors &&
+                   sector + total < cache->sector_count &&
+                   _cache_lookup(cache, sector + total) == RT_NULL)
+                total ++;
+        }
+
+        if (rt_device_read(cache->lower, sector, cache->staging, total) != total)
+            break;
+
+        for (j = 0; j < total; j ++)
+        {
+            entry = _cache_alloc(cache, sector + j);
+            if (entry == RT_NULL)
+                break;
+
+            rt_memcpy(entry->data, cache->staging + j * cache->sector_size, cache->sector_size);
+            entry->valid = 1;
+        }
+        if (j < total)
+            break;
+
+        rt_memcpy(ptr + index * cache->sector_size, cache->staging, count * cache->sector_size);
+        cache->misses += count;
+        cache->readaheads += total - count;
+    }
+    cache->next_sector = pos + index;
+    rt_mutex_release(&(cache->lock));
+
+    if (index < size)
+        rt_set_errno(-RT_EIO);
+
+    return index;
+}
+
+static rt_size_t rt_blk_cache_write(rt_device_t dev,
+                                    rt_off_t    pos,
+                                    const void *buffer,
+                                    rt_size_t   size)
+{
+    rt_uint32_t index;
+    const rt_uint8_t *ptr = (const rt_uint8_t *)buffer;
+    struct rt_blk_cache_entry *entry;
+    struct rt_blk_cache *cache = BLK_CACHE(dev);
+
+    rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+    if (size >= cache->count / 2)
+    {
+        /* write through a large write, the cached sectors are updated */
+        for (index = 0; index < size; index ++)
+        {
+            entry = _cache_lookup(cache, pos + index);
+            if (entry == RT_NULL)
+                continue;
+
+            rt_memcpy(entry->data, ptr + index * cache->sector_size, cache->sector_size);
+            if (entry->dirty)
+            {
+                entry->dirty = 0;
+                cache->dirty --;
+            }
+        }
+
+        index = 0;
+        if (_cache_writeback(cache, pos, ptr, size) == RT_EOK)
+            index = size;
+        else
+        {
+            /* the cached sectors are not the same as device */
+            for (index = 0; index < size; index ++)
+            {
+                entry = _cache_lookup(cache, pos + index);
+                if (entry != RT_NULL)
+                    _cache_invalidate(cache, entry);
+            }
+            index = 0;
+        }
+        rt_mutex_release(&(cache->lock));
+
+        if (index < size)
+            rt_set_errno(-RT_EIO);
+
+        return index;
+    }
+
+    for (index = 0; index < size; index ++)
+    {
+        entry = _cache_lookup(cache, pos + index);
+        if (entry == RT_NULL)
+        {
+            entry = _cache_alloc(cache, pos + index);
+            if (entry == RT_NULL)
+                break;
+        }
+        else
+        {
+            _cache_touch(cache, entry);
+        }
+
+        rt_memcpy(entry->data, ptr + index * cache->sector_size, cache->sector_size);
+        entry->valid = 1;
+        if (!entry->dirty)
+        {
+            entry->dirty = 1;
+            cache->dirty ++;
+        }
+    }
+    rt_mutex_release(&(cache->lock));
+
+    if (index < size)
+        rt_set_errno(-RT_EIO);
+
+    return index;
+}
+
+static rt_err_t rt_blk_cache_control(rt_device_t dev, rt_uint8_t cmd, void *args)
+{
+    rt_err_t result;
+    struct rt_blk_cache *cache = BLK_CACHE(dev);
+
+    if (cmd == RT_DEVICE_CTRL_BLK_SYNC)
+    {
+        rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+        result = _cache_flush(cache);
+        rt_mutex_release(&(cache->lock));
+
+        if (result != RT_EOK)
+            return result;
+    }
+    else if (cmd == RT_DEVICE_CTRL_BLK_ERASE)
+    {
+        /* the erased sectors are dropped from cache */
+        struct rt_device_blk_sectors *sectors = (struct rt_device_blk_sectors *)args;
+        rt_uint32_t index;
+
+        rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+        for (index = 0; index < cache->count; index ++)
+        {
+            struct rt_blk_cache_entry *entry = &(cache->entries[index]);
+
+            if (entry->valid && entry->sector >= sectors->sector_begin &&
+                entry->sector <= sectors->sector_end)
+            {
+                if (entry->dirty)
+                {
+                    entry->dirty = 0;
+                    cache->dirty --;
+                }
+                _cache_invalidate(cache, entry);
+            }
+        }
+        rt_mutex_release(&(cache->lock));
+    }
+
+    return rt_device_control(cache->lower, cmd, args);
+}
+
+static void _cache_flusher(void *parameter)
+{
+    struct rt_blk_cache *cache = (struct rt_blk_cache *)parameter;
+
+    while (!cache->exit)
+    {
+        rt_sem_take(&(cache->sem), RT_BLK_CACHE_FLUSH_TICKS);
+
+        rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+        _cache_flush(cache);
+        rt_mutex_release(&(cache->lock));
+    }
+
+    rt_completion_done(&(cache->exited));
+}
+
+/**
+ * This function will create a sector cache device over a block device.
+ *
+ * @param name the name of cache device
+ * @param lower the cached block device
+ * @param sectors the number of sectors in cache, 0 for RT_BLK_CACHE_SECTORS
+ * @param readahead the sectors read ahead for sequential reading
+ *
+ * @return the cache device, or RT_NULL on failure.
+ */
+rt_device_t rt_blk_cache_create(const char *name,
+                                rt_device_t lower,
+                                rt_uint32_t sectors,
+                                rt_uint32_t readahead)
+{
+    struct rt_blk_cache *cache;
+    struct rt_device_blk_geometry geometry;
+    rt_uint32_t index, buckets;
+    register rt_base_t level;
+
+    RT_ASSERT(lower != RT_NULL);
+
+    if (lower->type != RT_Device_Class_Block)
+        return RT_NULL;
+
+    rt_memset(&geometry, 0, sizeof(geometry));
+    if (rt_device_control(lower, RT_DEVICE_CTRL_BLK_GETGEOME, &geometry) != RT_EOK ||
+        geometry.bytes_per_sector == 0)
+        return RT_NULL;
+
+    if (sectors == 0)
+        sectors = RT_BLK_CACHE_SECTORS;
+    if (sectors < 2)
+        sectors = 2;
+    /* one hash bucket for every two sectors */
+    for (buckets = 1; buckets < sectors / 2; buckets <<= 1) ;
+
+    cache = (struct rt_blk_cache *)rt_malloc(sizeof(struct rt_blk_cache));
+    if (cache == RT_NULL)
+        return RT_NULL;
+    rt_memset(cache, 0, sizeof(struct rt_blk_cache));
+
+    cache->lower           = lower;
+    cache->sector_size     = geometry.bytes_per_sector;
+    cache->sector_count    = geometry.sector_count;
+    cache->count           = sectors;
+    cache->hash_mask       = buckets - 1;
+    cache->readahead       = readahead;
+    /* the multi-sector transfer takes half of cache at most */
+    cache->staging_sectors = readahead + 1;
+    if (cache->staging_sectors > sectors / 2)
+        cache->staging_sectors = sectors / 2;
+    cache->next_sector     = RT_UINT32_MAX;
+
+    cache->entries = (struct rt_blk_cache_entry *)rt_malloc(sectors * sizeof(struct rt_blk_cache_entry));
+    cache->sorted  = (struct rt_blk_cache_entry **)rt_malloc(sectors * sizeof(struct rt_blk_cache_entry *));
+    cache->hash    = (rt_list_t *)rt_malloc(buckets * sizeof(rt_list_t));
+    cache->staging = (rt_uint8_t *)rt_malloc((sectors + cache->staging_sectors) * cache->sector_size);
+    if (cache->entries == RT_NULL || cache->sorted == RT_NULL ||
+        cache->hash == RT_NULL || cache->staging == RT_NULL)
+        goto __failed;
+
+    rt_list_init(&(cache->lru));
+    for (index = 0; index < buckets; index ++)
+        rt_list_init(&(cache->hash[index]));
+    for (index = 0; index < sectors; index ++)
+    {
+        struct rt_blk_cache_entry *entry = &(cache->entries[index]);
+
+        /* the data of entries follow the staging buffer */
+        entry->data  = cache->staging + (cache->staging_sectors + index) * cache->sector_size;
+        entry->valid = 0;
+        entry->dirty = 0;
+        rt_list_init(&(entry->hash));
+        rt_list_insert_before(&(cache->lru), &(entry->lru));
+    }
+
+    rt_mutex_init(&(cache->lock), name, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&(cache->sem), name, 0, RT_IPC_FLAG_FIFO);
+    rt_completion_init(&(cache->exited));
+
+    cache->flusher = rt_thread_create(name, _cache_flusher, cache,
+                                      RT_BLK_CACHE_THREAD_STACK_SIZE,
+                                      RT_BLK_CACHE_THREAD_PRIORITY, 20);
+    if (cache->flusher == RT_NULL)
+    {
+        rt_sem_detach(&(cache->sem));
+        rt_mutex_detach(&(cache->lock));
+        goto __failed;
+    }
+
+    cache->parent.type    = RT_Device_Class_Block;
+    cache->parent.open    = rt_blk_cache_open;
+    cache->parent.close   = rt_blk_cache_close;
+    cache->parent.read    = rt_blk_cache_read;
+    cache->parent.write   = rt_blk_cache_write;
+    cache->parent.control = rt_blk_cache_control;
+    if (rt_device_register(&(cache->parent), name, lower->flag &
+        (RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_REMOVABLE | RT_DEVICE_FLAG_STANDALONE)) != RT_EOK)
+    {
+        rt_thread_delete(cache->flusher);
+        rt_sem_detach(&(cache->sem));
+        rt_mutex_detach(&(cache->lock));
+        goto __failed;
+    }
+
+    level = rt_hw_interrupt_disable();
+    rt_list_insert_before(&_blk_cache_list, &(cache->list));
+    rt_hw_interrupt_enable(level);
+
+    rt_thread_startup(cache->flusher);
+
+    return &(cache->parent);
+
+__failed:
+    rt_free(cache->staging);
+    rt_free(cache->hash);
+    rt_free(cache->sorted);
+    rt_free(cache->entries);
+    rt_free(cache);
+
+    return RT_NULL;
+}
+
+/**
+ * This function will write back the dirty sectors of cache to device.
+ *
+ * @param dev the cache device
+ *
+ * @return the error code, RT_EOK on successfully.
+ */
+rt_err_t rt_blk_cache_flush(rt_device_t dev)
+{
+    rt_err_t result;
+    struct rt_blk_cache *cache = BLK_CACHE(dev);
+
+    RT_ASSERT(dev != RT_NULL);
+
+    rt_mutex_take(&(cache->lock), RT_WAITING_FOREVER);
+    result = _cache_flush(cache);
+    rt_mutex_release(&(cache->lock));
+
+    return result;
+}
+
+/**
+ * This function will flush and destroy a cache device.
+ *
+ * @param dev the cache device
+ *
+ * @return the error code, RT_EOK on successfully.
+ */
+rt_err_t rt_blk_cache_destroy(rt_device_t dev)
+{
+    struct rt_blk_cache *cache = BLK_CACHE(dev);
+    register rt_base_t level;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    if (dev->ref_count != 0)
+        return -RT_EBUSY;
+
+    /* stop the flusher, then write back the rest of dirty sectors */
+    cache->exit = 1;
+    rt_sem_release(&(cache->sem));
+    rt_completion_wait(&(cache->exited), RT_WAITING_FOREVER);
+    _cache_flush(cache);
+
+    level = rt_hw_interrupt_disable();
+    rt_list_remove(&(cache->list));
+    rt_hw_interrupt_enable(level);
+
+    rt_device_unregister(dev);
+    rt_sem_detach(&(cache->sem));
+    rt_mutex_detach(&(cache->lock));
+
+    rt_free(cache->staging);
+    rt_free(cache->hash);
+    rt_free(cache->sorted);
+    rt_free(cache->entries);
+    rt_free(cache);
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_bcache(void)
+{
+    rt_list_t *node;
+    struct rt_blk_cache *cache;
+    rt_uint32_t ratio;
+
+    rt_kprintf(" device  sectors dirty   hits    misses  readahead writeback hit\n");
+    rt_kprintf("-------- ------- ----- -------- -------- --------- --------- ----\n");
+    for (node = _blk_cache_list.next; node != &_blk_cache_list; node = node->next)
+    {
+        cache = rt_list_entry(node, struct rt_blk_cache, list);
+
+        ratio = cache->hits + cache->misses;
+        ratio = ratio ? cache->hits * 100 / ratio : 0;
+        rt_kprintf("%-8.*s %7d %5d %8d %8d %9d %9d %3d%%\n",
+                   RT_NAME_MAX, cache->parent.parent.name,
+                   cache->count, cache->dirty, cache->hits, cache->misses,
+                   cache->readaheads, cache->writebacks, ratio);
+    }
+}
+FINSH_FUNCTION_EXPORT(list_bcache, list block sector cache statistics);
+#endif
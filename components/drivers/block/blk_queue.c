@@ -0,0 +1,610 @@
+/*
+ * File      : blk_queue.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Block request queue.
+ *
+ * The queue is attached to a block device, it takes over the read/write
+ * interface of device and provides the asynchronous request interface. The
+ * read/write of file system becomes a request which is waited by its caller.
+ *
+ * The requests are kept in the pending list sorted by sector position. A
+ * request is never moved in front of an earlier request which overlaps it,
+ * so the order of accesses to the same sectors is kept.
+ *
+ * The dispatcher thread takes all the pending requests as a batch, and the
+ * adjacent requests of the same direction in batch are merged into one
+ * transfer of device (multi-block read/write of mmcsd). The merged requests
+ * are transferred through a bounce buffer if their buffers are not contiguous.
+ *
+ * The queue could be plugged to gather more requests into a batch, the batch
+ * is dispatched when the queue is unplugged, when the queue depth reaches
+ * RT_BLK_QUEUE_BATCH or after RT_BLK_QUEUE_PLUG_TICKS.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+
+static rt_list_t _blk_queue_list = RT_LIST_OBJECT_INIT(_blk_queue_list);
+
+/* find the queue of device and take a reference, which keeps it from freed */
+static struct rt_blk_queue *_blk_queue_get(rt_device_t dev)
+{
+    rt_list_t *node;
+    struct rt_blk_queue *queue;
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    for (node = _blk_queue_list.next; node != &_blk_queue_list; node = node->next)
+    {
+        queue = rt_list_entry(node, struct rt_blk_queue, list);
+        if (queue->device == dev)
+        {
+            queue->ref ++;
+            rt_hw_interrupt_enable(level);
+
+            return queue;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return RT_NULL;
+}
+
+/* release the reference of queue, the detacher waits for the last one */
+static void _blk_queue_put(struct rt_blk_queue *queue)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    queue->ref --;
+    if (queue->ref == 0 && queue->exit)
+    {
+        rt_hw_interrupt_enable(level);
+
+        rt_completion_done(&(queue->released));
+
+        return;
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+rt_inline rt_bool_t _blk_overlap(struct rt_device_request *a,
+                                 struct rt_device_request *b)
+{
+    return a->pos < b->pos + (rt_off_t)b->size &&
+           b->pos < a->pos + (rt_off_t)a->size;
+}
+
+static rt_err_t _blk_submit(rt_device_t dev, struct rt_device_request *req)
+{
+    rt_list_t *node;
+    struct rt_blk_queue *queue;
+    struct rt_device_request *prev;
+    register rt_base_t level;
+
+    if (req->type != RT_DEVICE_REQ_READ && req->type != RT_DEVICE_REQ_WRITE)
+        return -RT_ENOSYS;
+
+    queue = _blk_queue_get(dev);
+    if (queue == RT_NULL)
+        return -RT_EIO;
+
+    level = rt_hw_interrupt_disable();
+    if (queue->exit)
+    {
+        rt_hw_interrupt_enable(level);
+        _blk_queue_put(queue);
+
+        return -RT_EIO;
+    }
+
+    /* move to the sorted position, but not in front of an overlapped one */
+    for (node = queue->pending.prev; node != &(queue->pending); node = node->prev)
+    {
+        prev = rt_list_entry(node, struct rt_device_request, list);
+        if (prev->pos <= req->pos || _blk_overlap(prev, req))
+            break;
+    }
+    rt_list_insert_after(node, &(req->list));
+
+    queue->depth ++;
+    queue->requests ++;
+    if (queue->depth > queue->max_depth)
+        queue->max_depth = queue->depth;
+    rt_hw_interrupt_enable(level);
+
+    rt_sem_release(&(queue->sem));
+    _blk_queue_put(queue);
+
+    return RT_EOK;
+}
+
+static rt_err_t _blk_cancel(rt_device_t dev, struct rt_device_request *req)
+{
+    rt_list_t *node;
+    struct rt_blk_queue *queue;
+    register rt_base_t level;
+
+    queue = _blk_queue_get(dev);
+    if (queue == RT_NULL)
+        return -RT_EBUSY;
+
+    level = rt_hw_interrupt_disable();
+    for (node = queue->pending.next; node != &(queue->pending); node = node->next)
+    {
+        if (node == &(req->list))
+        {
+            rt_list_remove(node);
+            queue->depth --;
+            rt_hw_interrupt_enable(level);
+            _blk_queue_put(queue);
+
+            rt_device_request_done(dev, req, 0, -RT_EINTR);
+
+            return RT_EOK;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+    _blk_queue_put(queue);
+
+    /* it's dispatched */
+    return -RT_EBUSY;
+}
+
+static rt_size_t _blk_transfer(rt_device_t dev,
+                               rt_uint8_t  type,
+                               rt_off_t    pos,
+                               void       *buffer,
+                               rt_size_t   size)
+{
+    rt_err_t result;
+    struct rt_device_request req;
+    struct rt_completion completion;
+
+    rt_device_request_init(&req, type, pos, buffer, size, RT_NULL, RT_NULL);
+    rt_completion_bind_request(&completion, &req);
+
+    result = rt_device_submit(dev, &req);
+    if (result == RT_EOK)
+    {
+        rt_completion_wait(&completion, RT_WAITING_FOREVER);
+        result = req.error;
+    }
+
+    if (result != RT_EOK)
+    {
+        rt_set_errno(result);
+
+        return 0;
+    }
+
+    return req.result;
+}
+
+static rt_size_t _blk_read(rt_device_t dev,
+                           rt_off_t    pos,
+                           void       *buffer,
+                           rt_size_t   size)
+{
+    return _blk_transfer(dev, RT_DEVICE_REQ_READ, pos, buffer, size);
+}
+
+static rt_size_t _blk_write(rt_device_t dev,
+                            rt_off_t    pos,
+                            const void *buffer,
+                            rt_size_t   size)
+{
+    return _blk_transfer(dev, RT_DEVICE_REQ_WRITE, pos, (void *)buffer, size);
+}
+
+/* transfer a run of adjacent requests by one read/write of device */
+static void _blk_dispatch_run(struct rt_blk_queue *queue, rt_list_t *run,
+                              rt_size_t count, rt_bool_t contiguous)
+{
+    rt_size_t size;
+    rt_uint8_t *ptr;
+    rt_off_t pos;
+    rt_err_t error;
+    struct rt_device_request *req;
+
+    req = rt_list_entry(run->next, struct rt_device_request, list);
+    pos = req->pos;
+
+    if (contiguous)
+    {
+        /* one request, or the buffers are contiguous */
+        ptr = (rt_uint8_t *)req->buffer;
+    }
+    else
+    {
+        ptr = queue->bounce;
+        if (req->type == RT_DEVICE_REQ_WRITE)
+        {
+            rt_list_t *node;
+            rt_uint8_t *bounce = ptr;
+
+            for (node = run->next; node != run; node = node->next)
+            {
+                req = rt_list_entry(node, struct rt_device_request, list);
+                rt_memcpy(bounce, req->buffer, req->size * queue->sector_size);
+                bounce += req->size * queue->sector_size;
+            }
+        }
+    }
+
+    if (req->type == RT_DEVICE_REQ_READ)
+        size = queue->read(queue->device, pos, ptr, count);
+    else
+        size = queue->write(queue->device, pos, ptr, count);
+    error = (size == count) ? RT_EOK : -RT_EIO;
+
+    queue->transfers ++;
+
+    /* complete the requests of run */
+    while (!rt_list_isempty(run))
+    {
+        register rt_base_t level;
+
+        req = rt_list_entry(run->next, struct rt_device_request, list);
+        rt_list_remove(&(req->list));
+
+        if (!contiguous && req->type == RT_DEVICE_REQ_READ && error == RT_EOK)
+            rt_memcpy(req->buffer, ptr, req->size * queue->sector_size);
+        ptr += req->size * queue->sector_size;
+
+        level = rt_hw_interrupt_disable();
+        queue->depth --;
+        rt_hw_interrupt_enable(level);
+
+        rt_device_request_done(queue->device, req,
+                               error == RT_EOK ? req->size : 0, error);
+    }
+}
+
+static void _blk_dispatch(struct rt_blk_queue *queue, rt_list_t *batch)
+{
+    rt_list_t run;
+    rt_size_t count;
+    rt_bool_t contiguous;
+    struct rt_device_request *req, *last, *next;
+
+    rt_list_init(&run);
+    while (!rt_list_isempty(batch))
+    {
+        req = rt_list_entry(batch->next, struct rt_device_request, list);
+        rt_list_remove(&(req->list));
+        rt_list_insert_before(&run, &(req->list));
+        count = req->size;
+        contiguous = RT_TRUE;
+
+        /* merge the adjacent requests of the same direction */
+        last = req;
+        while (!rt_list_isempty(batch))
+        {
+            next = rt_list_entry(batch->next, struct rt_device_request, list);
+            if (next->type != req->type ||
+                next->pos != last->pos + (rt_off_t)last->size ||
+                count + next->size > queue->max_sectors)
+                break;
+
+            if ((rt_uint8_t *)next->buffer !=
+                (rt_uint8_t *)last->buffer + last->size * queue->sector_size)
+                contiguous = RT_FALSE;
+
+            rt_list_remove(&(next->list));
+            rt_list_insert_before(&run, &(next->list));
+            count += next->size;
+            queue->merged ++;
+            last = next;
+        }
+
+        _blk_dispatch_run(queue, &run, count, contiguous);
+    }
+}
+
+static void _blk_dispatcher(void *parameter)
+{
+    rt_list_t batch;
+    struct rt_blk_queue *queue;
+    struct rt_device_request *req;
+    register rt_base_t level;
+
+    queue = (struct rt_blk_queue *)parameter;
+    rt_list_init(&batch);
+
+    while (1)
+    {
+        rt_sem_take(&(queue->sem), RT_WAITING_FOREVER);
+
+        /* gather more requests if the queue is plugged */
+        while (queue->plugged && !queue->exit && queue->depth < RT_BLK_QUEUE_BATCH)
+        {
+            if (rt_sem_take(&(queue->sem), RT_BLK_QUEUE_PLUG_TICKS) != RT_EOK)
+                break;
+        }
+
+        /* take all the pending requests */
+        level = rt_hw_interrupt_disable();
+        if (!rt_list_isempty(&(queue->pending)))
+        {
+            batch.next = queue->pending.next;
+            batch.prev = queue->pending.prev;
+            batch.next->prev = &batch;
+            batch.prev->next = &batch;
+            rt_list_init(&(queue->pending));
+        }
+        rt_hw_interrupt_enable(level);
+
+        if (queue->exit)
+            break;
+
+        _blk_dispatch(queue, &batch);
+    }
+
+    /* fail the requests of a detached queue */
+    while (!rt_list_isempty(&batch))
+    {
+        req = rt_list_entry(batch.next, struct rt_device_request, list);
+        rt_list_remove(&(req->list));
+        rt_device_request_done(queue->device, req, 0, -RT_EIO);
+    }
+
+    rt_completion_done(&(queue->exited));
+}
+
+/**
+ * This function will attach a request queue to a block device, the read/write
+ * of device are queued and merged after that.
+ *
+ * @param dev the block device
+ * @param max_sectors the max sectors of a transfer of device, 0 for no limit.
+ *        A merged transfer is at most RT_BLK_QUEUE_MAX_SECTORS sectors.
+ *
+ * @return the error code, RT_EOK on successfully.
+ */
+rt_err_t rt_blk_queue_attach(rt_device_t dev, rt_uint32_t max_sectors)
+{
+    struct rt_blk_queue *queue;
+    struct rt_device_blk_geometry geometry;
+    register rt_base_t level;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    if (dev->type != RT_Device_Class_Block || dev->read == RT_NULL)
+        return -RT_ERROR;
+    /* the device handles the requests by itself */
+    if (dev->flag & RT_DEVICE_FLAG_ASYNC)
+        return -RT_EBUSY;
+
+    if (max_sectors == 0 || max_sectors > RT_BLK_QUEUE_MAX_SECTORS)
+        max_sectors = RT_BLK_QUEUE_MAX_SECTORS;
+
+    rt_memset(&geometry, 0, sizeof(geometry));
+    if (dev->control != RT_NULL)
+        dev->control(dev, RT_DEVICE_CTRL_BLK_GETGEOME, &geometry);
+    if (geometry.bytes_per_sector == 0)
+        geometry.bytes_per_sector = 512;
+
+    queue = (struct rt_blk_queue *)rt_malloc(sizeof(struct rt_blk_queue));
+    if (queue == RT_NULL)
+        return -RT_ENOMEM;
+    rt_memset(queue, 0, sizeof(struct rt_blk_queue));
+
+    queue->bounce = (rt_uint8_t *)rt_malloc(max_sectors * geometry.bytes_per_sector);
+    if (queue->bounce == RT_NULL)
+    {
+        rt_free(queue);
+
+        return -RT_ENOMEM;
+    }
+
+    queue->device      = dev;
+    queue->read        = dev->read;
+    queue->write       = dev->write;
+    queue->sector_size = geometry.bytes_per_sector;
+    queue->max_sectors = max_sectors;
+    rt_list_init(&(queue->pending));
+    rt_sem_init(&(queue->sem), "blkq", 0, RT_IPC_FLAG_FIFO);
+    rt_completion_init(&(queue->exited));
+    rt_completion_init(&(queue->released));
+
+    queue->thread = rt_thread_create("blkq", _blk_dispatcher, queue,
+                                     RT_BLK_QUEUE_THREAD_STACK_SIZE,
+                                     RT_BLK_QUEUE_THREAD_PRIORITY, 20);
+    if (queue->thread == RT_NULL)
+    {
+        rt_sem_detach(&(queue->sem));
+        rt_free(queue->bounce);
+        rt_free(queue);
+
+        return -RT_ENOMEM;
+    }
+
+    level = rt_hw_interrupt_disable();
+    rt_list_insert_before(&_blk_queue_list, &(queue->list));
+    dev->read   = _blk_read;
+    dev->write  = _blk_write;
+    dev->submit = _blk_submit;
+    dev->cancel = _blk_cancel;
+    dev->flag  |= RT_DEVICE_FLAG_ASYNC;
+    rt_hw_interrupt_enable(level);
+
+    rt_thread_startup(queue->thread);
+
+    return RT_EOK;
+}
+
+/**
+ * This function will detach the request queue from a block device, the
+ * requests which are not dispatched are failed with -RT_EIO.
+ *
+ * @param dev the block device
+ *
+ * @return the error code, RT_EOK on successfully.
+ */
+rt_err_t rt_blk_queue_detach(rt_device_t dev)
+{
+    struct rt_blk_queue *queue;
+    register rt_base_t level;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    queue = _blk_queue_get(dev);
+    if (queue == RT_NULL)
+        return -RT_ERROR;
+
+    level = rt_hw_interrupt_disable();
+    if (queue->exit)
+    {
+        /* it's being detached */
+        rt_hw_interrupt_enable(level);
+        _blk_queue_put(queue);
+
+        return -RT_ERROR;
+    }
+    rt_list_remove(&(queue->list));
+    dev->read   = queue->read;
+    dev->write  = queue->write;
+    dev->submit = RT_NULL;
+    dev->cancel = RT_NULL;
+    dev->flag  &= ~RT_DEVICE_FLAG_ASYNC;
+    queue->exit = 1;
+    rt_hw_interrupt_enable(level);
+
+    /* wait for the dispatcher */
+    rt_sem_release(&(queue->sem));
+    rt_completion_wait(&(queue->exited), RT_WAITING_FOREVER);
+
+    /* wait for the users of queue */
+    _blk_queue_put(queue);
+    rt_completion_wait(&(queue->released), RT_WAITING_FOREVER);
+
+    rt_sem_detach(&(queue->sem));
+    rt_free(queue->bounce);
+    rt_free(queue);
+
+    return RT_EOK;
+}
+
+/**
+ * This function will plug the request queue of block device, the requests are
+ * held to be merged until the queue is unplugged.
+ *
+ * @param dev the block device
+ */
+void rt_blk_queue_plug(rt_device_t dev)
+{
+    struct rt_blk_queue *queue;
+    register rt_base_t level;
+
+    queue = _blk_queue_get(dev);
+    if (queue == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    queue->plugged ++;
+    rt_hw_interrupt_enable(level);
+
+    _blk_queue_put(queue);
+}
+
+/**
+ * This function will unplug the request queue of block device.
+ *
+ * @param dev the block device
+ */
+void rt_blk_queue_unplug(rt_device_t dev)
+{
+    struct rt_blk_queue *queue;
+    register rt_base_t level;
+
+    queue = _blk_queue_get(dev);
+    if (queue == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+    if (queue->plugged)
+        queue->plugged --;
+    rt_hw_interrupt_enable(level);
+
+    if (queue->plugged == 0)
+        rt_sem_release(&(queue->sem));
+
+    _blk_queue_put(queue);
+}
+
+/**
+ * This function will get the statistics of the request queue of block device.
+ *
+ * @param dev the block device
+ * @param stat the statistics of queue
+ *
+ * @return the error code, RT_EOK on successfully.
+ */
+rt_err_t rt_blk_queue_stat(rt_device_t dev, struct rt_blk_queue_stat *stat)
+{
+    struct rt_blk_queue *queue;
+    register rt_base_t level;
+
+    RT_ASSERT(stat != RT_NULL);
+
+    queue = _blk_queue_get(dev);
+    if (queue == RT_NULL)
+        return -RT_ERROR;
+
+    level = rt_hw_interrupt_disable();
+    stat->depth     = queue->depth;
+    stat->max_depth = queue->max_depth;
+    stat->requests  = queue->requests;
+    stat->transfers = queue->transfers;
+    stat->merged    = queue->merged;
+    rt_hw_interrupt_enable(level);
+
+    _blk_queue_put(queue);
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_blkq(void)
+{
+    rt_list_t *node;
+    struct rt_blk_queue *queue;
+    rt_uint32_t ratio;
+
+    rt_kprintf(" device  depth  max  requests transfers merged ratio\n");
+    rt_kprintf("-------- ----- ----- -------- --------- ------ -----\n");
+    for (node = _blk_queue_list.next; node != &_blk_queue_list; node = node->next)
+    {
+        queue = rt_list_entry(node, struct rt_blk_queue, list);
+
+        /* requests per transfer */
+        ratio = queue->transfers ? queue->requests * 100 / queue->transfers : 0;
+        rt_kprintf("%-8.*s %5d %5d %8d %9d %6d %2d.%02d\n",
+                   RT_NAME_MAX, queue->device->parent.name,
+                   queue->depth, queue->max_depth, queue->requests,
+                   queue->transfers, queue->merged, ratio / 100, ratio % 100);
+    }
+}
+FINSH_FUNCTION_EXPORT(list_blkq, list block request queue statistics);
+#endif
@@ -0,0 +1,105 @@
+/*
+ * File      : blk_cache.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __BLK_CACHE_H__
+#define __BLK_CACHE_H__
+
+#include <rtthread.h>
+
+/* the default number of sectors in cache */
+#ifndef RT_BLK_CACHE_SECTORS
+#define RT_BLK_CACHE_SECTORS        64
+#endif
+
+/* the sectors read ahead for sequential reading */
+#ifndef RT_BLK_CACHE_READAHEAD
+#define RT_BLK_CACHE_READAHEAD      8
+#endif
+
+/* the ticks between periodic flush of dirty sectors */
+#ifndef RT_BLK_CACHE_FLUSH_TICKS
+#define RT_BLK_CACHE_FLUSH_TICKS    (RT_TICK_PER_SECOND * 2)
+#endif
+
+#ifndef RT_BLK_CACHE_THREAD_PRIORITY
+#define RT_BLK_CACHE_THREAD_PRIORITY    (RT_THREAD_PRIORITY_MAX - 2)
+#endif
+
+#ifndef RT_BLK_CACHE_THREAD_STACK_SIZE
+#define RT_BLK_CACHE_THREAD_STACK_SIZE  1024
+#endif
+
+struct rt_blk_cache_entry
+{
+    rt_list_t                 lru;                  /* node of lru list */
+    rt_list_t                 hash;                 /* node of hash bucket */
+
+    rt_uint32_t               sector;
+    rt_uint16_t               valid;
+    rt_uint16_t               dirty;
+
+    rt_uint8_t               *data;
+};
+
+struct rt_blk_cache
+{
+    struct rt_device          parent;
+    rt_device_t               lower;                /* the cached block device */
+
+    rt_list_t                 list;                 /* node of cache list */
+    struct rt_mutex           lock;
+
+    rt_uint32_t               sector_size;
+    rt_uint32_t               sector_count;
+
+    rt_list_t                 lru;                  /* most recently used first */
+    rt_list_t                *hash;                 /* hash buckets of sector */
+    rt_uint32_t               hash_mask;
+
+    struct rt_blk_cache_entry *entries;
+    struct rt_blk_cache_entry **sorted;             /* dirty entries sorted by flush */
+    rt_uint32_t               count;                /* number of entries */
+    rt_uint32_t               dirty;                /* number of dirty entries */
+
+    rt_uint8_t               *staging;              /* buffer of multi-sector transfer */
+    rt_uint32_t               staging_sectors;
+    rt_uint32_t               readahead;
+    rt_uint32_t               next_sector;          /* next sector of sequential reading */
+
+    struct rt_semaphore       sem;                  /* wake up the flusher */
+    struct rt_completion      exited;               /* the flusher is exited */
+    rt_uint16_t               exit;
+    rt_thread_t               flusher;
+
+    /* statistics */
+    rt_uint32_t               hits;
+    rt_uint32_t               misses;
+    rt_uint32_t               readaheads;           /* sectors read ahead */
+    rt_uint32_t               writebacks;           /* sectors written to device */
+};
+
+rt_device_t rt_blk_cache_create(const char *name,
+                                rt_device_t lower,
+                                rt_uint32_t sectors,
+                                rt_uint32_t readahead);
+rt_err_t rt_blk_cache_destroy(rt_device_t dev);
+rt_err_t rt_blk_cache_flush(rt_device_t dev);
+
+#endif
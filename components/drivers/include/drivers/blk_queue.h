@@ -0,0 +1,101 @@
+/*
+ * File      : blk_queue.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __BLK_QUEUE_H__
+#define __BLK_QUEUE_H__
+
+#include <rtthread.h>
+
+#ifndef RT_USING_DEVICE_ASYNC
+#error "block request queue needs RT_USING_DEVICE_ASYNC"
+#endif
+
+/* the max sectors of a merged transfer, which sizes the bounce buffer */
+#ifndef RT_BLK_QUEUE_MAX_SECTORS
+#define RT_BLK_QUEUE_MAX_SECTORS    16
+#endif
+
+/* the max ticks a plugged queue holds the requests */
+#ifndef RT_BLK_QUEUE_PLUG_TICKS
+#define RT_BLK_QUEUE_PLUG_TICKS     2
+#endif
+
+/* the depth which unplugs the queue */
+#ifndef RT_BLK_QUEUE_BATCH
+#define RT_BLK_QUEUE_BATCH          16
+#endif
+
+#ifndef RT_BLK_QUEUE_THREAD_PRIORITY
+#define RT_BLK_QUEUE_THREAD_PRIORITY    8
+#endif
+
+#ifndef RT_BLK_QUEUE_THREAD_STACK_SIZE
+#define RT_BLK_QUEUE_THREAD_STACK_SIZE  1024
+#endif
+
+struct rt_blk_queue
+{
+    rt_list_t                 list;                 /* node of queue list */
+    rt_device_t               device;               /* the block device */
+
+    /* the original interface of block device */
+    rt_size_t (*read) (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+
+    rt_list_t                 pending;              /* pending requests sorted by position */
+    rt_uint16_t               plugged;              /* nesting of plug */
+    rt_uint16_t               exit;                 /* the queue is detached */
+    rt_uint16_t               ref;                  /* references of the users of queue */
+
+    rt_uint32_t               sector_size;
+    rt_uint32_t               max_sectors;          /* the max sectors of a merged transfer, which sizes the bounce buffer */
+    rt_uint8_t               *bounce;               /* buffer of a merged transfer */
+
+    struct rt_semaphore       sem;                  /* wake up the dispatcher */
+    struct rt_completion      exited;               /* the dispatcher is exited */
+    struct rt_completion      released;             /* the last reference is released */
+    rt_thread_t               thread;               /* the dispatcher */
+
+    /* statistics */
+    rt_uint32_t               depth;                /* number of requests in queue */
+    rt_uint32_t               max_depth;
+    rt_uint32_t               requests;             /* number of submitted requests */
+    rt_uint32_t               transfers;            /* number of transfers of device */
+    rt_uint32_t               merged;               /* number of requests merged into a transfer */
+};
+
+/* statistics of request queue */
+struct rt_blk_queue_stat
+{
+    rt_uint32_t depth;
+    rt_uint32_t max_depth;
+    rt_uint32_t requests;
+    rt_uint32_t transfers;
+    rt_uint32_t merged;
+};
+
+rt_err_t rt_blk_queue_attach(rt_device_t dev, rt_uint32_t max_sectors);
+rt_err_t rt_blk_queue_detach(rt_device_t dev);
+
+void rt_blk_queue_plug(rt_device_t dev);
+void rt_blk_queue_unplug(rt_device_t dev);
+rt_err_t rt_blk_queue_stat(rt_device_t dev, struct rt_blk_queue_stat *stat);
+
+#endif
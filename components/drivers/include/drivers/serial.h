@@ -74,6 +74,15 @@
 #define RT_SERIAL_TX_DATAQUEUE_SIZE     2048
 #define RT_SERIAL_TX_DATAQUEUE_LWM      30
 
+/* the frames kept in DMA receiving ring, power of 2 */
+#ifndef RT_SERIAL_DMA_RX_FRAMES
+#define RT_SERIAL_DMA_RX_FRAMES         16
+#endif
+
+/* the events of DMA receiving */
+#define RT_SERIAL_EVENT_RX_DMADONE      0x01    /* DMA buffer is full */
+#define RT_SERIAL_EVENT_RX_IDLE         0x02    /* idle line or timeout, frame ends */
+
 /* Default config for serial_configure structure */
 #define RT_SERIAL_CONFIG_DEFAULT           \
 {                                          \
@@ -92,6 +101,28 @@ struct serial_ringbuffer
     rt_uint16_t put_index, get_index;
 };
 
+/*
+ * DMA receiving structure. The driver provides the ring buffer (the size is
+ * power of 2) and the two DMA buffers, the rest is managed by serial framework.
+ */
+struct serial_dma_rx
+{
+    rt_uint8_t  *pool;                          /* ring buffer of received data */
+    rt_uint32_t  pool_size;
+    rt_uint8_t  *dma_buffer[2];                 /* double buffers of DMA */
+    rt_uint32_t  dma_size;
+
+    rt_uint8_t   dma_index;                     /* the buffer in receiving */
+    volatile rt_uint32_t put_index, get_index;  /* free running index of ring */
+
+    /* the end index of received frames */
+    rt_uint32_t  frame[RT_SERIAL_DMA_RX_FRAMES];
+    volatile rt_uint16_t frame_put, frame_get;
+
+    rt_uint32_t  frames;                        /* statistics */
+    rt_uint32_t  overrun;
+};
+
 struct serial_configure
 {
     rt_uint32_t baud_rate;
@@ -115,6 +146,9 @@ struct rt_serial_device
     /* tx structure */
     struct serial_ringbuffer *int_tx;
 
+    /* dma rx structure */
+    struct serial_dma_rx     *dma_rx;
+
     struct rt_data_queue      tx_dq;              /* tx dataqueue */
     
     volatile rt_bool_t        dma_flag;           /* dma transfer flag */
@@ -133,10 +167,13 @@ struct rt_uart_ops
     int (*getc)(struct rt_serial_device *serial);
 
     rt_size_t (*dma_transmit)(struct rt_serial_device *serial, const char *buf, rt_size_t size);
+    /* start DMA receiving into buf, which is stopped when size is 0 */
+    rt_size_t (*dma_receive)(struct rt_serial_device *serial, char *buf, rt_size_t size);
 };
 
 void rt_hw_serial_isr(struct rt_serial_device *serial);
 void rt_hw_serial_dma_tx_isr(struct rt_serial_device *serial);
+void rt_hw_serial_dma_rx_isr(struct rt_serial_device *serial, rt_size_t length, int event);
 rt_err_t rt_hw_serial_register(struct rt_serial_device *serial,
                                const char              *name,
                                rt_uint32_t              flag,
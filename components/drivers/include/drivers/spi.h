@@ -85,6 +85,67 @@ struct rt_spi_configuration
     rt_uint32_t max_hz;
 };
 
+#ifdef RT_USING_SPI_QUEUE
+/* the max requests transferred in one holding of bus */
+#ifndef RT_SPI_QUEUE_BATCH
+#define RT_SPI_QUEUE_BATCH              16
+#endif
+
+#ifndef RT_SPI_QUEUE_THREAD_PRIORITY
+#define RT_SPI_QUEUE_THREAD_PRIORITY    8
+#endif
+
+#ifndef RT_SPI_QUEUE_THREAD_STACK_SIZE
+#define RT_SPI_QUEUE_THREAD_STACK_SIZE  1024
+#endif
+
+#define RT_SPI_REQ_IDLE                 0x00    /* request is not submitted or completed */
+#define RT_SPI_REQ_PENDING              0x01    /* request is in queue of bus */
+
+struct rt_spi_device;
+
+/**
+ * SPI request structure, a message list transferred asynchronously
+ */
+struct rt_spi_request
+{
+    rt_list_t list;
+
+    struct rt_spi_device *device;
+    struct rt_spi_message *message;             /* message list */
+    struct rt_spi_message *failed;              /* the failed message, RT_NULL on success */
+    rt_err_t error;
+    rt_uint8_t status;
+
+    /* completion call back, invoked in the context of queue thread */
+    void (*done)(struct rt_spi_request *req);
+    void *user_data;
+};
+
+/**
+ * SPI bus message queue
+ */
+struct rt_spi_queue
+{
+    rt_list_t pending;                          /* pending requests in submitted order */
+    rt_uint32_t run;                            /* requests of owner taken ahead of order */
+
+    struct rt_semaphore sem;
+    rt_thread_t thread;
+
+    /* statistics */
+    rt_uint32_t depth;
+    rt_uint32_t max_depth;
+    rt_uint32_t requests;
+    rt_uint32_t messages;
+    rt_uint32_t bytes;
+    rt_uint32_t reconfigs;                      /* number of bus configurations */
+    rt_uint32_t batched;                        /* requests transferred without configuration */
+    rt_tick_t   busy_ticks;                     /* the ticks of holding bus */
+    rt_tick_t   start_tick;
+};
+#endif
+
 struct rt_spi_ops;
 struct rt_spi_bus
 {
@@ -93,6 +154,10 @@ struct rt_spi_bus
 
     struct rt_mutex lock;
     struct rt_spi_device *owner;
+
+#ifdef RT_USING_SPI_QUEUE
+    struct rt_spi_queue queue;
+#endif
 };
 
 /**
@@ -207,6 +272,44 @@ rt_size_t rt_spi_transfer(struct rt_spi_device *device,
 struct rt_spi_message *rt_spi_transfer_message(struct rt_spi_device  *device,
                                                struct rt_spi_message *message);
 
+#ifdef RT_USING_SPI_QUEUE
+/**
+ * This function initializes a SPI request.
+ *
+ * @param req the SPI request
+ * @param message the message list to be transferred
+ * @param done the completion call back
+ * @param user_data the user private data
+ */
+void rt_spi_request_init(struct rt_spi_request *req,
+                         struct rt_spi_message *message,
+                         void (*done)(struct rt_spi_request *req),
+                         void                  *user_data);
+
+/**
+ * This function submits a request to the message queue of SPI bus. The
+ * pending requests of the current owner of bus are transferred first to
+ * avoid re-configuring the bus.
+ *
+ * @param device the SPI device attached to SPI bus
+ * @param req the SPI request
+ *
+ * @return RT_EOK on submitted successfully, -RT_EBUSY if it's pending.
+ */
+rt_err_t rt_spi_submit(struct rt_spi_device  *device,
+                       struct rt_spi_request *req);
+
+/**
+ * This function cancels a pending request, which is completed with -RT_EINTR.
+ *
+ * @param req the SPI request
+ *
+ * @return RT_EOK on cancelled successfully, -RT_EBUSY if it's being
+ *         transferred, -RT_ERROR if it's completed.
+ */
+rt_err_t rt_spi_cancel(struct rt_spi_request *req);
+#endif
+
 rt_inline rt_size_t rt_spi_recv(struct rt_spi_device *device,
                                 void                 *recv_buf,
                                 rt_size_t             length)
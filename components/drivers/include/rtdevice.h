@@ -96,6 +96,28 @@ rt_inline rt_uint16_t RT_RINGBUFFER_SIZE(struct rt_ringbuffer *rb)
 /** return the size of empty space in rb */
 #define RT_RINGBUFFER_EMPTY(rb) ((rb)->buffer_size - RT_RINGBUFFER_SIZE(rb))
 
+/* single-producer/single-consumer ring buffer */
+struct rt_spsc_ringbuffer
+{
+    rt_uint8_t *buffer_ptr;
+    /* the size of buffer is a power of two, so the free-running indices could
+     * be wrapped by mask. The write_index is only updated by the producer and
+     * the read_index is only updated by the consumer, and the data is always
+     * accessed before the index is published, so a producer (e.g. an ISR) and
+     * a consumer (e.g. a thread) could access the ring buffer without
+     * disabling interrupt.
+     *
+     * write_index - read_index = size of data in rb */
+    rt_uint32_t buffer_mask;
+    volatile rt_uint32_t write_index;
+    volatile rt_uint32_t read_index;
+};
+
+/** return the size of data in rb */
+#define RT_SPSC_RINGBUFFER_SIZE(rb)  ((rt_uint32_t)((rb)->write_index - (rb)->read_index))
+/** return the size of empty space in rb */
+#define RT_SPSC_RINGBUFFER_EMPTY(rb) ((rb)->buffer_mask + 1 - RT_SPSC_RINGBUFFER_SIZE(rb))
+
 /* pipe device */
 #define PIPE_DEVICE(device)          ((struct rt_pipe_device*)(device))
 struct rt_pipe_device
@@ -144,6 +166,10 @@ void rt_completion_init(struct rt_completion *completion);
 rt_err_t rt_completion_wait(struct rt_completion *completion,
                             rt_int32_t            timeout);
 void rt_completion_done(struct rt_completion *completion);
+#ifdef RT_USING_DEVICE_ASYNC
+void rt_completion_bind_request(struct rt_completion     *completion,
+                                struct rt_device_request *req);
+#endif
 
 /**
  * RingBuffer for DeviceDriver
@@ -169,6 +195,35 @@ rt_inline rt_uint16_t rt_ringbuffer_get_size(struct rt_ringbuffer *rb)
     return rb->buffer_size;
 }
 
+/**
+ * Single-producer/single-consumer RingBuffer for DeviceDriver
+ *
+ * The put/reserve/commit functions shall only be invoked by one producer and
+ * the get/peek/release functions shall only be invoked by one consumer.
+ */
+void rt_spsc_ringbuffer_init(struct rt_spsc_ringbuffer *rb,
+                             rt_uint8_t                *pool,
+                             rt_uint32_t                size);
+rt_size_t rt_spsc_ringbuffer_put(struct rt_spsc_ringbuffer *rb,
+                                 const rt_uint8_t          *ptr,
+                                 rt_uint32_t                length);
+rt_size_t rt_spsc_ringbuffer_get(struct rt_spsc_ringbuffer *rb,
+                                 rt_uint8_t                *ptr,
+                                 rt_uint32_t                length);
+rt_size_t rt_spsc_ringbuffer_reserve(struct rt_spsc_ringbuffer *rb,
+                                     rt_uint8_t               **ptr);
+void rt_spsc_ringbuffer_commit(struct rt_spsc_ringbuffer *rb,
+                               rt_uint32_t                length);
+rt_size_t rt_spsc_ringbuffer_peek(struct rt_spsc_ringbuffer *rb,
+                                  rt_uint8_t               **ptr);
+void rt_spsc_ringbuffer_release(struct rt_spsc_ringbuffer *rb,
+                                rt_uint32_t                length);
+rt_inline rt_uint32_t rt_spsc_ringbuffer_get_size(struct rt_spsc_ringbuffer *rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+    return rb->buffer_mask + 1;
+}
+
 /**
  * Pipe Device
  */
@@ -241,5 +296,13 @@ void rt_data_queue_reset(struct rt_data_queue *queue);
 #include "drivers/sdio.h"
 #endif
 
+#ifdef RT_USING_BLK_QUEUE
+#include "drivers/blk_queue.h"
+#endif
+
+#ifdef RT_USING_BLK_CACHE
+#include "drivers/blk_cache.h"
+#endif
+
 #endif /* __RT_DEVICE_H__ */
 
@@ -25,6 +25,7 @@
 #include <rtthread.h>
 #include <dfs_fs.h>
 
+#include <rtdevice.h>
 #include <drivers/mmcsd_core.h>
 
 static rt_list_t blk_devices;
@@ -383,6 +384,9 @@ rt_int32_t rt_mmcsd_blk_probe(struct rt_mmcsd_card *card)
     
                 rt_device_register(&blk_dev->dev, dname,
                     RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_REMOVABLE | RT_DEVICE_FLAG_STANDALONE);
+#ifdef RT_USING_BLK_QUEUE
+                rt_blk_queue_attach(&blk_dev->dev, card->host->max_blk_count);
+#endif
                 rt_list_insert_after(&blk_devices, &blk_dev->list);
             }
             else
@@ -420,6 +424,9 @@ rt_int32_t rt_mmcsd_blk_probe(struct rt_mmcsd_card *card)
     
                     rt_device_register(&blk_dev->dev, "sd0",
                         RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_REMOVABLE | RT_DEVICE_FLAG_STANDALONE);
+#ifdef RT_USING_BLK_QUEUE
+                    rt_blk_queue_attach(&blk_dev->dev, card->host->max_blk_count);
+#endif
                     rt_list_insert_after(&blk_devices, &blk_dev->list);
     
                     break;
@@ -455,6 +462,9 @@ void rt_mmcsd_blk_remove(struct rt_mmcsd_card *card)
         blk_dev = (struct mmcsd_blk_device *)rt_list_entry(l, struct mmcsd_blk_device, list);
         if (blk_dev->card == card) 
         {
+#ifdef RT_USING_BLK_QUEUE
+            rt_blk_queue_detach(&blk_dev->dev);
+#endif
             rt_device_unregister(&blk_dev->dev);
             rt_list_remove(&blk_dev->list);
             rt_free(blk_dev);
@@ -119,6 +119,121 @@ rt_inline rt_uint32_t serial_ringbuffer_size(struct serial_ringbuffer *rbuffer)
     return size;
 }
 
+/*
+ * DMA receiving ring. The received data is copied from the DMA buffer in bulk
+ * and the end of frame is recorded on idle line, so the data of a frame is
+ * read out in one time.
+ */
+rt_inline void serial_dma_rx_init(struct serial_dma_rx *rx)
+{
+    /* the size of ring buffer must be power of 2 */
+    RT_ASSERT(rx->pool_size != 0 && (rx->pool_size & (rx->pool_size - 1)) == 0);
+
+    rx->dma_index = 0;
+    rx->put_index = 0;
+    rx->get_index = 0;
+    rx->frame_put = 0;
+    rx->frame_get = 0;
+}
+
+/* put the received data of DMA into ring, it's called in ISR */
+static void serial_dma_rx_put(struct serial_dma_rx *rx,
+                              const rt_uint8_t     *buffer,
+                              rt_size_t             length)
+{
+    rt_uint32_t index, count;
+
+    /* the new data is discarded if ring is full, the frames in ring are kept */
+    count = rx->pool_size - (rx->put_index - rx->get_index);
+    if (length > count)
+    {
+        rx->overrun += length - count;
+        length = count;
+    }
+
+    index = rx->put_index & (rx->pool_size - 1);
+    count = rx->pool_size - index;
+    if (count > length)
+        count = length;
+
+    rt_memcpy(rx->pool + index, buffer, count);
+    rt_memcpy(rx->pool, buffer + count, length - count);
+
+    rx->put_index += length;
+}
+
+static void serial_dma_rx_frame_end(struct serial_dma_rx *rx)
+{
+    rt_uint16_t last;
+
+    /* no new data since last frame */
+    last = (rt_uint16_t)(rx->frame_put - 1) % RT_SERIAL_DMA_RX_FRAMES;
+    if (rx->frame_put != rx->frame_get && rx->frame[last] == rx->put_index)
+        return;
+    if (rx->frame_put == rx->frame_get && rx->get_index == rx->put_index)
+        return;
+
+    if ((rt_uint16_t)(rx->frame_put - rx->frame_get) == RT_SERIAL_DMA_RX_FRAMES)
+    {
+        /* the frame list is full, append the data to the last frame */
+        rx->frame[last] = rx->put_index;
+    }
+    else
+    {
+        rx->frame[rx->frame_put % RT_SERIAL_DMA_RX_FRAMES] = rx->put_index;
+        rx->frame_put ++;
+    }
+    rx->frames ++;
+}
+
+/* get the data of a frame from ring */
+static rt_size_t serial_dma_rx_get(struct serial_dma_rx *rx,
+                                   rt_uint8_t           *buffer,
+                                   rt_size_t             size)
+{
+    rt_uint32_t index, count, end;
+    rt_size_t length;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (rx->frame_get != rx->frame_put)
+    {
+        end = rx->frame[rx->frame_get % RT_SERIAL_DMA_RX_FRAMES];
+    }
+    else if (rx->put_index - rx->get_index == rx->pool_size)
+    {
+        /* the ring is full without the end of frame */
+        end = rx->put_index;
+    }
+    else
+    {
+        end = rx->get_index;
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* the rest of frame is kept for next reading */
+    length = end - rx->get_index;
+    if (length > size)
+        length = size;
+
+    index = rx->get_index & (rx->pool_size - 1);
+    count = rx->pool_size - index;
+    if (count > length)
+        count = length;
+
+    rt_memcpy(buffer, rx->pool + index, count);
+    rt_memcpy(buffer + count, rx->pool, length - count);
+
+    level = rt_hw_interrupt_disable();
+    rx->get_index += length;
+    if (rx->frame_get != rx->frame_put &&
+        rx->get_index == rx->frame[rx->frame_get % RT_SERIAL_DMA_RX_FRAMES])
+        rx->frame_get ++;
+    rt_hw_interrupt_enable(level);
+
+    return length;
+}
+
 /* RT-Thread Device Interface */
 
 /*
@@ -147,6 +262,9 @@ static rt_err_t rt_serial_init(struct rt_device *dev)
         if (dev->flag & RT_DEVICE_FLAG_INT_TX)
             serial_ringbuffer_init(serial->int_tx);
 
+        if (dev->flag & RT_DEVICE_FLAG_DMA_RX)
+            serial_dma_rx_init(serial->dma_rx);
+
         if (dev->flag & RT_DEVICE_FLAG_DMA_TX)
         {
             serial->dma_flag = RT_FALSE;
@@ -181,6 +299,15 @@ static rt_err_t rt_serial_open(struct rt_device *dev, rt_uint16_t oflag)
         serial->ops->control(serial, RT_DEVICE_CTRL_SET_INT, (void *)int_flags);
     }
 
+    /* start DMA receiving on the first open */
+    if ((dev->flag & RT_DEVICE_FLAG_DMA_RX) && dev->ref_count == 1)
+    {
+        struct serial_dma_rx *rx = serial->dma_rx;
+
+        rx->dma_index = 0;
+        serial->ops->dma_receive(serial, (char *)rx->dma_buffer[0], rx->dma_size);
+    }
+
     return RT_EOK;
 }
 
@@ -202,6 +329,10 @@ static rt_err_t rt_serial_close(struct rt_device *dev)
         serial->ops->control(serial, RT_DEVICE_CTRL_CLR_INT, (void *)int_flags);
     }
 
+    /* stop DMA receiving */
+    if (dev->flag & RT_DEVICE_FLAG_DMA_RX)
+        serial->ops->dma_receive(serial, RT_NULL, 0);
+
     return RT_EOK;
 }
 
@@ -219,7 +350,12 @@ static rt_size_t rt_serial_read(struct rt_device *dev,
 
     ptr = (rt_uint8_t *)buffer;
 
-    if (dev->flag & RT_DEVICE_FLAG_INT_RX)
+    if (dev->flag & RT_DEVICE_FLAG_DMA_RX)
+    {
+        /* DMA mode Rx, read a frame */
+        ptr += serial_dma_rx_get(serial->dma_rx, ptr, size);
+    }
+    else if (dev->flag & RT_DEVICE_FLAG_INT_RX)
     {
         /* interrupt mode Rx */
         while (size)
@@ -435,6 +571,35 @@ void rt_hw_serial_isr(struct rt_serial_device *serial)
     }
 }
 
+/*
+ * ISR for DMA mode Rx
+ *
+ * The driver invokes it when the DMA buffer is full (RT_SERIAL_EVENT_RX_DMADONE)
+ * or the line is idle (RT_SERIAL_EVENT_RX_IDLE), length is the received bytes
+ * in current DMA buffer. The receiving is restarted on the other buffer before
+ * the data is copied into ring.
+ */
+void rt_hw_serial_dma_rx_isr(struct rt_serial_device *serial, rt_size_t length, int event)
+{
+    struct serial_dma_rx *rx;
+    rt_uint8_t *buffer;
+
+    RT_ASSERT(serial->parent.flag & RT_DEVICE_FLAG_DMA_RX);
+    rx = serial->dma_rx;
+
+    buffer = rx->dma_buffer[rx->dma_index];
+    rx->dma_index ^= 1;
+    serial->ops->dma_receive(serial, (char *)rx->dma_buffer[rx->dma_index], rx->dma_size);
+
+    serial_dma_rx_put(rx, buffer, length);
+    if (event & RT_SERIAL_EVENT_RX_IDLE)
+        serial_dma_rx_frame_end(rx);
+
+    /* invoke callback */
+    if (serial->parent.rx_indicate != RT_NULL)
+        serial->parent.rx_indicate(&serial->parent, rx->put_index - rx->get_index);
+}
+
 /*
  * ISR for DMA mode Tx
  */
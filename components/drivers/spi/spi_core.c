@@ -31,6 +31,9 @@
 
 extern rt_err_t rt_spi_bus_device_init(struct rt_spi_bus *bus, const char *name);
 extern rt_err_t rt_spidev_device_init(struct rt_spi_device *dev, const char *name);
+#ifdef RT_USING_SPI_QUEUE
+extern rt_err_t rt_spi_queue_init(struct rt_spi_bus *bus);
+#endif
 
 rt_err_t rt_spi_bus_register(struct rt_spi_bus       *bus,
                              const char              *name,
@@ -49,6 +52,19 @@ rt_err_t rt_spi_bus_register(struct rt_spi_bus       *bus,
     /* initialize owner */
     bus->owner = RT_NULL;
 
+#ifdef RT_USING_SPI_QUEUE
+    /* initialize message queue */
+    result = rt_spi_queue_init(bus);
+    if (result != RT_EOK)
+    {
+        /* don't leave a bus without queue registered */
+        rt_mutex_detach(&(bus->lock));
+        rt_device_unregister(&(bus->parent));
+
+        return result;
+    }
+#endif
+
     return RT_EOK;
 }
 
@@ -0,0 +1,311 @@
+/*
+ * File      : spi_queue.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * SPI bus message queue.
+ *
+ * Each SPI bus has a queue thread, which transfers the submitted requests and
+ * invokes their completion call back. The thread takes the bus lock for a
+ * batch of requests, so the synchronous transfers of other threads are done
+ * between the batches.
+ *
+ * The bus is configured when its owner is changed. To avoid re-configuring,
+ * the pending requests of current owner are taken ahead of the others, but at
+ * most RT_SPI_QUEUE_BATCH requests in a row, then the oldest request is taken.
+ * The requests of the same device are always transferred in submitted order.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <drivers/spi.h>
+
+/* take the next request, the requests of owner are preferred */
+static struct rt_spi_request *_spi_queue_take(struct rt_spi_queue  *queue,
+                                              struct rt_spi_device *owner)
+{
+    rt_list_t *node;
+    struct rt_spi_request *req;
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (rt_list_isempty(&(queue->pending)))
+    {
+        rt_hw_interrupt_enable(level);
+
+        return RT_NULL;
+    }
+
+    req = rt_list_entry(queue->pending.next, struct rt_spi_request, list);
+    if (req->device != owner && owner != RT_NULL && queue->run < RT_SPI_QUEUE_BATCH)
+    {
+        for (node = queue->pending.next->next; node != &(queue->pending); node = node->next)
+        {
+            struct rt_spi_request *next;
+
+            next = rt_list_entry(node, struct rt_spi_request, list);
+            if (next->device == owner)
+            {
+                req = next;
+                queue->run ++;
+                break;
+            }
+        }
+    }
+    if (req == rt_list_entry(queue->pending.next, struct rt_spi_request, list))
+        queue->run = 0;
+
+    rt_list_remove(&(req->list));
+    rt_list_init(&(req->list));
+    queue->depth --;
+    rt_hw_interrupt_enable(level);
+
+    return req;
+}
+
+static void _spi_request_done(struct rt_spi_request *req,
+                              struct rt_spi_message *failed,
+                              rt_err_t               error)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    req->failed = failed;
+    req->error  = error;
+    req->status = RT_SPI_REQ_IDLE;
+    rt_hw_interrupt_enable(level);
+
+    if (req->done != RT_NULL)
+        req->done(req);
+}
+
+static void _spi_queue_transfer(struct rt_spi_bus *bus, struct rt_spi_request *req)
+{
+    struct rt_spi_queue *queue = &(bus->queue);
+    struct rt_spi_device *device = req->device;
+    struct rt_spi_message *message;
+
+    if (bus->owner != device)
+    {
+        /* not the same owner as current, re-configure SPI bus */
+        if (bus->ops->configure(device, &device->config) != RT_EOK)
+        {
+            _spi_request_done(req, req->message, -RT_EIO);
+
+            return;
+        }
+
+        bus->owner = device;
+        queue->reconfigs ++;
+    }
+    else
+    {
+        queue->batched ++;
+    }
+
+    for (message = req->message; message != RT_NULL; message = message->next)
+    {
+        if (bus->ops->xfer(device, message) == 0)
+        {
+            _spi_request_done(req, message, -RT_EIO);
+
+            return;
+        }
+
+        queue->messages ++;
+        queue->bytes += message->length;
+    }
+
+    _spi_request_done(req, RT_NULL, RT_EOK);
+}
+
+static void _spi_queue_thread(void *parameter)
+{
+    rt_uint32_t count;
+    rt_tick_t tick;
+    struct rt_spi_request *req;
+    struct rt_spi_bus *bus = (struct rt_spi_bus *)parameter;
+    struct rt_spi_queue *queue = &(bus->queue);
+
+    while (1)
+    {
+        rt_sem_take(&(queue->sem), RT_WAITING_FOREVER);
+
+        rt_mutex_take(&(bus->lock), RT_WAITING_FOREVER);
+        tick = rt_tick_get();
+
+        /* the rest of requests are transferred in the next batch */
+        for (count = 0; count < RT_SPI_QUEUE_BATCH; count ++)
+        {
+            req = _spi_queue_take(queue, bus->owner);
+            if (req == RT_NULL)
+                break;
+
+            _spi_queue_transfer(bus, req);
+        }
+
+        queue->busy_ticks += rt_tick_get() - tick;
+        rt_mutex_release(&(bus->lock));
+    }
+}
+
+rt_err_t rt_spi_queue_init(struct rt_spi_bus *bus)
+{
+    struct rt_spi_queue *queue = &(bus->queue);
+
+    rt_memset(queue, 0, sizeof(struct rt_spi_queue));
+    rt_list_init(&(queue->pending));
+    rt_sem_init(&(queue->sem), "spiq", 0, RT_IPC_FLAG_FIFO);
+    queue->start_tick = rt_tick_get();
+
+    queue->thread = rt_thread_create("spiq", _spi_queue_thread, bus,
+                                     RT_SPI_QUEUE_THREAD_STACK_SIZE,
+                                     RT_SPI_QUEUE_THREAD_PRIORITY, 20);
+    if (queue->thread == RT_NULL)
+    {
+        rt_sem_detach(&(queue->sem));
+
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(queue->thread);
+
+    return RT_EOK;
+}
+
+void rt_spi_request_init(struct rt_spi_request *req,
+                         struct rt_spi_message *message,
+                         void (*done)(struct rt_spi_request *req),
+                         void                  *user_data)
+{
+    RT_ASSERT(req != RT_NULL);
+
+    rt_list_init(&(req->list));
+    req->device    = RT_NULL;
+    req->message   = message;
+    req->failed    = RT_NULL;
+    req->error     = RT_EOK;
+    req->status    = RT_SPI_REQ_IDLE;
+    req->done      = done;
+    req->user_data = user_data;
+}
+
+rt_err_t rt_spi_submit(struct rt_spi_device  *device,
+                       struct rt_spi_request *req)
+{
+    struct rt_spi_queue *queue;
+    register rt_base_t level;
+
+    RT_ASSERT(device != RT_NULL);
+    RT_ASSERT(device->bus != RT_NULL);
+    RT_ASSERT(req != RT_NULL);
+
+    if (req->message == RT_NULL)
+        return -RT_ERROR;
+
+    queue = &(device->bus->queue);
+
+    level = rt_hw_interrupt_disable();
+    if (req->status != RT_SPI_REQ_IDLE)
+    {
+        rt_hw_interrupt_enable(level);
+
+        return -RT_EBUSY;
+    }
+
+    req->device = device;
+    req->failed = RT_NULL;
+    req->error  = RT_EOK;
+    req->status = RT_SPI_REQ_PENDING;
+    rt_list_insert_before(&(queue->pending), &(req->list));
+
+    queue->depth ++;
+    queue->requests ++;
+    if (queue->depth > queue->max_depth)
+        queue->max_depth = queue->depth;
+    rt_hw_interrupt_enable(level);
+
+    rt_sem_release(&(queue->sem));
+
+    return RT_EOK;
+}
+
+rt_err_t rt_spi_cancel(struct rt_spi_request *req)
+{
+    register rt_base_t level;
+
+    RT_ASSERT(req != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    if (req->status != RT_SPI_REQ_PENDING)
+    {
+        rt_hw_interrupt_enable(level);
+
+        return -RT_ERROR;
+    }
+
+    /* it's taken by queue thread */
+    if (rt_list_isempty(&(req->list)))
+    {
+        rt_hw_interrupt_enable(level);
+
+        return -RT_EBUSY;
+    }
+
+    rt_list_remove(&(req->list));
+    rt_list_init(&(req->list));
+    req->device->bus->queue.depth --;
+    rt_hw_interrupt_enable(level);
+
+    _spi_request_done(req, req->message, -RT_EINTR);
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_spi(void)
+{
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    struct rt_spi_bus *bus;
+    struct rt_spi_queue *queue;
+    rt_tick_t elapsed;
+    rt_uint32_t ratio;
+
+    information = rt_object_get_information(RT_Object_Class_Device);
+
+    rt_kprintf(" bus     depth max  requests messages   bytes    reconfig batched  busy\n");
+    rt_kprintf("-------- ----- ---- -------- -------- ---------- -------- -------- ----\n");
+    for (node = information->object_list.next; node != &(information->object_list); node = node->next)
+    {
+        bus = (struct rt_spi_bus *)rt_list_entry(node, struct rt_object, list);
+        if (bus->parent.type != RT_Device_Class_SPIBUS)
+            continue;
+
+        queue = &(bus->queue);
+        elapsed = rt_tick_get() - queue->start_tick;
+        ratio = elapsed >= 100 ? queue->busy_ticks / (elapsed / 100) : 0;
+        rt_kprintf("%-8.*s %5d %4d %8d %8d %10d %8d %8d %3d%%\n",
+                   RT_NAME_MAX, bus->parent.parent.name,
+                   queue->depth, queue->max_depth, queue->requests, queue->messages,
+                   queue->bytes, queue->reconfigs, queue->batched, ratio);
+    }
+}
+FINSH_FUNCTION_EXPORT(list_spi, list SPI bus queue statistics);
+#endif
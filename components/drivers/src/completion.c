@@ -139,3 +139,25 @@ void rt_completion_done(struct rt_completion *completion)
         rt_hw_interrupt_enable(level);
     }
 }
+
+#ifdef RT_USING_DEVICE_ASYNC
+static void _completion_request_done(rt_device_t dev, struct rt_device_request *req)
+{
+    rt_completion_done((struct rt_completion *)req->user_data);
+}
+
+/*
+ * bind an asynchronous device request to completion, the completion is done
+ * when the request is completed, so the submitter could wait on it.
+ */
+void rt_completion_bind_request(struct rt_completion     *completion,
+                                struct rt_device_request *req)
+{
+    RT_ASSERT(completion != RT_NULL);
+    RT_ASSERT(req != RT_NULL);
+
+    rt_completion_init(completion);
+    req->done      = _completion_request_done;
+    req->user_data = completion;
+}
+#endif
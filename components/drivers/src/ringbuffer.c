@@ -191,3 +191,235 @@ rt_size_t rt_ringbuffer_getchar(struct rt_ringbuffer *rb, rt_uint8_t *ch)
 }
 RTM_EXPORT(rt_ringbuffer_getchar);
 
+
+/*
+ * memory barrier of the single-producer/single-consumer ring buffer: the data
+ * shall be accessed before the index is published to the other side. BSP
+ * could define RT_SPSC_BARRIER in rtconfig.h for the CPU with weak memory
+ * order, such as a data memory barrier instruction.
+ */
+#ifndef RT_SPSC_BARRIER
+#if defined(__GNUC__)
+#define RT_SPSC_BARRIER()   __sync_synchronize()
+#elif defined(__CC_ARM)
+#define RT_SPSC_BARRIER()   __schedule_barrier()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define RT_SPSC_BARRIER()   _ReadWriteBarrier()
+#else
+#define RT_SPSC_BARRIER()
+#endif
+#endif
+
+/**
+ * initialize a single-producer/single-consumer ring buffer, the size is
+ * rounded down to a power of two.
+ */
+void rt_spsc_ringbuffer_init(struct rt_spsc_ringbuffer *rb,
+                             rt_uint8_t                *pool,
+                             rt_uint32_t                size)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(size > 0);
+
+    /* round down to a power of two */
+    while (size & (size - 1))
+        size &= size - 1;
+
+    /* initialize read and write index */
+    rb->read_index = 0;
+    rb->write_index = 0;
+
+    /* set buffer pool and size */
+    rb->buffer_ptr = pool;
+    rb->buffer_mask = size - 1;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_init);
+
+/**
+ * put data into ring buffer, it's invoked by the producer.
+ *
+ * @return the size of data put into ring buffer
+ */
+rt_size_t rt_spsc_ringbuffer_put(struct rt_spsc_ringbuffer *rb,
+                                 const rt_uint8_t          *ptr,
+                                 rt_uint32_t                length)
+{
+    rt_uint32_t size, index, part;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    index = rb->write_index;
+    size = rb->buffer_mask + 1 - (index - rb->read_index);
+    /* the space shall be freed by consumer before it's written */
+    RT_SPSC_BARRIER();
+
+    /* drop some data */
+    if (size < length)
+        length = size;
+    if (length == 0)
+        return 0;
+
+    index &= rb->buffer_mask;
+    part = rb->buffer_mask + 1 - index;
+    if (part >= length)
+    {
+        memcpy(&rb->buffer_ptr[index], ptr, length);
+    }
+    else
+    {
+        memcpy(&rb->buffer_ptr[index], &ptr[0], part);
+        memcpy(&rb->buffer_ptr[0], &ptr[part], length - part);
+    }
+
+    /* publish the data to consumer */
+    RT_SPSC_BARRIER();
+    rb->write_index += length;
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_put);
+
+/**
+ * get data from ring buffer, it's invoked by the consumer.
+ *
+ * @return the size of data got from ring buffer
+ */
+rt_size_t rt_spsc_ringbuffer_get(struct rt_spsc_ringbuffer *rb,
+                                 rt_uint8_t                *ptr,
+                                 rt_uint32_t                length)
+{
+    rt_uint32_t size, index, part;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    index = rb->read_index;
+    size = rb->write_index - index;
+    /* the data shall be written by producer before it's read */
+    RT_SPSC_BARRIER();
+
+    /* less data */
+    if (size < length)
+        length = size;
+    if (length == 0)
+        return 0;
+
+    index &= rb->buffer_mask;
+    part = rb->buffer_mask + 1 - index;
+    if (part >= length)
+    {
+        memcpy(ptr, &rb->buffer_ptr[index], length);
+    }
+    else
+    {
+        memcpy(&ptr[0], &rb->buffer_ptr[index], part);
+        memcpy(&ptr[part], &rb->buffer_ptr[0], length - part);
+    }
+
+    /* release the space to producer */
+    RT_SPSC_BARRIER();
+    rb->read_index += length;
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_get);
+
+/**
+ * reserve the contiguous empty space of ring buffer for writing, it's
+ * invoked by the producer. The data written is published by
+ * rt_spsc_ringbuffer_commit.
+ *
+ * @param ptr the start address of empty space
+ *
+ * @return the size of contiguous empty space
+ */
+rt_size_t rt_spsc_ringbuffer_reserve(struct rt_spsc_ringbuffer *rb,
+                                     rt_uint8_t               **ptr)
+{
+    rt_uint32_t size, index;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(ptr != RT_NULL);
+
+    index = rb->write_index;
+    size = rb->buffer_mask + 1 - (index - rb->read_index);
+    RT_SPSC_BARRIER();
+
+    /* the empty space till the end of buffer */
+    index &= rb->buffer_mask;
+    if (size > rb->buffer_mask + 1 - index)
+        size = rb->buffer_mask + 1 - index;
+
+    *ptr = &rb->buffer_ptr[index];
+
+    return size;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_reserve);
+
+/**
+ * commit the data written in the reserved space, it's invoked by the
+ * producer.
+ *
+ * @param length the size of data written, which shall not be greater than
+ *        the size of reserved space.
+ */
+void rt_spsc_ringbuffer_commit(struct rt_spsc_ringbuffer *rb,
+                               rt_uint32_t                length)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(length <= RT_SPSC_RINGBUFFER_EMPTY(rb));
+
+    /* publish the data to consumer */
+    RT_SPSC_BARRIER();
+    rb->write_index += length;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_commit);
+
+/**
+ * peek the contiguous data of ring buffer without copying, it's invoked by
+ * the consumer. The space of data is freed by rt_spsc_ringbuffer_release.
+ *
+ * @param ptr the start address of data
+ *
+ * @return the size of contiguous data
+ */
+rt_size_t rt_spsc_ringbuffer_peek(struct rt_spsc_ringbuffer *rb,
+                                  rt_uint8_t               **ptr)
+{
+    rt_uint32_t size, index;
+
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(ptr != RT_NULL);
+
+    index = rb->read_index;
+    size = rb->write_index - index;
+    RT_SPSC_BARRIER();
+
+    /* the data till the end of buffer */
+    index &= rb->buffer_mask;
+    if (size > rb->buffer_mask + 1 - index)
+        size = rb->buffer_mask + 1 - index;
+
+    *ptr = &rb->buffer_ptr[index];
+
+    return size;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_peek);
+
+/**
+ * release the space of data peeked, it's invoked by the consumer.
+ *
+ * @param length the size of data consumed, which shall not be greater than
+ *        the size of peeked data.
+ */
+void rt_spsc_ringbuffer_release(struct rt_spsc_ringbuffer *rb,
+                                rt_uint32_t                length)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(length <= RT_SPSC_RINGBUFFER_SIZE(rb));
+
+    /* release the space to producer */
+    RT_SPSC_BARRIER();
+    rb->read_index += length;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_release);
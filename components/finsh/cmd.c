@@ -98,8 +98,13 @@ static long _list_thread(struct rt_list_node *list)
         else if (thread->stat == RT_THREAD_INIT)    rt_kprintf(" init   ");
         else if (thread->stat == RT_THREAD_CLOSE)   rt_kprintf(" close  ");
 
+#ifdef RT_USING_STACK_SAMPLER
+        ptr = (rt_uint8_t*)thread->stack_addr + thread->stack_size -
+              rt_thread_stack_used(thread);
+#else
         ptr = (rt_uint8_t*)thread->stack_addr;
         while (*ptr == '#')ptr ++;
+#endif
 
         rt_kprintf(" 0x%08x 0x%08x 0x%08x 0x%08x %03d\n",
             thread->stack_size + ((rt_uint32_t)thread->stack_addr - (rt_uint32_t)thread->sp),
@@ -118,6 +123,117 @@ long list_thread(void)
 }
 FINSH_FUNCTION_EXPORT(list_thread, list thread);
 
+#ifdef RT_USING_STACK_SAMPLER
+#ifndef RT_STACK_SAMPLER_MARGIN
+#define RT_STACK_SAMPLER_MARGIN     25
+#endif
+
+static long _list_stack(struct rt_list_node *list)
+{
+    struct rt_thread *thread;
+    struct rt_list_node *node;
+    rt_size_t used, suggest, total, total_suggest;
+
+    total = total_suggest = 0;
+
+    rt_kprintf(" thread  stack size max used   usage suggest    saving\n");
+    rt_kprintf("-------- ---------- ---------- ----- ---------- ----------\n");
+    for (node = list->next; node != list; node = node->next)
+    {
+        thread = rt_list_entry(node, struct rt_thread, list);
+        used = rt_thread_stack_used(thread);
+
+        /* the max used size with a margin, no less than the used size */
+        suggest = RT_ALIGN(used + used * RT_STACK_SAMPLER_MARGIN / 100, 16);
+        if (used >= thread->stack_size)
+        {
+            /* the whole stack is used, it may be overflowed */
+            suggest = thread->stack_size;
+        }
+        else if (suggest > thread->stack_size)
+            suggest = thread->stack_size;
+
+        rt_kprintf("%-8.*s %-10d %-10d %3d%%  %-10d %-10d%s\n",
+                   RT_NAME_MAX, thread->name,
+                   thread->stack_size, used,
+                   used * 100 / thread->stack_size,
+                   suggest, thread->stack_size - suggest,
+                   used >= thread->stack_size ? " overflow?" : "");
+
+        total += thread->stack_size;
+        total_suggest += suggest;
+    }
+    rt_kprintf("total %d bytes, suggest %d bytes, saving %d bytes with %d%% margin\n",
+               total, total_suggest, total - total_suggest, RT_STACK_SAMPLER_MARGIN);
+
+    return 0;
+}
+
+long list_stack(void)
+{
+    return _list_stack(&rt_object_container[RT_Object_Class_Thread].object_list);
+}
+FINSH_FUNCTION_EXPORT(list_stack, list stack high-water mark and suggested size of thread);
+#endif
+
+#ifdef RT_USING_SCHED_STAT
+static long _list_sched(struct rt_list_node *list)
+{
+    struct rt_thread *thread;
+    struct rt_list_node *node;
+    struct rt_sched_stat stat;
+
+    rt_kprintf(" thread  pri    switch    preempt   run time   max latency\n");
+    rt_kprintf("-------- ---- ---------- ---------- ---------- ----------\n");
+    for (node = list->next; node != list; node = node->next)
+    {
+        thread = rt_list_entry(node, struct rt_thread, list);
+        rt_thread_sched_stat(thread, &stat);
+
+        rt_kprintf("%-8.*s 0x%02x %010d %010d %010d %010d\n",
+                   RT_NAME_MAX,
+                   thread->name,
+                   thread->current_priority,
+                   stat.switch_count,
+                   stat.preempt_count,
+                   stat.run_time,
+                   stat.max_latency);
+    }
+    rt_kprintf("max scheduler locked time: %d\n", rt_scheduler_lock_time());
+
+    return 0;
+}
+
+static void _list_irq_stat(void)
+{
+    static struct rt_irq_stat stat[RT_SCHED_STAT_IRQ_SITES];
+    rt_uint32_t index, count;
+
+    count = rt_interrupt_stat_get(stat, RT_SCHED_STAT_IRQ_SITES);
+
+    rt_kprintf("interrupt disabled by             count      total time max time\n");
+    rt_kprintf("-------------------------------- ---------- ---------- ----------\n");
+    for (index = 0; index < count; index ++)
+    {
+        rt_kprintf("%-26.26s:%-5d %010d %010d %010d\n",
+                   stat[index].function,
+                   stat[index].line,
+                   stat[index].count,
+                   stat[index].total_time,
+                   stat[index].max_time);
+    }
+}
+
+long list_sched(void)
+{
+    _list_sched(&rt_object_container[RT_Object_Class_Thread].object_list);
+    _list_irq_stat();
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(list_sched, list scheduler statistics of thread and interrupt lock);
+#endif
+
 static void show_wait_queue(struct rt_list_node *list)
 {
     struct rt_thread *thread;
@@ -133,6 +249,50 @@ static void show_wait_queue(struct rt_list_node *list)
     }
 }
 
+static int ipc_wait_queue_len(struct rt_ipc_object *ipc)
+{
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* the object created with RT_IPC_FLAG_PRIO_QUEUE has the queue */
+    if ((ipc->parent.flag & RT_IPC_FLAG_PRIO_QUEUE) && ipc->prio_queue != RT_NULL)
+    {
+        int index, len = 0;
+
+        for (index = 0; index < RT_THREAD_PRIORITY_MAX; index ++)
+            len += rt_list_len(&(ipc->prio_queue->thread[index]));
+
+        return len;
+    }
+#endif
+
+    return rt_list_len(&(ipc->suspend_thread));
+}
+
+static void show_ipc_wait_queue(struct rt_ipc_object *ipc)
+{
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    if ((ipc->parent.flag & RT_IPC_FLAG_PRIO_QUEUE) && ipc->prio_queue != RT_NULL)
+    {
+        int index, shown = 0;
+
+        /* show the threads from the highest priority */
+        for (index = 0; index < RT_THREAD_PRIORITY_MAX; index ++)
+        {
+            if (rt_list_isempty(&(ipc->prio_queue->thread[index])))
+                continue;
+
+            if (shown)
+                rt_kprintf("/");
+            show_wait_queue(&(ipc->prio_queue->thread[index]));
+            shown = 1;
+        }
+
+        return;
+    }
+#endif
+
+    show_wait_queue(&(ipc->suspend_thread));
+}
+
 #ifdef RT_USING_SEMAPHORE
 static long _list_sem(struct rt_list_node *list)
 {
@@ -144,14 +304,14 @@ static long _list_sem(struct rt_list_node *list)
     for (node = list->next; node != list; node = node->next)
     {
         sem = (struct rt_semaphore *)(rt_list_entry(node, struct rt_object, list));
-        if (!rt_list_isempty(&sem->parent.suspend_thread))
+        if (ipc_wait_queue_len(&(sem->parent)) > 0)
         {
             rt_kprintf("%-8.*s  %03d %d:", 
                        RT_NAME_MAX,
                        sem->parent.parent.name,
                        sem->value,
-                       rt_list_len(&sem->parent.suspend_thread));
-            show_wait_queue(&(sem->parent.suspend_thread));
+                       ipc_wait_queue_len(&(sem->parent)));
+            show_ipc_wait_queue(&(sem->parent));
             rt_kprintf("\n");
         }
         else
@@ -160,7 +320,7 @@ static long _list_sem(struct rt_list_node *list)
                        RT_NAME_MAX,
                        sem->parent.parent.name,
                        sem->value,
-                       rt_list_len(&sem->parent.suspend_thread));
+                       ipc_wait_queue_len(&(sem->parent)));
         }
     }
 
@@ -229,7 +389,7 @@ static long _list_mutex(struct rt_list_node *list)
                    RT_NAME_MAX,
                    m->owner->name,
                    m->hold,
-                   rt_list_len(&m->parent.suspend_thread));
+                   ipc_wait_queue_len(&(m->parent)));
     }
 
     return 0;
@@ -253,15 +413,15 @@ static long _list_mailbox(struct rt_list_node *list)
     for (node = list->next; node != list; node = node->next)
     {
         m = (struct rt_mailbox *)(rt_list_entry(node, struct rt_object, list));
-        if (!rt_list_isempty(&m->parent.suspend_thread))
+        if (ipc_wait_queue_len(&(m->parent)) > 0)
         {
             rt_kprintf("%-8.*s %04d  %04d %d:",
                        RT_NAME_MAX,
                        m->parent.parent.name,
                        m->entry,
                        m->size,
-                       rt_list_len(&m->parent.suspend_thread));
-            show_wait_queue(&(m->parent.suspend_thread));
+                       ipc_wait_queue_len(&(m->parent)));
+            show_ipc_wait_queue(&(m->parent));
             rt_kprintf("\n");
         }
         else
@@ -271,7 +431,7 @@ static long _list_mailbox(struct rt_list_node *list)
                        m->parent.parent.name,
                        m->entry,
                        m->size,
-                       rt_list_len(&m->parent.suspend_thread));
+                       ipc_wait_queue_len(&(m->parent)));
         }
     }
 
@@ -296,14 +456,14 @@ static long _list_msgqueue(struct rt_list_node *list)
     for (node = list->next; node != list; node = node->next)
     {
         m = (struct rt_messagequeue *)(rt_list_entry(node, struct rt_object, list));
-        if (!rt_list_isempty(&m->parent.suspend_thread))
+        if (ipc_wait_queue_len(&(m->parent)) > 0)
         {
             rt_kprintf("%-8.*s %04d  %d:",
                        RT_NAME_MAX,
                        m->parent.parent.name,
                        m->entry,
-                       rt_list_len(&m->parent.suspend_thread));
-            show_wait_queue(&(m->parent.suspend_thread));
+                       ipc_wait_queue_len(&(m->parent)));
+            show_ipc_wait_queue(&(m->parent));
             rt_kprintf("\n");
         }
         else
@@ -312,7 +472,7 @@ static long _list_msgqueue(struct rt_list_node *list)
                        RT_NAME_MAX,
                        m->parent.parent.name,
                        m->entry,
-                       rt_list_len(&m->parent.suspend_thread));
+                       ipc_wait_queue_len(&(m->parent)));
         }
     }
 
@@ -346,6 +506,25 @@ static long _list_memheap(struct rt_list_node *list)
                    mh->available_size);
     }
 
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+    /* the heaps in preference order and the allocations served for classes */
+    rt_kprintf("\nmemheap  pref class default  fast     dma      bulk\n");
+    rt_kprintf("-------- ---- ----- -------- -------- -------- --------\n");
+    for (node = list->next; node != list; node = node->next)
+    {
+        mh = (struct rt_memheap *)rt_list_entry(node, struct rt_object, list);
+
+        rt_kprintf("%-8.*s %-4d %c%c%c   %-8d %-8d %-8d %-8d\n",
+                   RT_NAME_MAX,
+                   mh->parent.name,
+                   mh->preference,
+                   mh->placement & RT_MEM_FAST ? 'F' : '-',
+                   mh->placement & RT_MEM_DMA  ? 'D' : '-',
+                   mh->placement & RT_MEM_BULK ? 'B' : '-',
+                   mh->served[0], mh->served[1], mh->served[2], mh->served[3]);
+    }
+#endif
+
     return 0;
 }
 
@@ -401,6 +580,72 @@ long list_mempool(void)
 FINSH_FUNCTION_EXPORT(list_mempool, list memory pool in system)
 #endif
 
+#ifdef RT_USING_OBJECT_CACHE
+static const char *object_class_name(rt_uint8_t type)
+{
+    switch (type)
+    {
+    case RT_Object_Class_Thread:        return "thread";
+#ifdef RT_USING_SEMAPHORE
+    case RT_Object_Class_Semaphore:     return "sem";
+#endif
+#ifdef RT_USING_MUTEX
+    case RT_Object_Class_Mutex:         return "mutex";
+#endif
+#ifdef RT_USING_EVENT
+    case RT_Object_Class_Event:         return "event";
+#endif
+#ifdef RT_USING_MAILBOX
+    case RT_Object_Class_MailBox:       return "mailbox";
+#endif
+#ifdef RT_USING_MESSAGEQUEUE
+    case RT_Object_Class_MessageQueue:  return "msgqueue";
+#endif
+#ifdef RT_USING_MEMHEAP
+    case RT_Object_Class_MemHeap:       return "memheap";
+#endif
+#ifdef RT_USING_MEMPOOL
+    case RT_Object_Class_MemPool:       return "mempool";
+#endif
+#ifdef RT_USING_DEVICE
+    case RT_Object_Class_Device:        return "device";
+#endif
+    case RT_Object_Class_Timer:         return "timer";
+#ifdef RT_USING_MODULE
+    case RT_Object_Class_Module:        return "module";
+#endif
+    default:                            return "unknown";
+    }
+}
+
+long list_object_cache(void)
+{
+    struct rt_object_cache *cache;
+    rt_uint8_t type;
+
+    rt_kprintf("class    size reserve used peak hit        miss\n");
+    rt_kprintf("-------- ---- ------- ---- ---- ---------- ----------\n");
+    for (type = 0; type < RT_Object_Class_Unknown; type ++)
+    {
+        cache = rt_object_cache_get((enum rt_object_class_type)type);
+        if (cache == RT_NULL)
+            continue;
+
+        rt_kprintf("%-8s %04d %07d %04d %04d %010d %010d\n",
+                   object_class_name(type),
+                   cache->pool.block_size,
+                   cache->reserve,
+                   cache->pool.block_total_count - cache->pool.block_free_count,
+                   cache->peak,
+                   cache->hit,
+                   cache->miss);
+    }
+
+    return 0;
+}
+FINSH_FUNCTION_EXPORT(list_object_cache, list kernel object cache in system)
+#endif
+
 static long _list_timer(struct rt_list_node *list)
 {
     struct rt_timer *timer;
@@ -0,0 +1,223 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "tc_comm.h"
+
+#ifdef RT_USING_BLK_CACHE
+/*
+ * This is a test for the block sector cache.
+ *
+ * A cache of BLK_CACHE_SECTORS sectors is created over a mock block device in
+ * memory, which counts the reads and writes of sectors. The test finishes
+ * before the periodic flush of cache:
+ *  - the small writes are kept in cache until RT_DEVICE_CTRL_BLK_SYNC, then the
+ *    adjacent dirty sectors are written back in one transfer;
+ *  - an evicted dirty sector is written back and it's read again from device;
+ *  - the sequential reading reads ahead BLK_CACHE_READAHEAD sectors, which are
+ *    hit later;
+ *  - a large write is written through, and it updates the cached copies of
+ *    sectors and drops the dirty ones.
+ */
+
+#define BLK_CACHE_SECTORS		8
+#define BLK_CACHE_READAHEAD		2
+#define BLK_CACHE_SECTOR_SIZE	64
+#define BLK_CACHE_MEDIA_SECTORS	64
+
+static struct rt_device mock_dev;
+static rt_uint8_t mock_media[BLK_CACHE_MEDIA_SECTORS][BLK_CACHE_SECTOR_SIZE];
+static rt_uint32_t mock_reads, mock_read_sectors;
+static rt_uint32_t mock_writes, mock_write_sectors;
+
+static rt_uint8_t buffer[BLK_CACHE_SECTORS / 2][BLK_CACHE_SECTOR_SIZE];
+
+static rt_size_t mock_read(rt_device_t dev, rt_off_t pos, void *buf, rt_size_t size)
+{
+	if (pos + size > BLK_CACHE_MEDIA_SECTORS)
+		return 0;
+
+	rt_memcpy(buf, mock_media[pos], size * BLK_CACHE_SECTOR_SIZE);
+	mock_reads ++;
+	mock_read_sectors += size;
+
+	return size;
+}
+
+static rt_size_t mock_write(rt_device_t dev, rt_off_t pos, const void *buf, rt_size_t size)
+{
+	if (pos + size > BLK_CACHE_MEDIA_SECTORS)
+		return 0;
+
+	rt_memcpy(mock_media[pos], buf, size * BLK_CACHE_SECTOR_SIZE);
+	mock_writes ++;
+	mock_write_sectors += size;
+
+	return size;
+}
+
+static rt_err_t mock_control(rt_device_t dev, rt_uint8_t cmd, void *args)
+{
+	struct rt_device_blk_geometry *geometry;
+
+	if (cmd == RT_DEVICE_CTRL_BLK_GETGEOME)
+	{
+		geometry = (struct rt_device_blk_geometry *)args;
+		geometry->sector_count     = BLK_CACHE_MEDIA_SECTORS;
+		geometry->bytes_per_sector = BLK_CACHE_SECTOR_SIZE;
+		geometry->block_size       = BLK_CACHE_SECTOR_SIZE;
+	}
+
+	return RT_EOK;
+}
+
+static rt_bool_t buffer_check(rt_uint8_t *buf, rt_uint8_t value, rt_size_t size)
+{
+	while (size --)
+	{
+		if (*buf++ != value)
+			return RT_FALSE;
+	}
+
+	return RT_TRUE;
+}
+
+static void blk_cache_init()
+{
+	rt_uint32_t index;
+	rt_device_t dev = RT_NULL;
+	struct rt_blk_cache *cache;
+
+	/* sector N of media is filled with N */
+	for (index = 0; index < BLK_CACHE_MEDIA_SECTORS; index ++)
+		rt_memset(mock_media[index], index, BLK_CACHE_SECTOR_SIZE);
+	mock_reads = mock_read_sectors = 0;
+	mock_writes = mock_write_sectors = 0;
+
+	rt_memset(&mock_dev, 0, sizeof(mock_dev));
+	mock_dev.type    = RT_Device_Class_Block;
+	mock_dev.read    = mock_read;
+	mock_dev.write   = mock_write;
+	mock_dev.control = mock_control;
+	if (rt_device_register(&mock_dev, "bcmem", RT_DEVICE_FLAG_RDWR) != RT_EOK)
+	{
+		tc_done(TC_STAT_FAILED);
+		return;
+	}
+	dev = rt_blk_cache_create("bcache", &mock_dev, BLK_CACHE_SECTORS, BLK_CACHE_READAHEAD);
+	if (dev == RT_NULL)
+	{
+		rt_device_unregister(&mock_dev);
+		tc_done(TC_STAT_FAILED);
+		return;
+	}
+	cache = (struct rt_blk_cache *)dev;
+	if (rt_device_open(dev, RT_DEVICE_OFLAG_RDWR) != RT_EOK)
+		goto _failed;
+
+	/* write back two adjacent sectors */
+	rt_memset(buffer, 0xa0, sizeof(buffer));
+	if (rt_device_write(dev, 4, buffer, 2) != 2 ||
+		mock_writes != 0 || cache->dirty != 2 ||
+		!buffer_check(mock_media[4], 4, BLK_CACHE_SECTOR_SIZE))
+		goto _failed;
+	rt_memset(buffer, 0, sizeof(buffer));
+	if (rt_device_read(dev, 4, buffer, 2) != 2 || cache->hits != 2 ||
+		mock_reads != 0 || !buffer_check(buffer[0], 0xa0, BLK_CACHE_SECTOR_SIZE * 2))
+		goto _failed;
+	if (rt_device_control(dev, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL) != RT_EOK ||
+		mock_writes != 1 || mock_write_sectors != 2 ||
+		cache->dirty != 0 || cache->writebacks != 2 ||
+		!buffer_check(mock_media[4], 0xa0, BLK_CACHE_SECTOR_SIZE * 2))
+		goto _failed;
+
+	/* a dirty sector is evicted by reading the other sectors */
+	rt_memset(buffer, 0xb0, sizeof(buffer));
+	if (rt_device_write(dev, 10, buffer, 1) != 1 || mock_writes != 1)
+		goto _failed;
+	for (index = 0; index < BLK_CACHE_SECTORS; index ++)
+	{
+		/* not sequential, nothing is read ahead */
+		if (rt_device_read(dev, 16 + index * 2, buffer, 1) != 1 ||
+			!buffer_check(buffer[0], 16 + index * 2, BLK_CACHE_SECTOR_SIZE))
+			goto _failed;
+	}
+	if (mock_writes != 2 || cache->writebacks != 3 || cache->dirty != 0 ||
+		cache->readaheads != 0 ||
+		!buffer_check(mock_media[10], 0xb0, BLK_CACHE_SECTOR_SIZE))
+		goto _failed;
+	mock_reads = 0;
+	rt_memset(buffer, 0, sizeof(buffer));
+	if (rt_device_read(dev, 10, buffer, 1) != 1 || mock_reads != 1 ||
+		!buffer_check(buffer[0], 0xb0, BLK_CACHE_SECTOR_SIZE))
+		goto _failed;
+
+	/* the sequential reading reads ahead */
+	cache->hits = cache->misses = 0;
+	mock_reads = mock_read_sectors = 0;
+	if (rt_device_read(dev, 48, buffer, 1) != 1 || cache->readaheads != 0 ||
+		rt_device_read(dev, 49, buffer, 1) != 1 ||
+		cache->readaheads != BLK_CACHE_READAHEAD || cache->misses != 2 ||
+		mock_reads != 2 || mock_read_sectors != 2 + BLK_CACHE_READAHEAD)
+		goto _failed;
+	for (index = 0; index < BLK_CACHE_READAHEAD; index ++)
+	{
+		if (rt_device_read(dev, 50 + index, buffer, 1) != 1 ||
+			!buffer_check(buffer[0], 50 + index, BLK_CACHE_SECTOR_SIZE))
+			goto _failed;
+	}
+	if (cache->hits != BLK_CACHE_READAHEAD || mock_reads != 2)
+		goto _failed;
+
+	/* a large write is written through, over a dirty cached sector */
+	rt_memset(buffer, 0xc0, sizeof(buffer));
+	if (rt_device_write(dev, 50, buffer, 1) != 1 || cache->dirty != 1)
+		goto _failed;
+	mock_writes = mock_write_sectors = 0;
+	for (index = 0; index < BLK_CACHE_SECTORS / 2; index ++)
+		rt_memset(buffer[index], 0xd0 + index, BLK_CACHE_SECTOR_SIZE);
+	if (rt_device_write(dev, 48, buffer, BLK_CACHE_SECTORS / 2) != BLK_CACHE_SECTORS / 2 ||
+		mock_writes != 1 || mock_write_sectors != BLK_CACHE_SECTORS / 2 ||
+		cache->dirty != 0)
+		goto _failed;
+	cache->hits = 0;
+	mock_reads = 0;
+	rt_memset(buffer, 0, sizeof(buffer));
+	if (rt_device_read(dev, 48, buffer, BLK_CACHE_SECTORS / 2) != BLK_CACHE_SECTORS / 2 ||
+		cache->hits != BLK_CACHE_SECTORS / 2 || mock_reads != 0)
+		goto _failed;
+	for (index = 0; index < BLK_CACHE_SECTORS / 2; index ++)
+	{
+		if (!buffer_check(buffer[index], 0xd0 + index, BLK_CACHE_SECTOR_SIZE) ||
+			!buffer_check(mock_media[48 + index], 0xd0 + index, BLK_CACHE_SECTOR_SIZE))
+			goto _failed;
+	}
+
+	tc_done(TC_STAT_PASSED);
+	goto _exit;
+
+_failed:
+	tc_done(TC_STAT_FAILED);
+
+_exit:
+	if (dev->ref_count)
+		rt_device_close(dev);
+	rt_blk_cache_destroy(dev);
+	rt_device_unregister(&mock_dev);
+}
+
+#ifdef RT_USING_TC
+int _tc_blk_cache()
+{
+	blk_cache_init();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_blk_cache, a block sector cache test);
+#else
+int rt_application_init()
+{
+	blk_cache_init();
+
+	return 0;
+}
+#endif
+#endif
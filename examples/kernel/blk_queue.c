@@ -0,0 +1,260 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "tc_comm.h"
+
+#ifdef RT_USING_BLK_QUEUE
+/*
+ * This is a test for the block request queue over the simulated SD card.
+ *
+ * The test runs on the raw card device, "sdcard" if the sector cache is used
+ * or "sd0" otherwise, and it borrows the sectors at the end of card, which
+ * are restored after test. The card should not be accessed by others:
+ *  - BLK_QUEUE_THREAD_NUM threads submit the interleaved one sector writes to
+ *    the plugged queue, they are sorted and merged into one transfer after
+ *    unplugging, and the data is read back;
+ *  - a pending request could be cancelled and it completes with -RT_EINTR;
+ *  - the pending requests of a detached queue complete with -RT_EIO, and the
+ *    read/write of device work again without queue.
+ */
+
+#define BLK_QUEUE_THREAD_NUM	3
+#define BLK_QUEUE_REQ_NUM		(BLK_QUEUE_THREAD_NUM * 4)
+#define BLK_QUEUE_SECTOR_SIZE	512
+
+static rt_device_t blk_dev;
+static rt_uint32_t blk_base;
+
+static struct rt_thread worker[BLK_QUEUE_THREAD_NUM];
+static rt_uint8_t worker_stack[BLK_QUEUE_THREAD_NUM][THREAD_STACK_SIZE];
+static struct rt_semaphore submit_sem;
+static rt_uint32_t submit_count;
+
+static struct rt_device_request req[BLK_QUEUE_REQ_NUM];
+static rt_uint8_t req_buffer[BLK_QUEUE_REQ_NUM][BLK_QUEUE_SECTOR_SIZE];
+static rt_uint8_t read_buffer[BLK_QUEUE_REQ_NUM * BLK_QUEUE_SECTOR_SIZE];
+static rt_uint8_t saved_buffer[BLK_QUEUE_REQ_NUM * BLK_QUEUE_SECTOR_SIZE];
+static struct rt_semaphore done_sem;
+static rt_uint8_t done_count;
+
+static void request_done(rt_device_t dev, struct rt_device_request *r)
+{
+	done_count ++;
+	rt_sem_release(&done_sem);
+}
+
+static rt_err_t request_submit(rt_uint8_t index, rt_uint8_t type)
+{
+	rt_device_request_init(&req[index], type, blk_base + index,
+		req_buffer[index], 1, request_done, RT_NULL);
+
+	return rt_device_submit(blk_dev, &req[index]);
+}
+
+static rt_err_t request_wait(rt_uint8_t count)
+{
+	while (count --)
+	{
+		if (rt_sem_take(&done_sem, RT_TICK_PER_SECOND) != RT_EOK)
+			return -RT_ETIMEOUT;
+	}
+
+	return RT_EOK;
+}
+
+static rt_bool_t buffer_check(rt_uint8_t *buffer, rt_uint8_t value, rt_size_t size)
+{
+	while (size --)
+	{
+		if (*buffer++ != value)
+			return RT_FALSE;
+	}
+
+	return RT_TRUE;
+}
+
+static void worker_entry(void *parameter)
+{
+	rt_uint8_t index;
+
+	/* the sectors of threads are interleaved */
+	for (index = (rt_ubase_t)parameter; index < BLK_QUEUE_REQ_NUM; index += BLK_QUEUE_THREAD_NUM)
+	{
+		rt_memset(req_buffer[index], index + 1, BLK_QUEUE_SECTOR_SIZE);
+		if (request_submit(index, RT_DEVICE_REQ_WRITE) == RT_EOK)
+			submit_count ++;
+	}
+
+	rt_sem_release(&submit_sem);
+}
+
+static void blk_queue_init()
+{
+	char name[RT_NAME_MAX];
+	rt_uint32_t index, started = 0;
+	rt_bool_t opened = RT_FALSE, saved = RT_FALSE;
+	rt_err_t result;
+	struct rt_device_blk_geometry geometry;
+	struct rt_blk_queue_stat stat_begin, stat_end;
+
+	blk_dev = rt_device_find("sdcard");
+	if (blk_dev == RT_NULL)
+		blk_dev = rt_device_find("sd0");
+	if (blk_dev == RT_NULL)
+	{
+		tc_done(TC_STAT_FAILED);
+		return;
+	}
+	rt_sem_init(&submit_sem, "submit", 0, RT_IPC_FLAG_FIFO);
+	rt_sem_init(&done_sem, "done", 0, RT_IPC_FLAG_FIFO);
+
+	/* the card may be opened by file system or sector cache */
+	result = rt_device_open(blk_dev, RT_DEVICE_OFLAG_RDWR);
+	if (result == RT_EOK)
+		opened = RT_TRUE;
+	else if (result != -RT_EBUSY)
+		goto _failed;
+
+	if (rt_device_control(blk_dev, RT_DEVICE_CTRL_BLK_GETGEOME, &geometry) != RT_EOK ||
+		geometry.bytes_per_sector != BLK_QUEUE_SECTOR_SIZE ||
+		geometry.sector_count < BLK_QUEUE_REQ_NUM * 2)
+		goto _failed;
+	blk_base = geometry.sector_count - BLK_QUEUE_REQ_NUM * 2;
+	if (rt_device_read(blk_dev, blk_base, saved_buffer, BLK_QUEUE_REQ_NUM) != BLK_QUEUE_REQ_NUM)
+		goto _failed;
+	saved = RT_TRUE;
+
+	/* the interleaved writes of threads are merged into one transfer */
+	if (rt_blk_queue_stat(blk_dev, &stat_begin) != RT_EOK)
+		goto _failed;
+	rt_blk_queue_plug(blk_dev);
+	done_count = 0;
+	submit_count = 0;
+	for (index = 0; index < BLK_QUEUE_THREAD_NUM; index ++)
+	{
+		rt_snprintf(name, sizeof(name), "blkq%d", index);
+		rt_thread_init(&worker[index], name, worker_entry, (void *)(rt_ubase_t)index,
+			&worker_stack[index][0], sizeof(worker_stack[index]),
+			THREAD_PRIORITY, THREAD_TIMESLICE);
+		rt_thread_startup(&worker[index]);
+		started ++;
+	}
+	for (index = 0; index < BLK_QUEUE_THREAD_NUM; index ++)
+	{
+		if (rt_sem_take(&submit_sem, RT_TICK_PER_SECOND) != RT_EOK)
+		{
+			rt_blk_queue_unplug(blk_dev);
+			goto _failed;
+		}
+	}
+	rt_blk_queue_unplug(blk_dev);
+	if (submit_count != BLK_QUEUE_REQ_NUM || request_wait(BLK_QUEUE_REQ_NUM) != RT_EOK)
+		goto _failed;
+	for (index = 0; index < BLK_QUEUE_REQ_NUM; index ++)
+	{
+		if (req[index].error != RT_EOK || req[index].result != 1)
+			goto _failed;
+	}
+	if (rt_blk_queue_stat(blk_dev, &stat_end) != RT_EOK ||
+		stat_end.requests - stat_begin.requests != BLK_QUEUE_REQ_NUM ||
+		stat_end.transfers - stat_begin.transfers != 1 ||
+		stat_end.merged - stat_begin.merged != BLK_QUEUE_REQ_NUM - 1 ||
+		stat_end.depth != 0)
+		goto _failed;
+
+	/* read back */
+	rt_memset(read_buffer, 0, sizeof(read_buffer));
+	if (rt_device_read(blk_dev, blk_base, read_buffer, BLK_QUEUE_REQ_NUM) != BLK_QUEUE_REQ_NUM)
+		goto _failed;
+	for (index = 0; index < BLK_QUEUE_REQ_NUM; index ++)
+	{
+		if (!buffer_check(&read_buffer[index * BLK_QUEUE_SECTOR_SIZE], index + 1,
+			BLK_QUEUE_SECTOR_SIZE))
+			goto _failed;
+	}
+
+	/* cancel a pending request, the dispatcher is kept from running */
+	rt_memset(req_buffer[0], 0xa5, BLK_QUEUE_SECTOR_SIZE);
+	rt_memset(req_buffer[1], 0x5a, BLK_QUEUE_SECTOR_SIZE);
+	done_count = 0;
+	rt_enter_critical();
+	if (request_submit(0, RT_DEVICE_REQ_WRITE) != RT_EOK ||
+		request_submit(1, RT_DEVICE_REQ_WRITE) != RT_EOK ||
+		rt_device_cancel(blk_dev, &req[1]) != RT_EOK ||
+		done_count != 1 || req[1].error != -RT_EINTR)
+	{
+		rt_exit_critical();
+		goto _failed;
+	}
+	rt_exit_critical();
+	/* a completed request could not be cancelled */
+	if (rt_device_cancel(blk_dev, &req[1]) != -RT_ERROR)
+		goto _failed;
+	if (request_wait(2) != RT_EOK || req[0].error != RT_EOK)
+		goto _failed;
+	if (rt_device_read(blk_dev, blk_base, read_buffer, 2) != 2 ||
+		!buffer_check(&read_buffer[0], 0xa5, BLK_QUEUE_SECTOR_SIZE) ||
+		!buffer_check(&read_buffer[BLK_QUEUE_SECTOR_SIZE], 2, BLK_QUEUE_SECTOR_SIZE))
+		goto _failed;
+
+	/* the pending request of a detached queue is failed */
+	rt_blk_queue_plug(blk_dev);
+	done_count = 0;
+	if (request_submit(2, RT_DEVICE_REQ_WRITE) != RT_EOK)
+	{
+		rt_blk_queue_unplug(blk_dev);
+		goto _failed;
+	}
+	if (rt_blk_queue_detach(blk_dev) != RT_EOK)
+		goto _failed;
+	if (request_wait(1) != RT_EOK || req[2].error != -RT_EIO ||
+		(blk_dev->flag & RT_DEVICE_FLAG_ASYNC))
+		goto _failed;
+	/* the device works without queue */
+	if (rt_device_read(blk_dev, blk_base + 2, read_buffer, 1) != 1 ||
+		!buffer_check(read_buffer, 3, BLK_QUEUE_SECTOR_SIZE))
+		goto _failed;
+	if (rt_blk_queue_attach(blk_dev, 0) != RT_EOK)
+		goto _failed;
+
+	tc_done(TC_STAT_PASSED);
+	goto _exit;
+
+_failed:
+	tc_done(TC_STAT_FAILED);
+
+_exit:
+	/* the workers may not be closed yet */
+	rt_enter_critical();
+	for (index = 0; index < started; index ++)
+	{
+		if (worker[index].stat != RT_THREAD_CLOSE)
+			rt_thread_detach(&worker[index]);
+	}
+	rt_exit_critical();
+
+	/* restore the borrowed sectors */
+	if (saved)
+		rt_device_write(blk_dev, blk_base, saved_buffer, BLK_QUEUE_REQ_NUM);
+	if (opened)
+		rt_device_close(blk_dev);
+	rt_sem_detach(&done_sem);
+	rt_sem_detach(&submit_sem);
+}
+
+#ifdef RT_USING_TC
+int _tc_blk_queue()
+{
+	blk_queue_init();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_blk_queue, a block request queue test);
+#else
+int rt_application_init()
+{
+	blk_queue_init();
+
+	return 0;
+}
+#endif
+#endif
@@ -0,0 +1,247 @@
+#include <rtthread.h>
+#include <rthw.h>
+#include "tc_comm.h"
+
+/*
+ * This is a test for the asynchronous request interface of device.
+ *
+ * The "async" device keeps the submitted requests in a queue and completes
+ * the head request of queue in a timer, so several requests are in flight:
+ *  - the requests are completed in order with their data;
+ *  - a queued request could be cancelled and it completes with -RT_EINTR;
+ *  - the request which is being transferred could not be cancelled.
+ * The "sync" device has only read/write interface, the request is completed
+ * by the synchronous fallback before rt_device_submit returns, and a short
+ * read completes with -RT_EIO.
+ */
+
+#define ASYNC_REQ_NUM		4
+#define ASYNC_REQ_SIZE		32
+
+static struct rt_device async_dev, sync_dev;
+static rt_uint8_t async_media[ASYNC_REQ_NUM * ASYNC_REQ_SIZE];
+static rt_list_t async_queue;
+static struct rt_timer async_timer;
+
+static struct rt_device_request req[ASYNC_REQ_NUM];
+static rt_uint8_t req_buffer[ASYNC_REQ_NUM][ASYNC_REQ_SIZE];
+static struct rt_semaphore done_sem;
+static rt_uint8_t done_order[ASYNC_REQ_NUM];
+static rt_uint8_t done_count;
+
+static void media_transfer(struct rt_device_request *r)
+{
+	if (r->type == RT_DEVICE_REQ_READ)
+		rt_memcpy(r->buffer, &async_media[r->pos], r->size);
+	else
+		rt_memcpy(&async_media[r->pos], r->buffer, r->size);
+}
+
+/* complete the head request of queue, in the context of timer */
+static void async_timeout(void *parameter)
+{
+	struct rt_device_request *r;
+	rt_base_t level;
+
+	level = rt_hw_interrupt_disable();
+	if (rt_list_isempty(&async_queue))
+	{
+		rt_hw_interrupt_enable(level);
+		return;
+	}
+	r = rt_list_entry(async_queue.next, struct rt_device_request, list);
+	rt_list_remove(&(r->list));
+	rt_hw_interrupt_enable(level);
+
+	media_transfer(r);
+	rt_device_request_done(&async_dev, r, r->size, RT_EOK);
+}
+
+static rt_err_t async_submit(rt_device_t dev, struct rt_device_request *r)
+{
+	rt_base_t level;
+
+	if (r->pos + r->size > sizeof(async_media))
+		return -RT_EIO;
+
+	level = rt_hw_interrupt_disable();
+	rt_list_insert_before(&async_queue, &(r->list));
+	rt_hw_interrupt_enable(level);
+
+	return RT_EOK;
+}
+
+static rt_err_t async_cancel(rt_device_t dev, struct rt_device_request *r)
+{
+	rt_base_t level;
+
+	level = rt_hw_interrupt_disable();
+	/* the head request is being transferred */
+	if (async_queue.next == &(r->list) || rt_list_isempty(&(r->list)))
+	{
+		rt_hw_interrupt_enable(level);
+		return -RT_EBUSY;
+	}
+	rt_list_remove(&(r->list));
+	rt_hw_interrupt_enable(level);
+
+	rt_device_request_done(dev, r, 0, -RT_EINTR);
+
+	return RT_EOK;
+}
+
+static rt_size_t sync_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+	/* a short read beyond the media */
+	if (pos > 0xff)
+		size /= 2;
+	rt_memset(buffer, pos, size);
+
+	return size;
+}
+
+static void request_done(rt_device_t dev, struct rt_device_request *r)
+{
+	done_order[done_count ++] = (rt_uint8_t)(r - &req[0]);
+	rt_sem_release(&done_sem);
+}
+
+static rt_bool_t buffer_check(rt_uint8_t *buffer, rt_uint8_t value, rt_size_t size)
+{
+	while (size --)
+	{
+		if (*buffer++ != value)
+			return RT_FALSE;
+	}
+
+	return RT_TRUE;
+}
+
+static void device_async_init()
+{
+	rt_uint32_t index;
+	rt_tick_t tick = 5;
+
+	rt_memset(&async_dev, 0, sizeof(async_dev));
+	rt_memset(&sync_dev, 0, sizeof(sync_dev));
+	rt_list_init(&async_queue);
+	rt_sem_init(&done_sem, "done", 0, RT_IPC_FLAG_FIFO);
+	rt_timer_init(&async_timer, "async", async_timeout, RT_NULL, tick,
+		RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+
+	async_dev.type   = RT_Device_Class_Block;
+	async_dev.submit = async_submit;
+	async_dev.cancel = async_cancel;
+	sync_dev.type    = RT_Device_Class_Char;
+	sync_dev.read    = sync_read;
+	if (rt_device_register(&async_dev, "async", RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_ASYNC) != RT_EOK ||
+		rt_device_register(&sync_dev, "sync", RT_DEVICE_FLAG_RDONLY) != RT_EOK)
+		goto _failed;
+	rt_device_open(&async_dev, RT_DEVICE_OFLAG_RDWR);
+	rt_device_open(&sync_dev, RT_DEVICE_OFLAG_RDONLY);
+
+	/* keep all the write requests in flight */
+	done_count = 0;
+	for (index = 0; index < ASYNC_REQ_NUM; index ++)
+	{
+		rt_memset(req_buffer[index], index + 1, ASYNC_REQ_SIZE);
+		rt_device_request_init(&req[index], RT_DEVICE_REQ_WRITE, index * ASYNC_REQ_SIZE,
+			req_buffer[index], ASYNC_REQ_SIZE, request_done, RT_NULL);
+		if (rt_device_submit(&async_dev, &req[index]) != RT_EOK)
+			goto _failed;
+	}
+	/* a pending request could not be submitted again */
+	if (rt_device_submit(&async_dev, &req[0]) != -RT_EBUSY)
+		goto _failed;
+	/* cancel the last one, the head one is being transferred */
+	if (rt_device_cancel(&async_dev, &req[ASYNC_REQ_NUM - 1]) != RT_EOK ||
+		rt_device_cancel(&async_dev, &req[0]) != -RT_EBUSY)
+		goto _failed;
+	if (done_count != 1 || req[ASYNC_REQ_NUM - 1].error != -RT_EINTR)
+		goto _failed;
+
+	rt_timer_start(&async_timer);
+	for (index = 0; index < ASYNC_REQ_NUM; index ++)
+	{
+		if (rt_sem_take(&done_sem, RT_TICK_PER_SECOND) != RT_EOK)
+			goto _failed;
+	}
+	for (index = 0; index < ASYNC_REQ_NUM - 1; index ++)
+	{
+		if (done_order[index + 1] != index || req[index].error != RT_EOK ||
+			req[index].result != ASYNC_REQ_SIZE)
+			goto _failed;
+		if (!buffer_check(&async_media[index * ASYNC_REQ_SIZE], index + 1, ASYNC_REQ_SIZE))
+			goto _failed;
+	}
+	if (!buffer_check(&async_media[(ASYNC_REQ_NUM - 1) * ASYNC_REQ_SIZE], 0, ASYNC_REQ_SIZE))
+		goto _failed;
+	/* a completed request could not be cancelled */
+	if (rt_device_cancel(&async_dev, &req[0]) != -RT_ERROR)
+		goto _failed;
+
+	/* read back */
+	done_count = 0;
+	rt_device_request_init(&req[0], RT_DEVICE_REQ_READ, ASYNC_REQ_SIZE,
+		req_buffer[0], ASYNC_REQ_SIZE, request_done, RT_NULL);
+	if (rt_device_submit(&async_dev, &req[0]) != RT_EOK ||
+		rt_sem_take(&done_sem, RT_TICK_PER_SECOND) != RT_EOK ||
+		!buffer_check(req_buffer[0], 2, ASYNC_REQ_SIZE))
+		goto _failed;
+
+	/* synchronous fallback, completed before submit returns */
+	rt_device_request_init(&req[1], RT_DEVICE_REQ_READ, 0x5a,
+		req_buffer[1], ASYNC_REQ_SIZE, request_done, RT_NULL);
+	if (rt_device_submit(&sync_dev, &req[1]) != RT_EOK ||
+		rt_sem_take(&done_sem, 0) != RT_EOK ||
+		req[1].result != ASYNC_REQ_SIZE ||
+		!buffer_check(req_buffer[1], 0x5a, ASYNC_REQ_SIZE))
+		goto _failed;
+	/* a short read completes with error */
+	rt_device_request_init(&req[1], RT_DEVICE_REQ_READ, 0x100,
+		req_buffer[1], ASYNC_REQ_SIZE, request_done, RT_NULL);
+	if (rt_device_submit(&sync_dev, &req[1]) != RT_EOK ||
+		rt_sem_take(&done_sem, 0) != RT_EOK ||
+		req[1].result != ASYNC_REQ_SIZE / 2 || req[1].error != -RT_EIO)
+		goto _failed;
+	/* no write interface */
+	rt_device_request_init(&req[1], RT_DEVICE_REQ_WRITE, 0,
+		req_buffer[1], ASYNC_REQ_SIZE, request_done, RT_NULL);
+	if (rt_device_submit(&sync_dev, &req[1]) != -RT_ENOSYS)
+		goto _failed;
+
+	tc_done(TC_STAT_PASSED);
+	goto _exit;
+
+_failed:
+	tc_done(TC_STAT_FAILED);
+
+_exit:
+	rt_timer_detach(&async_timer);
+	rt_sem_detach(&done_sem);
+	if (async_dev.ref_count)
+		rt_device_close(&async_dev);
+	if (sync_dev.ref_count)
+		rt_device_close(&sync_dev);
+	if (rt_device_find("async") == &async_dev)
+		rt_device_unregister(&async_dev);
+	if (rt_device_find("sync") == &sync_dev)
+		rt_device_unregister(&sync_dev);
+}
+
+#ifdef RT_USING_TC
+int _tc_device_async()
+{
+	device_async_init();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_device_async, a device asynchronous request test);
+#else
+int rt_application_init()
+{
+	device_async_init();
+
+	return 0;
+}
+#endif
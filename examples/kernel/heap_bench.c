@@ -0,0 +1,148 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a benchmark for the heap backend.
+ *
+ * Random sized blocks are allocated and released randomly in
+ * HEAP_BENCH_SLOTS slots for one second, it counts:
+ *  - ops: the number of rt_malloc/rt_free done in one second;
+ *  - worst: the max time of one rt_malloc/rt_free, counted by
+ *    HEAP_BENCH_CLOCK which could be defined as a hardware cycle counter;
+ *  - fragmentation: the largest block could be allocated compared with the
+ *    free memory, while the slots are still in use.
+ *
+ * Run it with each heap backend: RT_USING_SMALL_MEM, RT_USING_SLAB,
+ * RT_USING_MEMHEAP_AS_HEAP and RT_USING_TLSF.
+ */
+
+#define HEAP_BENCH_SLOTS	64
+#define HEAP_BENCH_WINDOW	RT_TICK_PER_SECOND
+
+#ifndef HEAP_BENCH_CLOCK
+#define HEAP_BENCH_CLOCK()	rt_tick_get()
+#endif
+
+static void *heap_bench_slot[HEAP_BENCH_SLOTS];
+static rt_uint32_t heap_bench_seed;
+
+static rt_uint32_t heap_bench_rand(void)
+{
+	heap_bench_seed = heap_bench_seed * 1103515245 + 12345;
+
+	return (heap_bench_seed >> 16) & 0x7fff;
+}
+
+static rt_size_t heap_bench_size(void)
+{
+	/* most blocks are small, and some are large */
+	if (heap_bench_rand() % 16 == 0)
+		return 1024 + heap_bench_rand() % 4096;
+
+	return 16 + heap_bench_rand() % 256;
+}
+
+static rt_size_t heap_bench_largest(rt_size_t total)
+{
+	rt_size_t low, high, middle;
+	void *ptr;
+
+	/* binary search the largest block could be allocated */
+	low = 0;
+	high = total;
+	while (low + RT_ALIGN_SIZE < high)
+	{
+		middle = RT_ALIGN_DOWN((low + high) / 2, RT_ALIGN_SIZE);
+		ptr = rt_malloc(middle);
+		if (ptr != RT_NULL)
+		{
+			rt_free(ptr);
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+void heap_bench(void)
+{
+	rt_uint32_t index, ops, failed, worst, start, elapsed;
+	rt_uint32_t total, used, max_used;
+	rt_tick_t tick;
+
+#if defined(RT_USING_TLSF)
+	rt_kprintf("heap backend: tlsf\n");
+#elif defined(RT_USING_MEMHEAP_AS_HEAP)
+	rt_kprintf("heap backend: memheap\n");
+#elif defined(RT_USING_SLAB)
+	rt_kprintf("heap backend: slab\n");
+#else
+	rt_kprintf("heap backend: small mem\n");
+#endif
+
+	heap_bench_seed = 1;
+	ops = failed = worst = 0;
+
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < HEAP_BENCH_WINDOW)
+	{
+		index = heap_bench_rand() % HEAP_BENCH_SLOTS;
+
+		start = HEAP_BENCH_CLOCK();
+		if (heap_bench_slot[index] != RT_NULL)
+		{
+			rt_free(heap_bench_slot[index]);
+			heap_bench_slot[index] = RT_NULL;
+		}
+		else
+		{
+			heap_bench_slot[index] = rt_malloc(heap_bench_size());
+			if (heap_bench_slot[index] == RT_NULL)
+				failed ++;
+		}
+		elapsed = HEAP_BENCH_CLOCK() - start;
+
+		if (elapsed > worst)
+			worst = elapsed;
+		ops ++;
+	}
+
+	rt_memory_info(&total, &used, &max_used);
+	rt_kprintf("ops  : %8d ops/s, %d failed, worst %d\n",
+		ops * RT_TICK_PER_SECOND / HEAP_BENCH_WINDOW, failed, worst);
+	rt_kprintf("frag : free %d, largest block %d\n",
+		total - used, heap_bench_largest(total));
+
+	for (index = 0; index < HEAP_BENCH_SLOTS; index ++)
+	{
+		if (heap_bench_slot[index] != RT_NULL)
+		{
+			rt_free(heap_bench_slot[index]);
+			heap_bench_slot[index] = RT_NULL;
+		}
+	}
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(heap_bench, benchmark of the heap backend);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_heap_bench()
+{
+	heap_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_heap_bench, a heap backend benchmark);
+#else
+int rt_application_init()
+{
+	heap_bench();
+
+	return 0;
+}
+#endif
@@ -0,0 +1,135 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a multi-threaded benchmark for the small blocks of heap.
+ *
+ * HEAP_MT_THREADS threads with the same priority allocate and release random
+ * 8 to 64 bytes blocks in their own slots for HEAP_MT_WINDOW ticks, it counts
+ * the number of rt_malloc/rt_free done in one second by all threads and
+ * verifies the content of blocks.
+ *
+ * Run it with RT_USING_SLAB, with and without RT_USING_SLAB_MAGAZINE, the
+ * magazine hit and miss are listed by list_magazine.
+ */
+
+#define HEAP_MT_THREADS		4
+#define HEAP_MT_SLOTS		16
+#define HEAP_MT_WINDOW		RT_TICK_PER_SECOND
+
+static volatile rt_uint8_t heap_mt_stop;
+static volatile rt_uint8_t heap_mt_done[HEAP_MT_THREADS];
+static rt_uint32_t heap_mt_ops[HEAP_MT_THREADS];
+static rt_uint32_t heap_mt_errors;
+
+static void heap_mt_entry(void* parameter)
+{
+	rt_uint8_t *slot[HEAP_MT_SLOTS];
+	rt_uint8_t size[HEAP_MT_SLOTS];
+	rt_uint32_t id, seed, index;
+
+	id = (rt_uint32_t)parameter;
+	seed = id + 1;
+	rt_memset(slot, 0, sizeof(slot));
+
+	while (!heap_mt_stop)
+	{
+		seed = seed * 1103515245 + 12345;
+		index = (seed >> 16) % HEAP_MT_SLOTS;
+
+		if (slot[index] != RT_NULL)
+		{
+			if (slot[index][0] != index || slot[index][size[index] - 1] != index)
+				heap_mt_errors ++;
+
+			rt_free(slot[index]);
+			slot[index] = RT_NULL;
+		}
+		else
+		{
+			size[index] = 8 + (seed >> 8) % 57;
+			slot[index] = rt_malloc(size[index]);
+			if (slot[index] == RT_NULL)
+			{
+				heap_mt_errors ++;
+				continue;
+			}
+
+			slot[index][0] = index;
+			slot[index][size[index] - 1] = index;
+		}
+		heap_mt_ops[id] ++;
+	}
+
+	for (index = 0; index < HEAP_MT_SLOTS; index ++)
+		rt_free(slot[index]);
+
+	heap_mt_done[id] = 1;
+}
+
+void heap_mt_bench(void)
+{
+	rt_uint32_t index, ops;
+	rt_thread_t thread;
+
+	heap_mt_stop = 0;
+	heap_mt_errors = 0;
+	for (index = 0; index < HEAP_MT_THREADS; index ++)
+	{
+		heap_mt_ops[index] = 0;
+		heap_mt_done[index] = 0;
+
+		/* lower priority than the caller, they run in time slices */
+		thread = rt_thread_create("heapmt", heap_mt_entry, (void *)index,
+			THREAD_STACK_SIZE, rt_thread_self()->current_priority + 1, 1);
+		if (thread == RT_NULL)
+		{
+			heap_mt_done[index] = 1;
+			tc_stat(TC_STAT_FAILED);
+			continue;
+		}
+		rt_thread_startup(thread);
+	}
+
+	rt_thread_delay(HEAP_MT_WINDOW);
+
+	/* stop threads, which are deleted by idle thread after exit */
+	heap_mt_stop = 1;
+	for (index = 0; index < HEAP_MT_THREADS; index ++)
+	{
+		while (!heap_mt_done[index])
+			rt_thread_delay(1);
+	}
+
+	ops = 0;
+	for (index = 0; index < HEAP_MT_THREADS; index ++)
+		ops += heap_mt_ops[index];
+
+#ifdef RT_USING_SLAB_MAGAZINE
+	rt_kprintf("slab magazine: on\n");
+#endif
+	rt_kprintf("%d threads: %8d ops/s, %d errors\n", HEAP_MT_THREADS,
+		ops * RT_TICK_PER_SECOND / HEAP_MT_WINDOW, heap_mt_errors);
+	if (heap_mt_errors != 0)
+		tc_stat(TC_STAT_FAILED);
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(heap_mt_bench, multi-threaded benchmark of small heap blocks);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_heap_mt_bench()
+{
+	heap_mt_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_heap_mt_bench, a multi-threaded heap benchmark);
+#else
+int rt_application_init()
+{
+	heap_mt_bench();
+
+	return 0;
+}
+#endif
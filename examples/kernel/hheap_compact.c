@@ -0,0 +1,138 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a test for the compaction of handle heap.
+ *
+ * The handle heap is fragmented by releasing every other block, then:
+ *  - a block larger than any hole is allocated, which compacts the heap;
+ *  - a locked block is not moved by the compaction;
+ *  - the idle thread gathers the holes above top when the system is idle;
+ * and the data of all the blocks are kept.
+ */
+
+#define HHEAP_TEST_BLOCKS	16
+#define HHEAP_TEST_SIZE		200
+
+static rt_uint8_t hheap_area[HHEAP_TEST_BLOCKS * (HHEAP_TEST_SIZE + 32) + 512];
+static struct rt_hheap hheap;
+static rt_handle_t handle[HHEAP_TEST_BLOCKS];
+
+static rt_bool_t hheap_check(rt_handle_t h, rt_uint8_t value, rt_size_t size)
+{
+	rt_uint8_t *ptr;
+	rt_bool_t result = RT_TRUE;
+
+	ptr = rt_hheap_lock(h);
+	while (size --)
+	{
+		if (*ptr++ != value)
+			result = RT_FALSE;
+	}
+	rt_hheap_unlock(h);
+
+	return result;
+}
+
+static void hheap_compact_init()
+{
+	rt_handle_t large;
+	rt_uint8_t *pinned, *ptr;
+	rt_uint32_t index;
+	rt_tick_t tick;
+
+	if (rt_hheap_init(&hheap, "hheap", hheap_area, sizeof(hheap_area),
+		HHEAP_TEST_BLOCKS + 1) != RT_EOK)
+		goto _failed;
+
+	/* fill the heap */
+	for (index = 0; index < HHEAP_TEST_BLOCKS; index ++)
+	{
+		handle[index] = rt_hheap_alloc(&hheap, HHEAP_TEST_SIZE);
+		if (handle[index] == RT_NULL)
+			goto _failed;
+
+		ptr = rt_hheap_lock(handle[index]);
+		rt_memset(ptr, index, HHEAP_TEST_SIZE);
+		rt_hheap_unlock(handle[index]);
+	}
+
+	/* release every other block, the holes are smaller than 2 blocks */
+	for (index = 0; index < HHEAP_TEST_BLOCKS; index += 2)
+	{
+		rt_hheap_free(handle[index]);
+		handle[index] = RT_NULL;
+	}
+
+	/* the locked block shall not be moved */
+	pinned = rt_hheap_lock(handle[HHEAP_TEST_BLOCKS - 1]);
+
+	large = rt_hheap_alloc(&hheap, HHEAP_TEST_SIZE * 4);
+	if (large == RT_NULL)
+		goto _failed;
+	if (rt_hheap_lock(handle[HHEAP_TEST_BLOCKS - 1]) != pinned)
+		goto _failed;
+	rt_hheap_unlock(handle[HHEAP_TEST_BLOCKS - 1]);
+	rt_hheap_unlock(handle[HHEAP_TEST_BLOCKS - 1]);
+
+	for (index = 1; index < HHEAP_TEST_BLOCKS; index += 2)
+	{
+		if (hheap_check(handle[index], index, HHEAP_TEST_SIZE) == RT_FALSE)
+			goto _failed;
+	}
+	rt_hheap_free(large);
+
+	/* the idle thread compacts the heap in background */
+	for (index = 1; index < HHEAP_TEST_BLOCKS; index += 4)
+	{
+		rt_hheap_free(handle[index]);
+		handle[index] = RT_NULL;
+	}
+	tick = rt_tick_get();
+	while (hheap.available != (rt_size_t)(hheap.end - hheap.top))
+	{
+		if (rt_tick_get() - tick > RT_TICK_PER_SECOND)
+			goto _failed;
+		rt_thread_delay(1);
+	}
+
+	for (index = 3; index < HHEAP_TEST_BLOCKS; index += 4)
+	{
+		if (hheap_check(handle[index], index, HHEAP_TEST_SIZE) == RT_FALSE)
+			goto _failed;
+	}
+
+	tc_done(TC_STAT_PASSED);
+	goto _exit;
+
+_failed:
+	tc_done(TC_STAT_FAILED);
+
+_exit:
+	for (index = 0; index < HHEAP_TEST_BLOCKS; index ++)
+	{
+		if (handle[index] != RT_NULL)
+		{
+			rt_hheap_free(handle[index]);
+			handle[index] = RT_NULL;
+		}
+	}
+	rt_hheap_detach(&hheap);
+}
+
+#ifdef RT_USING_TC
+int _tc_hheap_compact()
+{
+	hheap_compact_init();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_hheap_compact, a handle heap compaction test);
+#else
+int rt_application_init()
+{
+	hheap_compact_init();
+
+	return 0;
+}
+#endif
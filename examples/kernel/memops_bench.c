@@ -0,0 +1,154 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a benchmark for rt_memcpy, rt_memset and rt_memcmp.
+ *
+ * Each function runs on the sizes from 1 byte to 64 KB, on word aligned
+ * buffers and on unaligned buffers. It prints the bytes done in one clock counted by
+ * MEMOPS_BENCH_CLOCK, which could be defined as a hardware cycle counter to
+ * get bytes/cycle, and checks the result of each function.
+ *
+ * Run it with and without RT_USING_CPU_MEMOPS, and RT_TINY_SIZE.
+ */
+
+#define MEMOPS_BENCH_MAX	(64 * 1024)
+/* bytes done in each size */
+#define MEMOPS_BENCH_BYTES	(1024 * 1024)
+
+#ifndef MEMOPS_BENCH_CLOCK
+#define MEMOPS_BENCH_CLOCK()	rt_tick_get()
+#endif
+
+static rt_uint8_t *memops_src, *memops_dst;
+
+static void memops_rate(rt_uint32_t bytes, rt_uint32_t elapsed)
+{
+	if (elapsed == 0)
+		elapsed = 1;
+
+	/* bytes per clock, with two decimals */
+	rt_kprintf(" %6d.%02d", bytes / elapsed,
+		(bytes % elapsed) / (elapsed / 100 + 1));
+}
+
+static rt_bool_t memops_bench_size(rt_size_t size, rt_bool_t aligned)
+{
+	rt_uint32_t loop, count, start;
+	rt_uint32_t cpy, set, cmp;
+	rt_uint8_t *src, *dst;
+	rt_size_t index;
+	rt_int32_t result;
+
+	src = memops_src;
+	dst = memops_dst;
+	if (aligned == RT_FALSE)
+	{
+		/* both unaligned, and in different alignment */
+		src += 1;
+		dst += 3;
+	}
+	count = MEMOPS_BENCH_BYTES / size;
+
+	start = MEMOPS_BENCH_CLOCK();
+	for (loop = 0; loop < count; loop ++)
+		rt_memcpy(dst, src, size);
+	cpy = MEMOPS_BENCH_CLOCK() - start;
+	for (index = 0; index < size; index ++)
+	{
+		if (dst[index] != src[index])
+			return RT_FALSE;
+	}
+
+	start = MEMOPS_BENCH_CLOCK();
+	for (loop = 0; loop < count; loop ++)
+	{
+		if (rt_memcmp(dst, src, size) != 0)
+			return RT_FALSE;
+	}
+	cmp = MEMOPS_BENCH_CLOCK() - start;
+
+	/* the last byte differs */
+	dst[size - 1] ^= 0x80;
+	result = rt_memcmp(dst, src, size);
+	if ((src[size - 1] & 0x80) ? result >= 0 : result <= 0)
+		return RT_FALSE;
+
+	start = MEMOPS_BENCH_CLOCK();
+	for (loop = 0; loop < count; loop ++)
+		rt_memset(dst, loop, size);
+	set = MEMOPS_BENCH_CLOCK() - start;
+	for (index = 0; index < size; index ++)
+	{
+		if (dst[index] != (rt_uint8_t)(count - 1))
+			return RT_FALSE;
+	}
+
+	rt_kprintf("%6d %s", size, aligned ? "a" : "u");
+	memops_rate(count * size, cpy);
+	memops_rate(count * size, set);
+	memops_rate(count * size, cmp);
+	rt_kprintf("\n");
+
+	return RT_TRUE;
+}
+
+void memops_bench(void)
+{
+	rt_size_t size, index;
+	rt_bool_t passed = RT_TRUE;
+
+	/* one more word for the unaligned buffers */
+	memops_src = rt_malloc(MEMOPS_BENCH_MAX + sizeof(rt_ubase_t));
+	memops_dst = rt_malloc(MEMOPS_BENCH_MAX + sizeof(rt_ubase_t));
+	if (memops_src == RT_NULL || memops_dst == RT_NULL)
+	{
+		rt_kprintf("no memory for memops bench\n");
+		tc_stat(TC_STAT_FAILED);
+		goto __exit;
+	}
+
+	for (index = 0; index < MEMOPS_BENCH_MAX + sizeof(rt_ubase_t); index ++)
+		memops_src[index] = index * 7 + 1;
+
+	rt_kprintf("  size      memcpy    memset    memcmp (bytes per clock)\n");
+	for (size = 1; size <= MEMOPS_BENCH_MAX; size <<= 2)
+	{
+		if (memops_bench_size(size, RT_TRUE) == RT_FALSE ||
+			memops_bench_size(size, RT_FALSE) == RT_FALSE)
+		{
+			rt_kprintf("%d bytes: wrong result\n", size);
+			passed = RT_FALSE;
+		}
+	}
+
+	if (passed == RT_FALSE)
+		tc_stat(TC_STAT_FAILED);
+
+__exit:
+	if (memops_src != RT_NULL)
+		rt_free(memops_src);
+	if (memops_dst != RT_NULL)
+		rt_free(memops_dst);
+	memops_src = memops_dst = RT_NULL;
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(memops_bench, benchmark of rt_memcpy/rt_memset/rt_memcmp);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_memops_bench()
+{
+	memops_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_memops_bench, a memcpy/memset/memcmp benchmark);
+#else
+int rt_application_init()
+{
+	memops_bench();
+
+	return 0;
+}
+#endif
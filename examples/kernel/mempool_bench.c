@@ -0,0 +1,125 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a throughput benchmark for the memory pool.
+ *
+ * A timer allocates and releases MP_BENCH_BURST blocks in each tick
+ * interrupt, like a network driver receiving frames, while a thread
+ * allocates and releases blocks as fast as it can. It counts:
+ *  - ops: the number of rt_mp_alloc/rt_mp_free done by the thread in one
+ *    second;
+ *  - worst: the max time of one rt_mp_alloc/rt_mp_free, counted by
+ *    MP_BENCH_CLOCK which could be defined as a hardware cycle counter.
+ *
+ * Run it with and without RT_USING_MEMPOOL_LOCKFREE.
+ */
+
+#define MP_BENCH_BLOCKS		32
+#define MP_BENCH_BLOCK_SIZE	64
+#define MP_BENCH_BURST		4
+#define MP_BENCH_WINDOW		RT_TICK_PER_SECOND
+
+#ifndef MP_BENCH_CLOCK
+#define MP_BENCH_CLOCK()	rt_tick_get()
+#endif
+
+static rt_uint8_t mp_bench_pool[MP_BENCH_BLOCKS *
+	(MP_BENCH_BLOCK_SIZE + sizeof(rt_uint8_t *))];
+static struct rt_mempool mp_bench_mp;
+static rt_uint32_t mp_bench_isr_ops, mp_bench_isr_failed;
+
+static void mp_bench_isr(void* parameter)
+{
+	void *block[MP_BENCH_BURST];
+	rt_uint32_t index;
+
+	for (index = 0; index < MP_BENCH_BURST; index ++)
+	{
+		block[index] = rt_mp_alloc(&mp_bench_mp, 0);
+		if (block[index] == RT_NULL)
+			mp_bench_isr_failed ++;
+	}
+
+	for (index = 0; index < MP_BENCH_BURST; index ++)
+	{
+		if (block[index] != RT_NULL)
+		{
+			rt_mp_free(block[index]);
+			mp_bench_isr_ops ++;
+		}
+	}
+}
+
+void mempool_bench(void)
+{
+	struct rt_timer timer;
+	void *block;
+	rt_uint32_t ops, worst, start, elapsed;
+	rt_tick_t tick;
+
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+	rt_kprintf("mempool mode: lock-free\n");
+#else
+	rt_kprintf("mempool mode: locked\n");
+#endif
+
+	rt_mp_init(&mp_bench_mp, "mpbench", mp_bench_pool,
+		sizeof(mp_bench_pool), MP_BENCH_BLOCK_SIZE);
+	mp_bench_isr_ops = mp_bench_isr_failed = 0;
+	ops = worst = 0;
+
+	rt_timer_init(&timer, "mpisr", mp_bench_isr, RT_NULL, 1,
+		RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+	rt_timer_start(&timer);
+
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < MP_BENCH_WINDOW)
+	{
+		start = MP_BENCH_CLOCK();
+		block = rt_mp_alloc(&mp_bench_mp, 0);
+		if (block != RT_NULL)
+		{
+			*(rt_uint32_t *)block = ops;
+			rt_mp_free(block);
+		}
+		elapsed = MP_BENCH_CLOCK() - start;
+
+		if (elapsed > worst)
+			worst = elapsed;
+		ops ++;
+	}
+
+	rt_timer_detach(&timer);
+
+	rt_kprintf("ops  : %8d ops/s, worst %d\n",
+		ops * RT_TICK_PER_SECOND / MP_BENCH_WINDOW, worst);
+	rt_kprintf("isr  : %8d blocks, %d failed\n",
+		mp_bench_isr_ops, mp_bench_isr_failed);
+
+	/* all the blocks are released */
+	if (mp_bench_mp.block_free_count != mp_bench_mp.block_total_count)
+		tc_stat(TC_STAT_FAILED);
+
+	rt_mp_detach(&mp_bench_mp);
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(mempool_bench, throughput benchmark of memory pool);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_mempool_bench()
+{
+	mempool_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_mempool_bench, a memory pool throughput benchmark);
+#else
+int rt_application_init()
+{
+	mempool_bench();
+
+	return 0;
+}
+#endif
@@ -0,0 +1,170 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a benchmark for the message queue copy API and zero-copy loan API.
+ *
+ * For message size from 16 to 4096 bytes, a producer thread fills messages
+ * and a consumer thread with the same priority verifies them, it counts the
+ * number of messages transferred in one second:
+ *  - copy: rt_mq_send/rt_mq_recv, the message is copied into and out of the
+ *    message queue;
+ *  - loan: rt_mq_reserve/rt_mq_commit and rt_mq_recv_loan/rt_mq_release, the
+ *    message is filled and verified in place.
+ */
+
+#define MQ_BENCH_MSGS		8
+#define MQ_BENCH_MAX_SIZE	4096
+#define MQ_BENCH_WINDOW		RT_TICK_PER_SECOND
+
+static rt_mq_t mq_bench;
+static rt_size_t mq_bench_size;
+static rt_uint8_t mq_bench_loan;
+static rt_uint8_t mq_bench_tx[MQ_BENCH_MAX_SIZE];
+static rt_uint8_t mq_bench_rx[MQ_BENCH_MAX_SIZE];
+
+static volatile rt_uint8_t mq_bench_stop, mq_bench_done;
+static rt_uint32_t mq_bench_errors;
+
+static void mq_bench_producer_entry(void* parameter)
+{
+	rt_uint8_t seq, *ptr;
+	rt_err_t result;
+
+	seq = 0;
+	while (!mq_bench_stop)
+	{
+		if (mq_bench_loan)
+		{
+			result = rt_mq_reserve(mq_bench, (void **)&ptr);
+			if (result == RT_EOK)
+			{
+				rt_memset(ptr, seq, mq_bench_size);
+				rt_mq_commit(mq_bench, ptr);
+			}
+		}
+		else
+		{
+			rt_memset(mq_bench_tx, seq, mq_bench_size);
+			result = rt_mq_send(mq_bench, mq_bench_tx, mq_bench_size);
+		}
+
+		/* message queue is full, let consumer run */
+		if (result != RT_EOK)
+		{
+			rt_thread_yield();
+			continue;
+		}
+		seq ++;
+	}
+
+	mq_bench_done = 1;
+}
+
+static rt_uint32_t mq_bench_run(rt_size_t size, rt_uint8_t loan)
+{
+	rt_uint8_t seq, *ptr;
+	rt_uint32_t count;
+	rt_tick_t tick;
+	rt_thread_t producer;
+
+	mq_bench = rt_mq_create("mqbench", size, MQ_BENCH_MSGS, RT_IPC_FLAG_FIFO);
+	if (mq_bench == RT_NULL)
+	{
+		tc_stat(TC_STAT_FAILED);
+		return 0;
+	}
+
+	mq_bench_size = size;
+	mq_bench_loan = loan;
+	mq_bench_stop = mq_bench_done = 0;
+
+	/* the producer has the same priority as the consumer */
+	producer = rt_thread_create("mqprod", mq_bench_producer_entry, RT_NULL,
+		THREAD_STACK_SIZE, rt_thread_self()->current_priority, THREAD_TIMESLICE);
+	if (producer == RT_NULL)
+	{
+		rt_mq_delete(mq_bench);
+		tc_stat(TC_STAT_FAILED);
+		return 0;
+	}
+	rt_thread_startup(producer);
+
+	seq = 0;
+	count = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < MQ_BENCH_WINDOW)
+	{
+		if (loan)
+		{
+			if (rt_mq_recv_loan(mq_bench, (void **)&ptr, 1) != RT_EOK)
+				continue;
+		}
+		else
+		{
+			if (rt_mq_recv(mq_bench, mq_bench_rx, size, 1) != RT_EOK)
+				continue;
+			ptr = mq_bench_rx;
+		}
+
+		if (ptr[0] != seq || ptr[size - 1] != seq)
+			mq_bench_errors ++;
+		if (loan)
+			rt_mq_release(mq_bench, ptr);
+
+		seq ++;
+		count ++;
+	}
+
+	/* stop producer, which is deleted by idle thread after exit */
+	mq_bench_stop = 1;
+	while (!mq_bench_done)
+		rt_thread_delay(1);
+
+	rt_mq_delete(mq_bench);
+
+	return count;
+}
+
+void messageq_bench(void)
+{
+	rt_size_t size;
+	rt_uint32_t copy, loan;
+
+	mq_bench_errors = 0;
+	for (size = 16; size <= MQ_BENCH_MAX_SIZE; size *= 4)
+	{
+		copy = mq_bench_run(size, 0);
+		loan = mq_bench_run(size, 1);
+
+		rt_kprintf("%4d bytes: copy %8d msgs/s, loan %8d msgs/s\n",
+			size, copy * RT_TICK_PER_SECOND / MQ_BENCH_WINDOW,
+			loan * RT_TICK_PER_SECOND / MQ_BENCH_WINDOW);
+	}
+
+	if (mq_bench_errors != 0)
+	{
+		rt_kprintf("message queue bench: %d errors\n", mq_bench_errors);
+		tc_stat(TC_STAT_FAILED);
+	}
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(messageq_bench, benchmark of message queue copy and loan API);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_messageq_bench()
+{
+	messageq_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_messageq_bench, a message queue zero-copy benchmark);
+#else
+int rt_application_init()
+{
+	messageq_bench();
+
+	return 0;
+}
+#endif
@@ -0,0 +1,153 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a benchmark for finding object by name.
+ *
+ * It registers OBJECT_BENCH_DEVICES devices and OBJECT_BENCH_SEMS semaphores,
+ * then counts the number of rt_device_find and rt_object_find done in one
+ * second, for all the registered names and for a name which is not
+ * registered. Put it in the application initialization to measure the lookup
+ * at boot time, with and without RT_USING_OBJECT_HASH defined.
+ */
+
+#define OBJECT_BENCH_DEVICES	150
+#define OBJECT_BENCH_SEMS		300
+#define OBJECT_BENCH_WINDOW		RT_TICK_PER_SECOND
+
+static void object_bench_name(char *name, char prefix, rt_uint32_t index)
+{
+	rt_snprintf(name, RT_NAME_MAX, "%c%d", prefix, index);
+}
+
+static rt_uint32_t object_bench_devices(void)
+{
+	rt_uint32_t index, count;
+	rt_tick_t tick;
+	char name[RT_NAME_MAX];
+
+	count = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < OBJECT_BENCH_WINDOW)
+	{
+		for (index = 0; index < OBJECT_BENCH_DEVICES; index ++)
+		{
+			object_bench_name(name, 'd', index);
+			if (rt_device_find(name) == RT_NULL)
+				tc_stat(TC_STAT_FAILED);
+		}
+		count += OBJECT_BENCH_DEVICES;
+	}
+
+	return count;
+}
+
+static rt_uint32_t object_bench_sems(void)
+{
+	rt_uint32_t index, count;
+	rt_tick_t tick;
+	char name[RT_NAME_MAX];
+
+	count = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < OBJECT_BENCH_WINDOW)
+	{
+		for (index = 0; index < OBJECT_BENCH_SEMS; index ++)
+		{
+			object_bench_name(name, 's', index);
+			if (rt_object_find(name, RT_Object_Class_Semaphore) == RT_NULL)
+				tc_stat(TC_STAT_FAILED);
+		}
+		count += OBJECT_BENCH_SEMS;
+	}
+
+	return count;
+}
+
+static rt_uint32_t object_bench_missing(void)
+{
+	rt_uint32_t count;
+	rt_tick_t tick;
+
+	count = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < OBJECT_BENCH_WINDOW)
+	{
+		if (rt_device_find("missing") != RT_NULL)
+			tc_stat(TC_STAT_FAILED);
+		count ++;
+	}
+
+	return count;
+}
+
+void object_find_bench(void)
+{
+	rt_uint32_t index;
+	struct rt_device *devices;
+	struct rt_semaphore *sems;
+	char name[RT_NAME_MAX];
+
+	devices = (struct rt_device*)rt_malloc(sizeof(struct rt_device) * OBJECT_BENCH_DEVICES);
+	sems = (struct rt_semaphore*)rt_malloc(sizeof(struct rt_semaphore) * OBJECT_BENCH_SEMS);
+	if (devices == RT_NULL || sems == RT_NULL)
+	{
+		rt_kprintf("object find bench: no memory\n");
+		tc_stat(TC_STAT_FAILED);
+
+		if (devices != RT_NULL) rt_free(devices);
+		if (sems != RT_NULL) rt_free(sems);
+		return;
+	}
+
+	rt_memset(devices, 0, sizeof(struct rt_device) * OBJECT_BENCH_DEVICES);
+	for (index = 0; index < OBJECT_BENCH_DEVICES; index ++)
+	{
+		object_bench_name(name, 'd', index);
+		rt_device_register(&devices[index], name, RT_DEVICE_FLAG_RDWR);
+	}
+	for (index = 0; index < OBJECT_BENCH_SEMS; index ++)
+	{
+		object_bench_name(name, 's', index);
+		rt_sem_init(&sems[index], name, 0, RT_IPC_FLAG_FIFO);
+	}
+
+#ifdef RT_USING_OBJECT_HASH
+	rt_kprintf("object find: hash index\n");
+#else
+	rt_kprintf("object find: list\n");
+#endif
+	rt_kprintf("%4d devices   : %8d finds/s\n", OBJECT_BENCH_DEVICES,
+		object_bench_devices());
+	rt_kprintf("%4d semaphores: %8d finds/s\n", OBJECT_BENCH_SEMS,
+		object_bench_sems());
+	rt_kprintf("missing device : %8d finds/s\n", object_bench_missing());
+
+	for (index = 0; index < OBJECT_BENCH_DEVICES; index ++)
+		rt_device_unregister(&devices[index]);
+	for (index = 0; index < OBJECT_BENCH_SEMS; index ++)
+		rt_sem_detach(&sems[index]);
+
+	rt_free(devices);
+	rt_free(sems);
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(object_find_bench, benchmark of finding object by name);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_object_find_bench()
+{
+	object_find_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_object_find_bench, a object finding benchmark);
+#else
+int rt_application_init()
+{
+	object_find_bench();
+
+	return 0;
+}
+#endif
@@ -0,0 +1,220 @@
+#include <rtthread.h>
+#include <rthw.h>
+#include <rtdevice.h>
+#include "tc_comm.h"
+
+/*
+ * This is a stress benchmark for the single-producer/single-consumer ring
+ * buffer.
+ *
+ *  - isr: the producer is a timer which fills the ring buffer in the tick
+ *    interrupt by rt_spsc_ringbuffer_reserve/commit, and the consumer thread
+ *    drains it by rt_spsc_ringbuffer_peek/release;
+ *  - thread: the producer and consumer threads transfer data by
+ *    rt_spsc_ringbuffer_put/get, compared with rt_ringbuffer_put/get which
+ *    are protected by disabling interrupt.
+ *
+ * The data is a byte sequence which is verified by the consumer.
+ */
+
+#define RB_BENCH_POOL_SIZE	1024
+#define RB_BENCH_CHUNK		200
+#define RB_BENCH_WINDOW		(RT_TICK_PER_SECOND * 2)
+
+static rt_uint8_t rb_pool[RB_BENCH_POOL_SIZE];
+static struct rt_spsc_ringbuffer spsc_rb;
+static struct rt_ringbuffer locked_rb;
+static rt_uint8_t use_locked;
+
+static rt_uint8_t put_seq, get_seq;
+static volatile rt_uint8_t rb_bench_stop, rb_bench_done;
+static rt_uint32_t rb_bench_bytes, rb_bench_errors;
+
+static void rb_bench_isr_producer(void* parameter)
+{
+	rt_uint8_t *ptr;
+	rt_size_t index, length;
+
+	/* fill all the empty space, which may be split at the end of buffer */
+	while ((length = rt_spsc_ringbuffer_reserve(&spsc_rb, &ptr)) > 0)
+	{
+		for (index = 0; index < length; index ++)
+			ptr[index] = put_seq ++;
+		rt_spsc_ringbuffer_commit(&spsc_rb, length);
+	}
+}
+
+static void rb_bench_isr(void)
+{
+	struct rt_timer timer;
+	rt_uint8_t *ptr;
+	rt_size_t index, length;
+	rt_tick_t tick;
+
+	rt_spsc_ringbuffer_init(&spsc_rb, rb_pool, sizeof(rb_pool));
+	put_seq = get_seq = 0;
+	rb_bench_bytes = rb_bench_errors = 0;
+
+	rt_timer_init(&timer, "rbisr", rb_bench_isr_producer, RT_NULL, 1,
+		RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+	rt_timer_start(&timer);
+
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < RB_BENCH_WINDOW)
+	{
+		length = rt_spsc_ringbuffer_peek(&spsc_rb, &ptr);
+		if (length == 0)
+		{
+			rt_thread_delay(1);
+			continue;
+		}
+
+		for (index = 0; index < length; index ++)
+		{
+			if (ptr[index] != get_seq ++)
+				rb_bench_errors ++;
+		}
+		rt_spsc_ringbuffer_release(&spsc_rb, length);
+		rb_bench_bytes += length;
+	}
+
+	rt_timer_detach(&timer);
+
+	rt_kprintf("isr   : spsc   %8d bytes/s, %d errors\n",
+		rb_bench_bytes * RT_TICK_PER_SECOND / RB_BENCH_WINDOW, rb_bench_errors);
+	if (rb_bench_errors != 0)
+		tc_stat(TC_STAT_FAILED);
+}
+
+static rt_size_t rb_bench_put(const rt_uint8_t *ptr, rt_size_t length)
+{
+	rt_base_t level;
+
+	if (!use_locked)
+		return rt_spsc_ringbuffer_put(&spsc_rb, ptr, length);
+
+	level = rt_hw_interrupt_disable();
+	length = rt_ringbuffer_put(&locked_rb, ptr, length);
+	rt_hw_interrupt_enable(level);
+
+	return length;
+}
+
+static rt_size_t rb_bench_get(rt_uint8_t *ptr, rt_size_t length)
+{
+	rt_base_t level;
+
+	if (!use_locked)
+		return rt_spsc_ringbuffer_get(&spsc_rb, ptr, length);
+
+	level = rt_hw_interrupt_disable();
+	length = rt_ringbuffer_get(&locked_rb, ptr, length);
+	rt_hw_interrupt_enable(level);
+
+	return length;
+}
+
+static void rb_bench_producer_entry(void* parameter)
+{
+	rt_uint8_t buffer[RB_BENCH_CHUNK];
+	rt_size_t index, length, offset;
+
+	while (!rb_bench_stop)
+	{
+		for (index = 0; index < RB_BENCH_CHUNK; index ++)
+			buffer[index] = put_seq + index;
+
+		offset = 0;
+		while (offset < RB_BENCH_CHUNK && !rb_bench_stop)
+		{
+			length = rb_bench_put(&buffer[offset], RB_BENCH_CHUNK - offset);
+			if (length == 0)
+				rt_thread_yield();
+			offset += length;
+		}
+		put_seq += RB_BENCH_CHUNK;
+	}
+
+	rb_bench_done = 1;
+}
+
+static void rb_bench_thread(rt_uint8_t locked)
+{
+	rt_uint8_t buffer[RB_BENCH_CHUNK];
+	rt_size_t index, length;
+	rt_tick_t tick;
+	rt_thread_t producer;
+
+	use_locked = locked;
+	rt_spsc_ringbuffer_init(&spsc_rb, rb_pool, sizeof(rb_pool));
+	rt_ringbuffer_init(&locked_rb, rb_pool, sizeof(rb_pool));
+	put_seq = get_seq = 0;
+	rb_bench_bytes = rb_bench_errors = 0;
+	rb_bench_stop = rb_bench_done = 0;
+
+	/* the producer has the same priority as the consumer */
+	producer = rt_thread_create("rbprod", rb_bench_producer_entry, RT_NULL,
+		THREAD_STACK_SIZE, rt_thread_self()->current_priority, THREAD_TIMESLICE);
+	if (producer == RT_NULL)
+	{
+		tc_stat(TC_STAT_FAILED);
+		return;
+	}
+	rt_thread_startup(producer);
+
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < RB_BENCH_WINDOW)
+	{
+		length = rb_bench_get(buffer, RB_BENCH_CHUNK);
+		if (length == 0)
+		{
+			rt_thread_yield();
+			continue;
+		}
+
+		for (index = 0; index < length; index ++)
+		{
+			if (buffer[index] != get_seq ++)
+				rb_bench_errors ++;
+		}
+		rb_bench_bytes += length;
+	}
+
+	/* stop producer, which is deleted by idle thread after exit */
+	rb_bench_stop = 1;
+	while (!rb_bench_done)
+		rt_thread_delay(1);
+
+	rt_kprintf("thread: %s %8d bytes/s, %d errors\n",
+		locked ? "locked" : "spsc  ",
+		rb_bench_bytes * RT_TICK_PER_SECOND / RB_BENCH_WINDOW, rb_bench_errors);
+	if (rb_bench_errors != 0)
+		tc_stat(TC_STAT_FAILED);
+}
+
+void ringbuffer_bench(void)
+{
+	rb_bench_isr();
+	rb_bench_thread(0);
+	rb_bench_thread(1);
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(ringbuffer_bench, stress benchmark of spsc ring buffer);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_ringbuffer_bench()
+{
+	ringbuffer_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_ringbuffer_bench, a spsc ring buffer stress benchmark);
+#else
+int rt_application_init()
+{
+	ringbuffer_bench();
+
+	return 0;
+}
+#endif
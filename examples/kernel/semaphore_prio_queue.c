@@ -0,0 +1,148 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a test for the priority indexed suspend queue of IPC object.
+ *
+ * Some threads with different priority are pended on a semaphore which is
+ * created with RT_IPC_FLAG_PRIO_QUEUE flag, then a worker thread with lower
+ * priority releases the semaphore one by one. The threads shall get the
+ * semaphore from the highest priority, and in FIFO order for the same
+ * priority.
+ */
+
+#define WAITER_NUM	8
+
+static rt_sem_t sem;
+static rt_thread_t waiter[WAITER_NUM], worker;
+static rt_uint8_t order[WAITER_NUM];
+static rt_uint8_t order_index;
+static rt_uint8_t finished[WAITER_NUM];
+
+static rt_uint8_t waiter_priority(rt_uint8_t index)
+{
+	return THREAD_PRIORITY - 4 + (index * 3) % 4;
+}
+
+/* each waiter takes the semaphore once, records its order and exits */
+static void waiter_entry(void* parameter)
+{
+	rt_uint8_t index = (rt_uint8_t)(rt_uint32_t)parameter;
+
+	if (rt_sem_take(sem, RT_WAITING_FOREVER) != RT_EOK)
+	{
+		tc_done(TC_STAT_FAILED);
+		return;
+	}
+
+	if (order_index < WAITER_NUM)
+		order[order_index ++] = index;
+	finished[index] = 1;
+}
+
+static void worker_entry(void* parameter)
+{
+	rt_uint8_t index;
+
+	/* wait for all waiters pended on the semaphore */
+	rt_thread_delay(10);
+
+	for (index = 0; index < WAITER_NUM; index ++)
+		rt_sem_release(sem);
+
+	while (1)
+		rt_thread_delay(RT_TICK_PER_SECOND);
+}
+
+int semaphore_prio_queue_init()
+{
+	rt_uint8_t index;
+
+	sem = rt_sem_create("sem", 0, RT_IPC_FLAG_PRIO_QUEUE);
+	if (sem == RT_NULL)
+	{
+		tc_stat(TC_STAT_END | TC_STAT_FAILED);
+		return 0;
+	}
+
+	order_index = 0;
+	for (index = 0; index < WAITER_NUM; index ++)
+	{
+		finished[index] = 0;
+		waiter[index] = rt_thread_create("waiter",
+			waiter_entry, (void*)(rt_uint32_t)index,
+			THREAD_STACK_SIZE, waiter_priority(index), THREAD_TIMESLICE);
+		if (waiter[index] != RT_NULL)
+			rt_thread_startup(waiter[index]);
+		else
+			tc_stat(TC_STAT_END | TC_STAT_FAILED);
+	}
+
+	worker = rt_thread_create("worker",
+		worker_entry, RT_NULL,
+		THREAD_STACK_SIZE, THREAD_PRIORITY + 1, THREAD_TIMESLICE);
+	if (worker != RT_NULL)
+		rt_thread_startup(worker);
+	else
+		tc_stat(TC_STAT_END | TC_STAT_FAILED);
+
+	return 0;
+}
+
+#ifdef RT_USING_TC
+static void _tc_cleanup()
+{
+	rt_uint8_t index, result;
+
+	/* lock scheduler */
+	rt_enter_critical();
+
+	/* delete worker and the waiters which are not exited */
+	for (index = 0; index < WAITER_NUM; index ++)
+	{
+		if (!finished[index])
+			rt_thread_delete(waiter[index]);
+	}
+	rt_thread_delete(worker);
+
+	rt_sem_delete(sem);
+
+	/*
+	 * every waiter gets the semaphore once: in strict priority order, and in
+	 * pending (FIFO) order for the same priority, the waiters of the same
+	 * priority are pended in the order of index.
+	 */
+	result = TC_STAT_PASSED;
+	if (order_index != WAITER_NUM)
+		result = TC_STAT_FAILED;
+	for (index = 1; index < order_index; index ++)
+	{
+		if (waiter_priority(order[index - 1]) > waiter_priority(order[index]))
+			result = TC_STAT_FAILED;
+		else if (waiter_priority(order[index - 1]) == waiter_priority(order[index]) &&
+			order[index - 1] > order[index])
+			result = TC_STAT_FAILED;
+	}
+	tc_done(result);
+
+	/* unlock scheduler */
+	rt_exit_critical();
+}
+
+int _tc_semaphore_prio_queue()
+{
+	/* set tc cleanup */
+	tc_cleanup(_tc_cleanup);
+	semaphore_prio_queue_init();
+
+	return 20;
+}
+FINSH_FUNCTION_EXPORT(_tc_semaphore_prio_queue, a priority indexed queue semaphore test);
+#else
+int rt_application_init()
+{
+	semaphore_prio_queue_init();
+
+	return 0;
+}
+#endif
@@ -0,0 +1,139 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a test for releasing semaphore in batch.
+ *
+ * Some threads with higher priority are pended on a semaphore, and a worker
+ * thread with lower priority:
+ *  - releases WAITER_NUM units in a batch of rt_sem_release calls, no waiter
+ *    shall run before rt_ipc_batch_end;
+ *  - releases WAITER_NUM + EXTRA_NUM units by one rt_sem_release_n, all the
+ *    waiters shall run and the left units are kept in semaphore.
+ */
+
+#define WAITER_NUM	8
+#define EXTRA_NUM	2
+
+static rt_sem_t sem;
+static rt_thread_t waiter[WAITER_NUM], worker;
+static volatile rt_uint32_t wakeup_count;
+static rt_uint8_t result;
+
+static void waiter_entry(void* parameter)
+{
+	while (1)
+	{
+		if (rt_sem_take(sem, RT_WAITING_FOREVER) != RT_EOK)
+		{
+			result = TC_STAT_FAILED;
+			return;
+		}
+
+		wakeup_count ++;
+	}
+}
+
+static void worker_entry(void* parameter)
+{
+	rt_uint8_t index;
+
+	/* wait for all waiters pended on the semaphore */
+	rt_thread_delay(10);
+
+	rt_ipc_batch_begin();
+	for (index = 0; index < WAITER_NUM; index ++)
+		rt_sem_release(sem);
+	/* the waiters are not scheduled in the batch */
+	if (wakeup_count != 0)
+		result = TC_STAT_FAILED;
+	rt_ipc_batch_end();
+
+	if (wakeup_count != WAITER_NUM)
+		result = TC_STAT_FAILED;
+
+	rt_sem_release_n(sem, WAITER_NUM + EXTRA_NUM);
+
+	/* the waiters with higher priority take the semaphore at once */
+	if (wakeup_count != WAITER_NUM * 2 + EXTRA_NUM || sem->value != 0)
+		result = TC_STAT_FAILED;
+
+	while (1)
+		rt_thread_delay(RT_TICK_PER_SECOND);
+}
+
+int semaphore_release_n_init()
+{
+	rt_uint8_t index;
+
+	sem = rt_sem_create("sem", 0, RT_IPC_FLAG_FIFO);
+	if (sem == RT_NULL)
+	{
+		tc_stat(TC_STAT_END | TC_STAT_FAILED);
+		return 0;
+	}
+
+	wakeup_count = 0;
+	result = TC_STAT_PASSED;
+	for (index = 0; index < WAITER_NUM; index ++)
+	{
+		waiter[index] = rt_thread_create("waiter",
+			waiter_entry, RT_NULL,
+			THREAD_STACK_SIZE, THREAD_PRIORITY - 1, THREAD_TIMESLICE);
+		if (waiter[index] != RT_NULL)
+			rt_thread_startup(waiter[index]);
+		else
+			tc_stat(TC_STAT_END | TC_STAT_FAILED);
+	}
+
+	worker = rt_thread_create("worker",
+		worker_entry, RT_NULL,
+		THREAD_STACK_SIZE, THREAD_PRIORITY + 1, THREAD_TIMESLICE);
+	if (worker != RT_NULL)
+		rt_thread_startup(worker);
+	else
+		tc_stat(TC_STAT_END | TC_STAT_FAILED);
+
+	return 0;
+}
+
+#ifdef RT_USING_TC
+static void _tc_cleanup()
+{
+	rt_uint8_t index;
+
+	/* lock scheduler */
+	rt_enter_critical();
+
+	/* delete waiter and worker thread */
+	for (index = 0; index < WAITER_NUM; index ++)
+		rt_thread_delete(waiter[index]);
+	rt_thread_delete(worker);
+
+	rt_sem_delete(sem);
+
+	if (wakeup_count != WAITER_NUM * 2 + EXTRA_NUM)
+		result = TC_STAT_FAILED;
+	tc_done(result);
+
+	/* unlock scheduler */
+	rt_exit_critical();
+}
+
+int _tc_semaphore_release_n()
+{
+	/* set tc cleanup */
+	tc_cleanup(_tc_cleanup);
+	semaphore_release_n_init();
+
+	return 20;
+}
+FINSH_FUNCTION_EXPORT(_tc_semaphore_release_n, a batch semaphore release test);
+#else
+int rt_application_init()
+{
+	semaphore_release_n_init();
+
+	return 0;
+}
+#endif
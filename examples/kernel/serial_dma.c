@@ -0,0 +1,162 @@
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "tc_comm.h"
+
+#if defined(RT_USING_SERIAL) && defined(RT_USING_UART1)
+/*
+ * This is a test for the DMA receiving of serial framework, on the loopback
+ * port uart1 of simulator, whose DMA buffer is SERIAL_DMA_SIZE bytes and the
+ * ring is SERIAL_DMA_POOL_SIZE bytes:
+ *  - the frames are written back to back, some of them are larger than the
+ *    DMA buffer or cross the end of ring, and each read returns exactly one
+ *    frame;
+ *  - the data overrunning the ring is discarded, and the frames in ring are
+ *    kept intact.
+ */
+
+#define SERIAL_DMA_SIZE			64
+#define SERIAL_DMA_POOL_SIZE	1024
+#define SERIAL_DMA_FRAME_NUM	8
+#define SERIAL_DMA_FRAME_MAX	400
+
+static const rt_uint16_t frame_size[SERIAL_DMA_FRAME_NUM] =
+{
+	1, SERIAL_DMA_SIZE - 1, SERIAL_DMA_SIZE, SERIAL_DMA_SIZE + 1,
+	SERIAL_DMA_SIZE * 2 + 3, 200, 37, 5
+};
+
+static rt_uint8_t tx_buffer[SERIAL_DMA_FRAME_NUM][SERIAL_DMA_FRAME_MAX];
+static rt_uint8_t rx_buffer[SERIAL_DMA_FRAME_MAX * 2];
+
+static void frame_fill(rt_uint8_t *buffer, rt_uint8_t frame, rt_size_t size)
+{
+	rt_size_t index;
+
+	for (index = 0; index < size; index ++)
+		buffer[index] = (rt_uint8_t)(frame * 7 + index);
+}
+
+static rt_bool_t frame_check(rt_uint8_t *buffer, rt_uint8_t frame, rt_size_t size)
+{
+	rt_size_t index;
+
+	for (index = 0; index < size; index ++)
+	{
+		if (buffer[index] != (rt_uint8_t)(frame * 7 + index))
+			return RT_FALSE;
+	}
+
+	return RT_TRUE;
+}
+
+/* wait for the frames received on idle line */
+static rt_err_t frame_wait(struct serial_dma_rx *rx, rt_uint32_t frames)
+{
+	rt_uint32_t tick;
+
+	for (tick = 0; rx->frames < frames; tick ++)
+	{
+		if (tick > RT_TICK_PER_SECOND)
+			return -RT_ETIMEOUT;
+		rt_thread_delay(1);
+	}
+
+	return RT_EOK;
+}
+
+static void serial_dma_init()
+{
+	rt_device_t dev;
+	struct serial_dma_rx *rx;
+	rt_uint32_t round, index, frames, overrun;
+	rt_size_t size;
+
+	dev = rt_device_find("uart1");
+	if (dev == RT_NULL || !(dev->flag & RT_DEVICE_FLAG_DMA_RX) ||
+		rt_device_open(dev, RT_DEVICE_OFLAG_RDWR) != RT_EOK)
+	{
+		tc_done(TC_STAT_FAILED);
+		return;
+	}
+	rx = ((struct rt_serial_device *)dev)->dma_rx;
+	if (rx->pool_size != SERIAL_DMA_POOL_SIZE || rx->dma_size != SERIAL_DMA_SIZE)
+		goto _failed;
+
+	/* drop the data received before */
+	while (rt_device_read(dev, 0, rx_buffer, sizeof(rx_buffer)) != 0) ;
+
+	/* the frames are read one by one, more than one ring of data in total */
+	for (round = 0; round < 3; round ++)
+	{
+		frames = rx->frames;
+		for (index = 0; index < SERIAL_DMA_FRAME_NUM; index ++)
+		{
+			frame_fill(tx_buffer[index], round + index, frame_size[index]);
+			if (rt_device_write(dev, 0, tx_buffer[index], frame_size[index]) != frame_size[index])
+				goto _failed;
+		}
+		if (frame_wait(rx, frames + SERIAL_DMA_FRAME_NUM) != RT_EOK)
+			goto _failed;
+
+		for (index = 0; index < SERIAL_DMA_FRAME_NUM; index ++)
+		{
+			if (rt_device_read(dev, 0, rx_buffer, sizeof(rx_buffer)) != frame_size[index] ||
+				!frame_check(rx_buffer, round + index, frame_size[index]))
+				goto _failed;
+		}
+		if (rt_device_read(dev, 0, rx_buffer, sizeof(rx_buffer)) != 0)
+			goto _failed;
+	}
+
+	/* the last frame overruns the ring, only the head of it is received */
+	frames = rx->frames;
+	overrun = rx->overrun;
+	for (index = 0; index < 5; index ++)
+	{
+		size = index < 4 ? 200 : SERIAL_DMA_FRAME_MAX;
+		frame_fill(tx_buffer[index], index, size);
+		if (rt_device_write(dev, 0, tx_buffer[index], size) != size)
+			goto _failed;
+	}
+	if (frame_wait(rx, frames + 5) != RT_EOK ||
+		rx->overrun - overrun != 200 * 4 + SERIAL_DMA_FRAME_MAX - SERIAL_DMA_POOL_SIZE)
+		goto _failed;
+	for (index = 0; index < 4; index ++)
+	{
+		if (rt_device_read(dev, 0, rx_buffer, sizeof(rx_buffer)) != 200 ||
+			!frame_check(rx_buffer, index, 200))
+			goto _failed;
+	}
+	if (rt_device_read(dev, 0, rx_buffer, sizeof(rx_buffer)) != SERIAL_DMA_POOL_SIZE - 200 * 4 ||
+		!frame_check(rx_buffer, 4, SERIAL_DMA_POOL_SIZE - 200 * 4))
+		goto _failed;
+	if (rt_device_read(dev, 0, rx_buffer, sizeof(rx_buffer)) != 0)
+		goto _failed;
+
+	tc_done(TC_STAT_PASSED);
+	goto _exit;
+
+_failed:
+	tc_done(TC_STAT_FAILED);
+
+_exit:
+	rt_device_close(dev);
+}
+
+#ifdef RT_USING_TC
+int _tc_serial_dma()
+{
+	serial_dma_init();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_serial_dma, a serial DMA receiving test on uart1 loopback);
+#else
+int rt_application_init()
+{
+	serial_dma_init();
+
+	return 0;
+}
+#endif
+#endif
@@ -0,0 +1,225 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+#ifdef RT_USING_SPI_QUEUE
+#include <drivers/spi.h>
+
+/*
+ * This is a test for the SPI bus message queue.
+ *
+ * SPI_QUEUE_DEV_NUM devices are attached to a mock bus, which counts the bus
+ * configurations and completes the transfers at once. The requests are
+ * submitted while the test holds the bus lock, so they are all pending when
+ * the queue thread starts to transfer:
+ *  - the interleaved requests of devices are batched by device, in submitted
+ *    order of each device, and the bus is configured once for each device;
+ *  - a pending request could be cancelled and it completes with -RT_EINTR;
+ *  - the requests of bus owner are taken ahead of an older request of other
+ *    device at most RT_SPI_QUEUE_BATCH times in a row.
+ */
+
+#define SPI_QUEUE_DEV_NUM	3
+#define SPI_QUEUE_REQ_NUM	(RT_SPI_QUEUE_BATCH + 3)
+#define SPI_QUEUE_MSG_SIZE	8
+
+static struct rt_spi_bus mock_bus;
+static struct rt_spi_device mock_dev[SPI_QUEUE_DEV_NUM];
+static rt_uint32_t mock_configs;
+
+static struct rt_spi_request req[SPI_QUEUE_REQ_NUM];
+static struct rt_spi_message msg[SPI_QUEUE_REQ_NUM];
+static rt_uint8_t msg_buffer[SPI_QUEUE_MSG_SIZE];
+static struct rt_semaphore done_sem;
+static rt_uint8_t done_order[SPI_QUEUE_REQ_NUM];
+static rt_uint8_t done_count;
+
+static rt_err_t mock_configure(struct rt_spi_device *device,
+	struct rt_spi_configuration *configuration)
+{
+	mock_configs ++;
+
+	return RT_EOK;
+}
+
+static rt_uint32_t mock_xfer(struct rt_spi_device *device, struct rt_spi_message *message)
+{
+	return message->length;
+}
+
+static const struct rt_spi_ops mock_ops =
+{
+	mock_configure,
+	mock_xfer
+};
+
+static void request_done(struct rt_spi_request *r)
+{
+	done_order[done_count ++] = (rt_uint8_t)(r - &req[0]);
+	rt_sem_release(&done_sem);
+}
+
+static rt_err_t request_submit(rt_uint8_t index, rt_uint8_t device)
+{
+	msg[index].send_buf   = msg_buffer;
+	msg[index].recv_buf   = RT_NULL;
+	msg[index].length     = SPI_QUEUE_MSG_SIZE;
+	msg[index].next       = RT_NULL;
+	msg[index].cs_take    = 1;
+	msg[index].cs_release = 1;
+	rt_spi_request_init(&req[index], &msg[index], request_done, RT_NULL);
+
+	return rt_spi_submit(&mock_dev[device], &req[index]);
+}
+
+static rt_err_t request_wait(rt_uint8_t count)
+{
+	while (count --)
+	{
+		if (rt_sem_take(&done_sem, RT_TICK_PER_SECOND) != RT_EOK)
+			return -RT_ETIMEOUT;
+	}
+
+	return RT_EOK;
+}
+
+static rt_uint8_t request_device(rt_uint8_t index)
+{
+	return (rt_uint8_t)(req[index].device - &mock_dev[0]);
+}
+
+static void spi_queue_init()
+{
+	char name[RT_NAME_MAX];
+	rt_uint32_t index, configs, batched;
+	rt_int32_t last[SPI_QUEUE_DEV_NUM];
+	rt_uint8_t device;
+
+	/* the queue thread of bus could not be stopped, the bus is kept */
+	if (rt_device_find("spimock") == RT_NULL)
+	{
+		if (rt_spi_bus_register(&mock_bus, "spimock", &mock_ops) != RT_EOK)
+		{
+			tc_done(TC_STAT_FAILED);
+			return;
+		}
+		for (index = 0; index < SPI_QUEUE_DEV_NUM; index ++)
+		{
+			rt_snprintf(name, sizeof(name), "spim%d", index);
+			if (rt_spi_bus_attach_device(&mock_dev[index], name, "spimock", RT_NULL) != RT_EOK)
+			{
+				tc_done(TC_STAT_FAILED);
+				return;
+			}
+		}
+	}
+	rt_sem_init(&done_sem, "done", 0, RT_IPC_FLAG_FIFO);
+
+	/* submit the interleaved requests of devices while holding the bus */
+	rt_mutex_take(&(mock_bus.lock), RT_WAITING_FOREVER);
+	mock_bus.owner = RT_NULL;
+	mock_configs = 0;
+	batched = mock_bus.queue.batched;
+	configs = mock_bus.queue.reconfigs;
+
+	done_count = 0;
+	for (index = 0; index < SPI_QUEUE_DEV_NUM * 4; index ++)
+	{
+		if (request_submit(index, index % SPI_QUEUE_DEV_NUM) != RT_EOK)
+			goto _failed;
+	}
+	/* a pending request could not be submitted again */
+	if (rt_spi_submit(&mock_dev[0], &req[0]) != -RT_EBUSY)
+		goto _failed;
+	/* cancel a pending request of the last device */
+	if (rt_spi_cancel(&req[SPI_QUEUE_DEV_NUM + 2]) != RT_EOK ||
+		done_count != 1 || req[SPI_QUEUE_DEV_NUM + 2].error != -RT_EINTR)
+		goto _failed;
+	if (rt_spi_cancel(&req[SPI_QUEUE_DEV_NUM + 2]) != -RT_ERROR)
+		goto _failed;
+	rt_mutex_release(&(mock_bus.lock));
+
+	if (request_wait(SPI_QUEUE_DEV_NUM * 4) != RT_EOK)
+		goto _failed;
+
+	/* batched by device, in submitted order of each device */
+	for (device = 0; device < SPI_QUEUE_DEV_NUM; device ++)
+		last[device] = -1;
+	device = request_device(done_order[1]);
+	for (index = 1; index < done_count; index ++)
+	{
+		if (req[done_order[index]].error != RT_EOK)
+			goto _failed;
+		if (request_device(done_order[index]) != device)
+		{
+			/* the last device is done */
+			if (last[request_device(done_order[index])] != -1)
+				goto _failed;
+			device = request_device(done_order[index]);
+		}
+		if ((rt_int32_t)done_order[index] <= last[device])
+			goto _failed;
+		last[device] = done_order[index];
+	}
+	/* the bus is configured once for each device */
+	if (mock_configs != SPI_QUEUE_DEV_NUM ||
+		mock_bus.queue.reconfigs - configs != SPI_QUEUE_DEV_NUM ||
+		mock_bus.queue.batched - batched != SPI_QUEUE_DEV_NUM * 4 - 1 - SPI_QUEUE_DEV_NUM)
+		goto _failed;
+
+	/*
+	 * an older request of the first device is taken after RT_SPI_QUEUE_BATCH
+	 * requests of bus owner
+	 */
+	rt_mutex_take(&(mock_bus.lock), RT_WAITING_FOREVER);
+	device = request_device(done_order[done_count - 1]);
+	done_count = 0;
+	if (request_submit(0, (device + 1) % SPI_QUEUE_DEV_NUM) != RT_EOK)
+		goto _failed;
+	for (index = 1; index < SPI_QUEUE_REQ_NUM; index ++)
+	{
+		if (request_submit(index, device) != RT_EOK)
+			goto _failed;
+	}
+	rt_mutex_release(&(mock_bus.lock));
+
+	if (request_wait(SPI_QUEUE_REQ_NUM) != RT_EOK)
+		goto _failed;
+	for (index = 0; index < SPI_QUEUE_REQ_NUM; index ++)
+	{
+		if (index < RT_SPI_QUEUE_BATCH && done_order[index] != index + 1)
+			goto _failed;
+		if (index == RT_SPI_QUEUE_BATCH && done_order[index] != 0)
+			goto _failed;
+		if (index > RT_SPI_QUEUE_BATCH && done_order[index] != index)
+			goto _failed;
+	}
+
+	tc_done(TC_STAT_PASSED);
+	goto _exit;
+
+_failed:
+	if (mock_bus.lock.owner == rt_thread_self())
+		rt_mutex_release(&(mock_bus.lock));
+	tc_done(TC_STAT_FAILED);
+
+_exit:
+	rt_sem_detach(&done_sem);
+}
+
+#ifdef RT_USING_TC
+int _tc_spi_queue()
+{
+	spi_queue_init();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_spi_queue, a SPI bus message queue test);
+#else
+int rt_application_init()
+{
+	spi_queue_init();
+
+	return 0;
+}
+#endif
+#endif
@@ -0,0 +1,114 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a test for the stack sampler.
+ *
+ * A thread uses STACK_DEPTH bytes of its stack in a deep call, then the
+ * idle thread shall find the high-water mark of its stack, which is
+ * checked without finishing the scan by rt_thread_stack_used.
+ */
+
+#define STACK_DEPTH		512
+
+static rt_thread_t tid = RT_NULL;
+static volatile rt_uint8_t done;
+static rt_uint8_t result;
+
+static rt_uint32_t stack_use(rt_uint32_t depth)
+{
+	volatile rt_uint8_t buffer[64];
+	rt_uint32_t index;
+
+	for (index = 0; index < sizeof(buffer); index ++)
+		buffer[index] = (rt_uint8_t)index;
+
+	if (depth <= sizeof(buffer))
+		return buffer[1];
+
+	return stack_use(depth - sizeof(buffer)) + buffer[1];
+}
+
+static void thread_entry(void* parameter)
+{
+	stack_use(STACK_DEPTH);
+	done = 1;
+
+	while (1)
+		rt_thread_delay(RT_TICK_PER_SECOND);
+}
+
+static void thread_stack_sample_init()
+{
+	rt_size_t used;
+	rt_tick_t tick;
+
+	done = 0;
+	result = TC_STAT_PASSED;
+	tid = rt_thread_create("t1",
+		thread_entry, RT_NULL,
+		THREAD_STACK_SIZE + STACK_DEPTH * 2, THREAD_PRIORITY, THREAD_TIMESLICE);
+	if (tid == RT_NULL)
+	{
+		tc_stat(TC_STAT_END | TC_STAT_FAILED);
+		return;
+	}
+	rt_thread_startup(tid);
+
+	while (!done)
+		rt_thread_delay(1);
+
+	/* the idle thread scans the stack in background */
+	tick = rt_tick_get();
+	while (1)
+	{
+		used = (rt_uint8_t *)tid->stack_addr + tid->stack_size -
+			(rt_uint8_t *)tid->stack_mark;
+		if (used >= STACK_DEPTH)
+			break;
+
+		if (rt_tick_get() - tick > RT_TICK_PER_SECOND)
+		{
+			result = TC_STAT_FAILED;
+			return;
+		}
+		rt_thread_delay(1);
+	}
+
+	/* the high-water mark is within the stack */
+	if (rt_thread_stack_used(tid) >= tid->stack_size)
+		result = TC_STAT_FAILED;
+}
+
+#ifdef RT_USING_TC
+static void _tc_cleanup()
+{
+	/* lock scheduler */
+	rt_enter_critical();
+
+	if (tid != RT_NULL && tid->stat != RT_THREAD_CLOSE)
+		rt_thread_delete(tid);
+
+	/* unlock scheduler */
+	rt_exit_critical();
+
+	tc_done(result);
+}
+
+int _tc_thread_stack_sample()
+{
+	/* set tc cleanup */
+	tc_cleanup(_tc_cleanup);
+	thread_stack_sample_init();
+
+	return 10;
+}
+FINSH_FUNCTION_EXPORT(_tc_thread_stack_sample, a stack sampler test);
+#else
+int rt_application_init()
+{
+	thread_stack_sample_init();
+
+	return 0;
+}
+#endif
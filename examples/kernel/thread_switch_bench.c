@@ -0,0 +1,106 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a benchmark for the thread switch.
+ *
+ * Two threads with the same priority yield to each other, and the number of
+ * thread switches done in one second is counted. With RT_USING_SCHED_STAT,
+ * it's counted once with the scheduler statistics stopped and once with them
+ * collected, the overhead shall be less than SWITCH_BENCH_OVERHEAD percent.
+ */
+
+#define SWITCH_BENCH_WINDOW	RT_TICK_PER_SECOND
+#define SWITCH_BENCH_OVERHEAD	2
+
+static volatile rt_uint8_t switch_bench_stop, switch_bench_done;
+static rt_uint32_t switch_bench_count;
+
+static void switch_bench_entry(void* parameter)
+{
+	while (!switch_bench_stop)
+	{
+		switch_bench_count ++;
+		rt_thread_yield();
+	}
+
+	switch_bench_done = 1;
+}
+
+static rt_uint32_t thread_switch_run(void)
+{
+	rt_thread_t peer;
+	rt_tick_t tick;
+	rt_uint32_t count;
+
+	switch_bench_count = 0;
+	switch_bench_stop = switch_bench_done = 0;
+
+	/* the peer has the same priority as the benchmark thread */
+	peer = rt_thread_create("swpeer", switch_bench_entry, RT_NULL,
+		THREAD_STACK_SIZE, rt_thread_self()->current_priority, THREAD_TIMESLICE);
+	if (peer == RT_NULL)
+	{
+		tc_stat(TC_STAT_FAILED);
+		return 0;
+	}
+	rt_thread_startup(peer);
+
+	count = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < SWITCH_BENCH_WINDOW)
+	{
+		count ++;
+		rt_thread_yield();
+	}
+
+	/* stop peer, which is deleted by idle thread after exit */
+	switch_bench_stop = 1;
+	while (!switch_bench_done)
+		rt_thread_delay(1);
+
+	return (count + switch_bench_count) * RT_TICK_PER_SECOND / SWITCH_BENCH_WINDOW;
+}
+
+void thread_switch_bench(void)
+{
+#ifdef RT_USING_SCHED_STAT
+	rt_uint32_t off, on, overhead;
+
+	rt_scheduler_stat_enable(RT_FALSE);
+	off = thread_switch_run();
+	rt_scheduler_stat_enable(RT_TRUE);
+	on = thread_switch_run();
+
+	/* the overhead in 0.1 percent */
+	overhead = (on < off && off != 0) ? (off - on) * 1000 / off : 0;
+
+	rt_kprintf("scheduler statistics off: %8d switches/s\n", off);
+	rt_kprintf("scheduler statistics on : %8d switches/s\n", on);
+	rt_kprintf("overhead: %d.%d%%\n", overhead / 10, overhead % 10);
+	if (overhead >= SWITCH_BENCH_OVERHEAD * 10)
+		tc_stat(TC_STAT_FAILED);
+#else
+	rt_kprintf("thread switch: %8d switches/s\n", thread_switch_run());
+#endif
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(thread_switch_bench, benchmark of thread switch);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_thread_switch_bench()
+{
+	thread_switch_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_thread_switch_bench, a thread switch benchmark);
+#else
+int rt_application_init()
+{
+	thread_switch_bench();
+
+	return 0;
+}
+#endif
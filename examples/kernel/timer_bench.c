@@ -0,0 +1,142 @@
+#include <rtthread.h>
+#include "tc_comm.h"
+
+/*
+ * This is a benchmark for the timer list and timer wheel backend.
+ *
+ * With 10/100/1000 armed timers, it counts:
+ *  - start/stop: the number of rt_timer_start/rt_timer_stop pairs done in one
+ *    second;
+ *  - check: the number of loops the benchmark thread does in one second while
+ *    all the timers are periodic and expire in the tick interrupt, the more
+ *    loops the less time is spent in rt_timer_check.
+ *
+ * Run it once with RT_USING_TIMER_WHEEL defined and once without it to
+ * compare both backends.
+ */
+
+#define TIMER_BENCH_WINDOW	RT_TICK_PER_SECOND
+
+static rt_uint32_t timer_bench_seed;
+
+static rt_uint32_t timer_bench_rand(void)
+{
+	timer_bench_seed = timer_bench_seed * 1103515245 + 12345;
+
+	return (timer_bench_seed >> 16) & 0x7fff;
+}
+
+static void timer_bench_timeout(void* parameter)
+{
+}
+
+static rt_uint32_t timer_bench_loops(void)
+{
+	rt_tick_t tick;
+	rt_uint32_t loops;
+
+	/* align to the tick boundary */
+	tick = rt_tick_get();
+	while (rt_tick_get() == tick);
+
+	loops = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < TIMER_BENCH_WINDOW)
+		loops ++;
+
+	return loops;
+}
+
+static void timer_bench_run(rt_uint32_t count)
+{
+	rt_uint32_t index, loops, pairs;
+	rt_tick_t tick;
+	struct rt_timer *timers;
+	struct rt_timer probe;
+
+	timers = (struct rt_timer*)rt_malloc(sizeof(struct rt_timer) * count);
+	if (timers == RT_NULL)
+	{
+		rt_kprintf("timer bench: no memory for %d timers\n", count);
+		tc_stat(TC_STAT_FAILED);
+		return;
+	}
+
+	/* arm the timers which will not expire during the benchmark */
+	timer_bench_seed = count;
+	for (index = 0; index < count; index ++)
+	{
+		rt_timer_init(&timers[index], "bench", timer_bench_timeout, RT_NULL,
+			RT_TICK_PER_SECOND * 60 + timer_bench_rand(),
+			RT_TIMER_FLAG_ONE_SHOT);
+		rt_timer_start(&timers[index]);
+	}
+
+	/* the probe timer is started at a random position among the armed timers */
+	rt_timer_init(&probe, "probe", timer_bench_timeout, RT_NULL,
+		RT_TICK_PER_SECOND * 60, RT_TIMER_FLAG_ONE_SHOT);
+
+	pairs = 0;
+	tick = rt_tick_get();
+	while (rt_tick_get() - tick < TIMER_BENCH_WINDOW)
+	{
+		probe.init_tick = RT_TICK_PER_SECOND * 60 + timer_bench_rand();
+
+		rt_timer_start(&probe);
+		rt_timer_stop(&probe);
+		pairs ++;
+	}
+	rt_timer_detach(&probe);
+
+	/* make all timers periodic and expire in the tick interrupt */
+	for (index = 0; index < count; index ++)
+	{
+		rt_timer_stop(&timers[index]);
+		timers[index].init_tick = 1 + index % 8;
+		timers[index].parent.flag |= RT_TIMER_FLAG_PERIODIC;
+		rt_timer_start(&timers[index]);
+	}
+
+	loops = timer_bench_loops();
+
+	for (index = 0; index < count; index ++)
+		rt_timer_detach(&timers[index]);
+	rt_free(timers);
+
+	rt_kprintf("%4d timers: start/stop %8d pairs/s, check %10d loops/s\n",
+		count, pairs, loops);
+}
+
+void timer_bench(void)
+{
+#ifdef RT_USING_TIMER_WHEEL
+	rt_kprintf("timer backend: wheel\n");
+#else
+	rt_kprintf("timer backend: list\n");
+#endif
+	rt_kprintf("   0 timers: idle %10d loops/s\n", timer_bench_loops());
+
+	timer_bench_run(10);
+	timer_bench_run(100);
+	timer_bench_run(1000);
+}
+#ifdef RT_USING_FINSH
+FINSH_FUNCTION_EXPORT(timer_bench, benchmark of the timer backend);
+#endif
+
+#ifdef RT_USING_TC
+int _tc_timer_bench()
+{
+	timer_bench();
+
+	return 0;
+}
+FINSH_FUNCTION_EXPORT(_tc_timer_bench, a timer backend benchmark);
+#else
+int rt_application_init()
+{
+	timer_bench();
+
+	return 0;
+}
+#endif
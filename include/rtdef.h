@@ -96,6 +96,7 @@ typedef rt_base_t                       rt_off_t;       /**< Type for offset */
     #define USED                        __attribute__((used))
     #define ALIGN(n)                    __attribute__((aligned(n)))
     #define rt_inline                   static __inline
+    #define RT_RETURN_ADDRESS()         ((void *)__return_address())
     /* module compiling */
     #ifdef RT_USING_MODULE
         #define RTT_API                 __declspec(dllimport)
@@ -111,6 +112,7 @@ typedef rt_base_t                       rt_off_t;       /**< Type for offset */
     #define PRAGMA(x)                   _Pragma(#x)
     #define ALIGN(n)                    PRAGMA(data_alignment=n)
     #define rt_inline                   static inline
+    #define RT_RETURN_ADDRESS()         ((void *)0)
     #define RTT_API
 
 #elif defined (__GNUC__)                /* GNU GCC Compiler */
@@ -143,6 +145,7 @@ typedef rt_base_t                       rt_off_t;       /**< Type for offset */
     #define USED                        __attribute__((used))
     #define ALIGN(n)                    __attribute__((aligned(n)))
     #define rt_inline                   static __inline
+    #define RT_RETURN_ADDRESS()         __builtin_return_address(0)
     #define RTT_API
 #elif defined (__ADSPBLACKFIN__)        /* for VisualDSP++ Compiler */
     #include <stdarg.h>
@@ -151,6 +154,7 @@ typedef rt_base_t                       rt_off_t;       /**< Type for offset */
     #define USED                        __attribute__((used))
     #define ALIGN(n)                    __attribute__((aligned(n)))
     #define rt_inline                   static inline
+    #define RT_RETURN_ADDRESS()         __builtin_return_address(0)
     #define RTT_API
 #elif defined (_MSC_VER)
     #include <stdarg.h>
@@ -159,6 +163,7 @@ typedef rt_base_t                       rt_off_t;       /**< Type for offset */
     #define USED
     #define ALIGN(n)                    __declspec(align(n))
     #define rt_inline                   static __inline
+    #define RT_RETURN_ADDRESS()         ((void *)0)
     #define RTT_API
 #elif defined (__TI_COMPILER_VERSION__)
     #include <stdarg.h>
@@ -170,6 +175,7 @@ typedef rt_base_t                       rt_off_t;       /**< Type for offset */
     #define USED
     #define ALIGN(n)
     #define rt_inline                   static inline
+    #define RT_RETURN_ADDRESS()         ((void *)0)
     #define RTT_API
 #else
     #error not supported tool chain
@@ -233,6 +239,7 @@ typedef int (*init_fn_t)(void);
 #define RT_ENOSYS                       6               /**< No system */
 #define RT_EBUSY                        7               /**< Busy */
 #define RT_EIO                          8               /**< IO error */
+#define RT_EINTR                        9               /**< Interrupted system call */
 
 /*@}*/
 
@@ -293,6 +300,9 @@ struct rt_object
     void      *module_id;                               /**< id of application module */
 #endif
     rt_list_t  list;                                    /**< list node of kernel object */
+#ifdef RT_USING_OBJECT_HASH
+    rt_list_t  hash_list;                               /**< list node of name hash index */
+#endif
 };
 typedef struct rt_object *rt_object_t;                  /**< Type for kernel objects. */
 
@@ -439,6 +449,43 @@ typedef struct rt_timer *rt_timer_t;
 #define RT_THREAD_CTRL_CHANGE_PRIORITY  0x02                /**< Change thread priority. */
 #define RT_THREAD_CTRL_INFO             0x03                /**< Get thread information. */
 
+#ifdef RT_USING_SCHED_STAT
+/**
+ * Scheduler statistics of thread, the time is counted by rt_hw_stat_clock
+ */
+struct rt_sched_stat
+{
+    rt_uint32_t switch_count;                           /**< numbers of switches to the thread */
+    rt_uint32_t preempt_count;                          /**< numbers of switches away while ready */
+    rt_uint32_t run_time;                               /**< total run time */
+    rt_uint32_t max_latency;                            /**< max time from ready to run */
+
+    rt_uint32_t ready_stamp;                            /**< the time when it became ready */
+    rt_uint32_t run_stamp;                              /**< the time when it was switched to */
+    rt_uint8_t  irq_locked;                             /**< switched away with interrupt disabled */
+};
+
+#ifndef RT_SCHED_STAT_IRQ_SITES
+#define RT_SCHED_STAT_IRQ_SITES         64              /**< number of call sites of interrupt lock, power of 2 */
+#endif
+#ifndef RT_SCHED_STAT_IRQ_MIN
+#define RT_SCHED_STAT_IRQ_MIN           64              /**< shortest interrupt lock accounted, in rt_hw_stat_clock */
+#endif
+
+/**
+ * Interrupt disabled time of a call site of rt_hw_interrupt_disable
+ */
+struct rt_irq_stat
+{
+    const char *function;                               /**< function of the call site */
+    rt_uint32_t line;                                   /**< line of the call site */
+
+    rt_uint32_t count;                                  /**< numbers of interrupt disabled for RT_SCHED_STAT_IRQ_MIN or longer */
+    rt_uint32_t total_time;                             /**< total interrupt disabled time */
+    rt_uint32_t max_time;                               /**< max interrupt disabled time */
+};
+#endif
+
 /**
  * Thread structure
  */
@@ -491,6 +538,15 @@ struct rt_thread
     void (*cleanup)(struct rt_thread *tid);             /**< cleanup function when thread exit */
 
     rt_uint32_t user_data;                              /**< private user data beyond this thread */
+
+#ifdef RT_USING_SCHED_STAT
+    struct rt_sched_stat sched_stat;                    /**< scheduler statistics */
+#endif
+
+#ifdef RT_USING_STACK_SAMPLER
+    rt_ubase_t *stack_scan;                             /**< next stack word scanned by sampler */
+    rt_ubase_t *stack_mark;                             /**< deepest used stack word found by sampler */
+#endif
 };
 typedef struct rt_thread *rt_thread_t;
 
@@ -507,6 +563,7 @@ typedef struct rt_thread *rt_thread_t;
  */
 #define RT_IPC_FLAG_FIFO                0x00            /**< FIFOed IPC. @ref IPC. */
 #define RT_IPC_FLAG_PRIO                0x01            /**< PRIOed IPC. @ref IPC. */
+#define RT_IPC_FLAG_PRIO_QUEUE          0x02            /**< PRIOed IPC with priority indexed queue. @ref IPC. */
 
 #define RT_IPC_CMD_UNKNOWN              0x00            /**< unknown IPC command */
 #define RT_IPC_CMD_RESET                0x01            /**< reset IPC object */
@@ -514,6 +571,19 @@ typedef struct rt_thread *rt_thread_t;
 #define RT_WAITING_FOREVER              -1              /**< Block forever until get resource. */
 #define RT_WAITING_NO                   0               /**< Non-block. */
 
+/**
+ * Priority indexed queue of suspended threads
+ */
+struct rt_ipc_prio_queue
+{
+    rt_uint32_t      group;                             /**< priority group of suspended threads */
+#if RT_THREAD_PRIORITY_MAX > 32
+    rt_uint8_t       table[32];                         /**< priority table of suspended threads */
+#endif
+
+    rt_list_t        thread[RT_THREAD_PRIORITY_MAX];    /**< suspended threads of each priority */
+};
+
 /**
  * Base structure of IPC object
  */
@@ -522,6 +592,9 @@ struct rt_ipc_object
     struct rt_object parent;                            /**< inherit from rt_object */
 
     rt_list_t        suspend_thread;                    /**< threads pended on this resource */
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    struct rt_ipc_prio_queue *prio_queue;               /**< priority indexed queue of pended threads */
+#endif
 };
 
 #ifdef RT_USING_SEMAPHORE
@@ -592,6 +665,9 @@ struct rt_mailbox
     rt_uint16_t          out_offset;                    /**< output offset of the message buffer */
 
     rt_list_t            suspend_sender_thread;         /**< sender thread suspended on this mailbox */
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    struct rt_ipc_prio_queue *sender_prio_queue;        /**< priority indexed queue of sender thread */
+#endif
 };
 typedef struct rt_mailbox *rt_mailbox_t;
 #endif
@@ -631,6 +707,51 @@ typedef struct rt_messagequeue *rt_mq_t;
  * heap & partition
  */
 
+/**
+ * placement classes of heap memory, for rt_malloc_ex
+ */
+#define RT_MEM_FAST                     0x01            /**< fast memory, such as TCM or internal SRAM */
+#define RT_MEM_DMA                      0x02            /**< memory accessible by DMA */
+#define RT_MEM_BULK                     0x04            /**< bulk memory, such as external SDRAM */
+#define RT_MEM_CLASS_MAX                4               /**< the number of classes, including the default */
+
+#ifdef RT_USING_MEM_PROFILER
+#define RT_MEM_PROFILE_MAGIC            0x464f5250      /**< "PROF" in little endian */
+#define RT_MEM_PROFILE_VERSION          1
+#define RT_MEM_PROFILE_HISTOGRAM        8               /**< 16, 32, ... 1024 and larger bytes */
+
+/**
+ * header of the binary dump of heap allocation profiler, which is followed by
+ * site_count records of struct rt_mem_profile_site
+ */
+struct rt_mem_profile_header
+{
+    rt_uint32_t magic;                                  /**< RT_MEM_PROFILE_MAGIC */
+    rt_uint16_t version;                                /**< RT_MEM_PROFILE_VERSION */
+    rt_uint16_t site_size;                              /**< size of one site record */
+    rt_uint32_t site_count;                             /**< number of site records */
+    rt_uint32_t dropped;                                /**< allocations without site record */
+    rt_uint32_t untracked;                              /**< allocations not tracked until freed */
+};
+
+/**
+ * allocation call site of heap allocation profiler, keyed by caller and thread
+ */
+struct rt_mem_profile_site
+{
+    void       *caller;                                 /**< return address of allocation */
+    void       *thread;                                 /**< thread which allocates */
+    char        name[RT_NAME_MAX];                      /**< name of the thread */
+
+    rt_uint32_t alloc_count;                            /**< number of allocations */
+    rt_uint32_t free_count;                             /**< number of releases */
+    rt_uint32_t live_bytes;                             /**< bytes allocated and not released */
+    rt_uint32_t peak_bytes;                             /**< maximum of live bytes */
+
+    rt_uint32_t histogram[RT_MEM_PROFILE_HISTOGRAM];    /**< allocations by size */
+};
+#endif
+
 #ifdef RT_USING_MEMHEAP
 /**
  * memory item on the heap
@@ -647,6 +768,12 @@ struct rt_memheap_item
     struct rt_memheap_item *prev_free;                  /**< prev free memheap item */
 };
 
+/**
+ * the number of free block size classes of memory heap, the class n holds
+ * the free blocks in [2^(n + 4), 2^(n + 5)) bytes, class 0 holds the smaller
+ */
+#define RT_MEMHEAP_BIN_MAX              28
+
 /**
  * Base structure of memory heap object
  */
@@ -662,10 +789,56 @@ struct rt_memheap
 
     struct rt_memheap_item *block_list;                 /**< used block list */
 
-    struct rt_memheap_item *free_list;                  /**< free block list */
-    struct rt_memheap_item  free_header;                /**< free block list header */
+    rt_uint32_t             free_bitmap;                /**< bitmap of non-empty free bins */
+    struct rt_memheap_item *free_bin[RT_MEMHEAP_BIN_MAX]; /**< free block lists by size class */
 
     struct rt_semaphore     lock;                       /**< semaphore lock */
+
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+    rt_uint8_t              placement;                  /**< placement classes served by heap */
+    rt_uint8_t              preference;                 /**< preference order, 0 is tried first */
+    struct rt_memheap      *next_heap;                  /**< next heap in preference order */
+
+    rt_uint32_t             served[RT_MEM_CLASS_MAX];   /**< allocations served for each class */
+#endif
+};
+#endif
+
+#ifdef RT_USING_HANDLE_HEAP
+struct rt_hheap;
+
+/**
+ * handle of a movable memory block
+ */
+struct rt_hheap_handle
+{
+    void                   *ptr;                        /**< block data, or next free handle */
+    struct rt_hheap        *heap;                       /**< handle heap of the block */
+    rt_uint16_t             lock;                       /**< lock count, a locked block is not moved */
+};
+typedef struct rt_hheap_handle *rt_handle_t;
+
+/**
+ * Base structure of handle heap, whose blocks are moved to compact the heap
+ */
+struct rt_hheap
+{
+    char                    name[RT_NAME_MAX];          /**< name of handle heap */
+    rt_list_t               list;                       /**< node of handle heap list */
+
+    rt_uint8_t             *start;                      /**< first block */
+    rt_uint8_t             *top;                        /**< end of the last block */
+    rt_uint8_t             *end;                        /**< end of heap */
+    rt_uint8_t             *hole;                       /**< no movable hole below it */
+    rt_size_t               available;                  /**< free size in holes and above top */
+
+    struct rt_hheap_handle *handle_table;               /**< handle table */
+    rt_size_t               handle_count;               /**< numbers of handle */
+    struct rt_hheap_handle *free_handle;                /**< free handle list */
+
+    rt_uint32_t             moved;                      /**< bytes moved by compaction */
+
+    struct rt_mutex         lock;                       /**< mutex lock */
 };
 #endif
 
@@ -681,7 +854,12 @@ struct rt_mempool
     rt_size_t        size;                              /**< size of memory pool */
 
     rt_size_t        block_size;                        /**< size of memory blocks */
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+    rt_ubase_t       free_stack;                        /**< tag and index of the first free block */
+    rt_ubase_t       free_index_mask;                   /**< mask of block index in free_stack */
+#else
     rt_uint8_t      *block_list;                        /**< memory blocks list */
+#endif
 
     rt_size_t        block_total_count;                 /**< numbers of memory block */
     rt_size_t        block_free_count;                  /**< numbers of free memory block */
@@ -690,6 +868,23 @@ struct rt_mempool
     rt_size_t        suspend_thread_count;              /**< numbers of thread pended on this resource */
 };
 typedef struct rt_mempool *rt_mp_t;
+
+#ifdef RT_USING_OBJECT_CACHE
+/**
+ * Object cache of kernel object class
+ */
+struct rt_object_cache
+{
+    struct rt_mempool pool;                             /**< memory pool of cached objects */
+    rt_uint8_t        ready;                            /**< memory pool is ready */
+
+    rt_size_t         reserve;                          /**< numbers of objects in warm reserve */
+    rt_size_t         peak;                             /**< max numbers of objects used in cache */
+
+    rt_uint32_t       hit;                              /**< numbers of objects allocated from cache */
+    rt_uint32_t       miss;                             /**< numbers of objects allocated from heap */
+};
+#endif
 #endif
 
 /*@}*/
@@ -739,6 +934,7 @@ enum rt_device_class_type
 #define RT_DEVICE_FLAG_ACTIVATED        0x010           /**< device is activated */
 #define RT_DEVICE_FLAG_SUSPENDED        0x020           /**< device is suspended */
 #define RT_DEVICE_FLAG_STREAM           0x040           /**< stream mode */
+#define RT_DEVICE_FLAG_ASYNC            0x080           /**< asynchronous request supported */
 
 #define RT_DEVICE_FLAG_INT_RX           0x100           /**< INT mode on Rx */
 #define RT_DEVICE_FLAG_DMA_RX           0x200           /**< DMA mode on Rx */
@@ -772,6 +968,40 @@ enum rt_device_class_type
 #define RT_DEVICE_CTRL_RTC_SET_ALARM    0x13            /**< set alarm */
 
 typedef struct rt_device *rt_device_t;
+
+#ifdef RT_USING_DEVICE_ASYNC
+/**
+ * device request types and status
+ */
+#define RT_DEVICE_REQ_READ              0x00            /**< read request */
+#define RT_DEVICE_REQ_WRITE             0x01            /**< write request */
+
+#define RT_DEVICE_REQ_IDLE              0x00            /**< request is not submitted or completed */
+#define RT_DEVICE_REQ_PENDING           0x01            /**< request is in flight */
+
+/**
+ * Asynchronous request descriptor of device
+ */
+struct rt_device_request
+{
+    rt_list_t                 list;                     /**< node in request queue of driver */
+
+    rt_uint8_t                type;                     /**< read or write */
+    rt_uint8_t                status;                   /**< request status */
+
+    rt_off_t                  pos;                      /**< position of transfer */
+    void                     *buffer;                   /**< data buffer */
+    rt_size_t                 size;                     /**< size of transfer */
+
+    rt_size_t                 result;                   /**< actually transferred size */
+    rt_err_t                  error;                    /**< error code of request */
+
+    /* completion call back, may be invoked in interrupt context */
+    void (*done)(rt_device_t dev, struct rt_device_request *req);
+
+    void                     *user_data;                /**< user private data */
+};
+#endif
 /**
  * Device structure
  */
@@ -798,6 +1028,12 @@ struct rt_device
     rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
     rt_err_t  (*control)(rt_device_t dev, rt_uint8_t cmd, void *args);
 
+#ifdef RT_USING_DEVICE_ASYNC
+    /* asynchronous request interface, used with RT_DEVICE_FLAG_ASYNC */
+    rt_err_t  (*submit) (rt_device_t dev, struct rt_device_request *req);
+    rt_err_t  (*cancel) (rt_device_t dev, struct rt_device_request *req);
+#endif
+
     void                     *user_data;                /**< device private data */
 };
 
@@ -81,6 +81,26 @@ rt_isr_handler_t rt_hw_interrupt_install(int              vector,
 rt_base_t rt_hw_interrupt_disable(void);
 void rt_hw_interrupt_enable(rt_base_t level);
 
+#ifdef RT_USING_SCHED_STAT
+/*
+ * rt_hw_stat_clock returns a free running counter of high resolution, such as
+ * a cycle counter, which is used by the scheduler statistics. It shall be
+ * implemented by the port to use RT_USING_SCHED_STAT.
+ */
+rt_uint32_t rt_hw_stat_clock(void);
+
+/*
+ * The interrupt lock is accounted for each call site. The port which
+ * implements rt_hw_interrupt_disable and rt_hw_interrupt_enable in C shall
+ * undefine these macros before the implementation.
+ */
+rt_base_t rt_interrupt_stat_disable(const char *function, rt_uint32_t line);
+void rt_interrupt_stat_enable(rt_base_t level);
+
+#define rt_hw_interrupt_disable()       rt_interrupt_stat_disable(__FUNCTION__, __LINE__)
+#define rt_hw_interrupt_enable(level)   rt_interrupt_stat_enable(level)
+#endif
+
 /*
  * Context interfaces
  */
@@ -93,6 +113,28 @@ void rt_hw_console_output(const char *str);
 void rt_hw_backtrace(rt_uint32_t *fp, rt_uint32_t thread_entry);
 void rt_hw_show_memory(rt_uint32_t addr, rt_uint32_t size);
 
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+/*
+ * rt_hw_atomic_cas stores value to *ptr only if *ptr equals to old, in one
+ * atomic operation, and returns RT_TRUE if it's stored. It's used by the
+ * lock-free memory pool.
+ */
+rt_bool_t rt_hw_atomic_cas(volatile rt_ubase_t *ptr, rt_ubase_t old, rt_ubase_t value);
+#endif
+
+#ifdef RT_USING_TICKLESS
+/*
+ * Tickless interfaces
+ *
+ * rt_hw_tick_suspend stops the periodic tick and raises the next tick
+ * interrupt after the specified ticks. rt_hw_tick_resume restores the
+ * periodic tick and returns the ticks passed since the suspension, so the
+ * wakeup tick interrupt shall check timer instead of increasing tick.
+ */
+void rt_hw_tick_suspend(rt_tick_t tick);
+rt_tick_t rt_hw_tick_resume(void);
+#endif
+
 /*
  * Exception interfaces
  */
@@ -62,6 +62,11 @@ void rt_object_delete(rt_object_t object);
 rt_bool_t rt_object_is_systemobject(rt_object_t object);
 rt_object_t rt_object_find(const char *name, rt_uint8_t type);
 
+#ifdef RT_USING_OBJECT_CACHE
+rt_err_t rt_object_cache_setup(enum rt_object_class_type type, rt_size_t reserve);
+struct rt_object_cache *rt_object_cache_get(enum rt_object_class_type type);
+#endif
+
 #ifdef RT_USING_HOOK
 void rt_object_attach_sethook(void (*hook)(struct rt_object *object));
 void rt_object_detach_sethook(void (*hook)(struct rt_object *object));
@@ -86,6 +91,10 @@ rt_tick_t rt_tick_get(void);
 void rt_tick_set(rt_tick_t tick);
 void rt_tick_increase(void);
 rt_tick_t rt_tick_from_millisecond(rt_uint32_t ms);
+#ifdef RT_USING_TICKLESS
+void rt_tick_suspend(void);
+void rt_tick_resume(void);
+#endif
 
 void rt_system_timer_init(void);
 void rt_system_timer_thread_init(void);
@@ -178,6 +187,19 @@ void rt_exit_critical(void);
 void rt_scheduler_sethook(void (*hook)(rt_thread_t from, rt_thread_t to));
 #endif
 
+#ifdef RT_USING_STACK_SAMPLER
+rt_bool_t rt_thread_stack_scan(rt_thread_t thread, rt_size_t count);
+rt_size_t rt_thread_stack_used(rt_thread_t thread);
+#endif
+
+#ifdef RT_USING_SCHED_STAT
+void rt_thread_sched_stat(rt_thread_t thread, struct rt_sched_stat *stat);
+rt_uint32_t rt_scheduler_lock_time(void);
+void rt_scheduler_stat_reset(void);
+void rt_scheduler_stat_enable(rt_bool_t enable);
+rt_uint32_t rt_interrupt_stat_get(struct rt_irq_stat *stat, rt_uint32_t size);
+#endif
+
 /*@}*/
 
 /**
@@ -241,6 +263,27 @@ void rt_malloc_sethook(void (*hook)(void *ptr, rt_uint32_t size));
 void rt_free_sethook(void (*hook)(void *ptr));
 #endif
 
+#ifdef RT_USING_MEM_PROFILER
+/*
+ * heap allocation profiler interface, the heap backends record allocations
+ * with the return address of caller
+ */
+void rt_mem_profile_alloc(void *ptr, rt_size_t size, void *caller);
+void rt_mem_profile_free(void *ptr);
+void rt_mem_profile_reset(void);
+rt_size_t rt_mem_profile_dump(rt_size_t (*write)(const void *buffer,
+                                                 rt_size_t   size,
+                                                 void       *parameter),
+                              void *parameter);
+
+#define RT_MEM_PROFILE_ALLOC(ptr, size) \
+    rt_mem_profile_alloc((ptr), (size), RT_RETURN_ADDRESS())
+#define RT_MEM_PROFILE_FREE(ptr)        rt_mem_profile_free(ptr)
+#else
+#define RT_MEM_PROFILE_ALLOC(ptr, size)
+#define RT_MEM_PROFILE_FREE(ptr)
+#endif
+
 #endif
 
 #ifdef RT_USING_MEMHEAP
@@ -255,6 +298,41 @@ rt_err_t rt_memheap_detach(struct rt_memheap *heap);
 void* rt_memheap_alloc(struct rt_memheap *heap, rt_uint32_t size);
 void *rt_memheap_realloc(struct rt_memheap* heap, void* ptr, rt_size_t newsize);
 void rt_memheap_free(void *ptr);
+
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+rt_err_t rt_memheap_set_placement(struct rt_memheap *heap,
+                                  rt_uint8_t         placement,
+                                  rt_uint8_t         preference);
+#endif
+#endif
+
+#ifdef RT_USING_HANDLE_HEAP
+/**
+ * handle heap interface
+ */
+rt_err_t rt_hheap_init(struct rt_hheap *heap,
+                       const char      *name,
+                       void            *start_addr,
+                       rt_size_t        size,
+                       rt_size_t        handle_count);
+rt_err_t rt_hheap_detach(struct rt_hheap *heap);
+rt_handle_t rt_hheap_alloc(struct rt_hheap *heap, rt_size_t size);
+rt_err_t rt_hheap_realloc(rt_handle_t handle, rt_size_t newsize);
+void rt_hheap_free(rt_handle_t handle);
+void *rt_hheap_lock(rt_handle_t handle);
+void rt_hheap_unlock(rt_handle_t handle);
+rt_size_t rt_hheap_size(rt_handle_t handle);
+rt_err_t rt_hheap_compact(struct rt_hheap *heap);
+void rt_hheap_idle_compact(void);
+#endif
+
+#ifdef RT_USING_HEAP
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+void *rt_malloc_ex(rt_size_t size, rt_uint32_t flags);
+#else
+/* there is only one heap, the placement classes are ignored */
+#define rt_malloc_ex(size, flags)   rt_malloc(size)
+#endif
 #endif
 
 /*@}*/
@@ -265,6 +343,12 @@ void rt_memheap_free(void *ptr);
 
 /*@{*/
 
+/*
+ * batch of IPC release interface
+ */
+void rt_ipc_batch_begin(void);
+void rt_ipc_batch_end(void);
+
 #ifdef RT_USING_SEMAPHORE
 /*
  * semaphore interface
@@ -280,6 +364,7 @@ rt_err_t rt_sem_delete(rt_sem_t sem);
 rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time);
 rt_err_t rt_sem_trytake(rt_sem_t sem);
 rt_err_t rt_sem_release(rt_sem_t sem);
+rt_err_t rt_sem_release_n(rt_sem_t sem, rt_uint16_t count);
 rt_err_t rt_sem_control(rt_sem_t sem, rt_uint8_t cmd, void *arg);
 #endif
 
@@ -359,6 +444,10 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
                     void      *buffer,
                     rt_size_t  size,
                     rt_int32_t timeout);
+rt_err_t rt_mq_reserve(rt_mq_t mq, void **buffer);
+rt_err_t rt_mq_commit(rt_mq_t mq, void *buffer);
+rt_err_t rt_mq_recv_loan(rt_mq_t mq, void **buffer, rt_int32_t timeout);
+rt_err_t rt_mq_release(rt_mq_t mq, void *buffer);
 rt_err_t rt_mq_control(rt_mq_t mq, rt_uint8_t cmd, void *arg);
 #endif
 
@@ -402,6 +491,22 @@ rt_size_t rt_device_write(rt_device_t dev,
                           rt_size_t   size);
 rt_err_t  rt_device_control(rt_device_t dev, rt_uint8_t cmd, void *arg);
 
+#ifdef RT_USING_DEVICE_ASYNC
+void rt_device_request_init(struct rt_device_request *req,
+                            rt_uint8_t                type,
+                            rt_off_t                  pos,
+                            void                     *buffer,
+                            rt_size_t                 size,
+                            void (*done)(rt_device_t dev, struct rt_device_request *req),
+                            void                     *user_data);
+rt_err_t rt_device_submit(rt_device_t dev, struct rt_device_request *req);
+rt_err_t rt_device_cancel(rt_device_t dev, struct rt_device_request *req);
+void rt_device_request_done(rt_device_t               dev,
+                            struct rt_device_request *req,
+                            rt_size_t                 result,
+                            rt_err_t                  error);
+#endif
+
 /*@}*/
 #endif
 
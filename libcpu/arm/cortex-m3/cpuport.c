@@ -392,3 +392,52 @@ int __rt_ffs(int value)
 #endif
 
 #endif
+
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+/**
+ * This function stores value to *ptr only if *ptr equals to old, by the
+ * exclusive load and store instructions.
+ *
+ * @return RT_TRUE if the value is stored, otherwise RT_FALSE
+ */
+#if defined(__CC_ARM)
+__asm rt_bool_t rt_hw_atomic_cas(volatile rt_ubase_t *ptr, rt_ubase_t old, rt_ubase_t value)
+{
+retry
+    LDREX   r3, [r0]
+    CMP     r3, r1
+    BNE     fail
+    STREX   r3, r2, [r0]
+    CMP     r3, #0x00
+    BNE     retry
+    MOVS    r0, #0x01
+    BX      lr
+
+fail
+    CLREX
+    MOVS    r0, #0x00
+    BX      lr
+}
+#elif defined(__IAR_SYSTEMS_ICC__)
+#include <intrinsics.h>
+rt_bool_t rt_hw_atomic_cas(volatile rt_ubase_t *ptr, rt_ubase_t old, rt_ubase_t value)
+{
+    do
+    {
+        if (__LDREX((unsigned long *)ptr) != old)
+        {
+            __CLREX();
+
+            return RT_FALSE;
+        }
+    } while (__STREX(value, (unsigned long *)ptr) != 0);
+
+    return RT_TRUE;
+}
+#elif defined(__GNUC__)
+rt_bool_t rt_hw_atomic_cas(volatile rt_ubase_t *ptr, rt_ubase_t old, rt_ubase_t value)
+{
+    return __sync_bool_compare_and_swap(ptr, old, value);
+}
+#endif
+#endif
@@ -0,0 +1,173 @@
+/*
+ * File      : cpu_mem.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
+
+#include <rtthread.h>
+
+#ifdef RT_USING_CPU_MEMOPS
+#ifndef __SSE2__
+#error "RT_USING_CPU_MEMOPS needs a host with SSE2"
+#endif
+
+#include <emmintrin.h>
+
+/* one SSE2 register */
+#define SSE_BLOCK       16
+#define SSE_UNALIGNED(X) ((rt_ubase_t)(X) & (SSE_BLOCK - 1))
+
+/**
+ * This function will set the content of memory to specified value with
+ * SSE2 stores.
+ *
+ * @param s the address of source memory
+ * @param c the value shall be set in content
+ * @param count the copied length
+ *
+ * @return the address of source memory
+ */
+void *rt_memset(void *s, int c, rt_ubase_t count)
+{
+    unsigned char *m = (unsigned char *)s;
+    __m128i value;
+
+    if (count >= SSE_BLOCK * 2)
+    {
+        /* set the unaligned head bytewise */
+        while (SSE_UNALIGNED(m))
+        {
+            *m++ = (unsigned char)c;
+            count --;
+        }
+
+        value = _mm_set1_epi8((char)c);
+        while (count >= SSE_BLOCK * 4)
+        {
+            _mm_store_si128((__m128i *)m, value);
+            _mm_store_si128((__m128i *)(m + SSE_BLOCK), value);
+            _mm_store_si128((__m128i *)(m + SSE_BLOCK * 2), value);
+            _mm_store_si128((__m128i *)(m + SSE_BLOCK * 3), value);
+            m += SSE_BLOCK * 4;
+            count -= SSE_BLOCK * 4;
+        }
+
+        while (count >= SSE_BLOCK)
+        {
+            _mm_store_si128((__m128i *)m, value);
+            m += SSE_BLOCK;
+            count -= SSE_BLOCK;
+        }
+    }
+
+    while (count--)
+        *m++ = (unsigned char)c;
+
+    return s;
+}
+RTM_EXPORT(rt_memset);
+
+/**
+ * This function will copy memory content from source address to destination
+ * address with SSE2 loads and stores.
+ *
+ * @param dst the address of destination memory
+ * @param src  the address of source memory
+ * @param count the copied length
+ *
+ * @return the address of destination memory
+ */
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+    unsigned char *dst_ptr = (unsigned char *)dst;
+    const unsigned char *src_ptr = (const unsigned char *)src;
+    __m128i r0, r1, r2, r3;
+
+    if (count >= SSE_BLOCK * 2)
+    {
+        /* align the destination, the source is loaded unaligned */
+        while (SSE_UNALIGNED(dst_ptr))
+        {
+            *dst_ptr++ = *src_ptr++;
+            count --;
+        }
+
+        while (count >= SSE_BLOCK * 4)
+        {
+            r0 = _mm_loadu_si128((const __m128i *)src_ptr);
+            r1 = _mm_loadu_si128((const __m128i *)(src_ptr + SSE_BLOCK));
+            r2 = _mm_loadu_si128((const __m128i *)(src_ptr + SSE_BLOCK * 2));
+            r3 = _mm_loadu_si128((const __m128i *)(src_ptr + SSE_BLOCK * 3));
+            _mm_store_si128((__m128i *)dst_ptr, r0);
+            _mm_store_si128((__m128i *)(dst_ptr + SSE_BLOCK), r1);
+            _mm_store_si128((__m128i *)(dst_ptr + SSE_BLOCK * 2), r2);
+            _mm_store_si128((__m128i *)(dst_ptr + SSE_BLOCK * 3), r3);
+            src_ptr += SSE_BLOCK * 4;
+            dst_ptr += SSE_BLOCK * 4;
+            count -= SSE_BLOCK * 4;
+        }
+
+        while (count >= SSE_BLOCK)
+        {
+            r0 = _mm_loadu_si128((const __m128i *)src_ptr);
+            _mm_store_si128((__m128i *)dst_ptr, r0);
+            src_ptr += SSE_BLOCK;
+            dst_ptr += SSE_BLOCK;
+            count -= SSE_BLOCK;
+        }
+    }
+
+    while (count--)
+        *dst_ptr++ = *src_ptr++;
+
+    return dst;
+}
+RTM_EXPORT(rt_memcpy);
+
+/**
+ * This function will compare two areas of memory with SSE2 compares.
+ *
+ * @param cs one area of memory
+ * @param ct another area of memory
+ * @param count the size of the area
+ *
+ * @return the result
+ */
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_ubase_t count)
+{
+    const unsigned char *su1 = (const unsigned char *)cs;
+    const unsigned char *su2 = (const unsigned char *)ct;
+    unsigned int mask;
+    int index;
+
+    while (count >= SSE_BLOCK)
+    {
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+                   _mm_loadu_si128((const __m128i *)su1),
+                   _mm_loadu_si128((const __m128i *)su2)));
+        if (mask != 0xffff)
+        {
+            /* the first different byte */
+            index = __builtin_ctz(~mask);
+
+            return su1[index] - su2[index];
+        }
+
+        su1 += SSE_BLOCK;
+        su2 += SSE_BLOCK;
+        count -= SSE_BLOCK;
+    }
+
+    for (; 0 < count; ++su1, ++su2, count--)
+        if (*su1 != *su2)
+            return *su1 - *su2;
+
+    return 0;
+}
+RTM_EXPORT(rt_memcmp);
+
+#endif
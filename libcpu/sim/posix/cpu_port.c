@@ -60,9 +60,75 @@ static int (* cpu_isr_table[MAX_INTERRUPT_NUM])(void) = {0};
 
 static pthread_t mainthread_pid;
 
+#ifdef RT_USING_TICKLESS
+/* tick period in micro second */
+#define TICK_PERIOD_US    (1000000 / RT_TICK_PER_SECOND - 1)
+
+/* the time of the last tick */
+static struct timeval tick_time;
+/* the periodic tick is suspended */
+static volatile int tick_suspended;
+#endif
+
 /* function definition */
-static void start_sys_timer(void);
+static void start_sys_timer(long us);
 static int tick_interrupt_isr(void);
+#ifdef RT_USING_TICKLESS
+static long tick_elapsed_us(void)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (now.tv_sec - tick_time.tv_sec) * 1000000L +
+           (now.tv_usec - tick_time.tv_usec);
+}
+
+/*
+ * Suspend the periodic tick, the next tick interrupt is raised after the
+ * specified ticks since the last tick.
+ */
+void rt_hw_tick_suspend(rt_tick_t tick)
+{
+    long us;
+
+    /* wake up once a minute at least, idle thread will suspend it again */
+    if (tick > RT_TICK_PER_SECOND * 60)
+        tick = RT_TICK_PER_SECOND * 60;
+
+    us = (long)tick * TICK_PERIOD_US - tick_elapsed_us();
+
+    tick_suspended = 1;
+    start_sys_timer(us > 0 ? us : 1);
+}
+
+/*
+ * Resume the periodic tick aligned with the tick before suspension, and
+ * return the ticks passed.
+ */
+rt_tick_t rt_hw_tick_resume(void)
+{
+    long us, tick;
+
+    tick_suspended = 0;
+
+    us = tick_elapsed_us();
+    tick = us / TICK_PERIOD_US;
+
+    /* move the last tick time and raise next tick at the tick boundary */
+    tick_time.tv_sec  += (tick * TICK_PERIOD_US) / 1000000L;
+    tick_time.tv_usec += (tick * TICK_PERIOD_US) % 1000000L;
+    if (tick_time.tv_usec >= 1000000L)
+    {
+        tick_time.tv_sec  += 1;
+        tick_time.tv_usec -= 1000000L;
+    }
+    start_sys_timer(TICK_PERIOD_US - (us - tick * TICK_PERIOD_US));
+
+    return tick;
+}
+#endif
+
 static void mthread_signal_tick(int sig);
 static int mainthread_scheduler(void);
 
@@ -363,6 +429,18 @@ void rt_hw_interrupt_enable(rt_base_t level)
     /*TODO: It may need to unmask the signal */
 }
 
+#ifdef RT_USING_SCHED_STAT
+/* the clock of scheduler statistics in microsecond */
+rt_uint32_t rt_hw_stat_clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (rt_uint32_t)(now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+#endif
+
 void rt_hw_context_switch_interrupt(rt_uint32_t from,
                                     rt_uint32_t to)
 {
@@ -457,7 +535,10 @@ static int mainthread_scheduler(void)
     pthread_mutex_init(ptr_int_mutex, &mutexattr);
 
     /* start timer */
-    start_sys_timer();
+#ifdef RT_USING_TICKLESS
+    gettimeofday(&tick_time, NULL);
+#endif
+    start_sys_timer(0);
 
     thread_to = (thread_t *) rt_interrupt_to_thread;
     thread_resume(thread_to);
@@ -496,16 +577,19 @@ static int mainthread_scheduler(void)
 
 /*
  * Setup the systick timer to generate the tick interrupts at the required
- * frequency.
+ * frequency, the first tick interrupt is raised after us micro seconds. If
+ * us is 0, the first tick is raised after one tick period.
  */
-static void start_sys_timer(void)
+static void start_sys_timer(long us)
 {
     struct itimerval itimer, oitimer;
-    int us;
+    int period;
 
     RT_ASSERT(RT_TICK_PER_SECOND <= 1000000 || RT_TICK_PER_SECOND >= 1);
 
-    us = 1000000 / RT_TICK_PER_SECOND - 1;
+    period = 1000000 / RT_TICK_PER_SECOND - 1;
+    if (us <= 0)
+        us = period;
 
     TRACE("start system tick!\n");
     /* Initialise the structure with the current timer information. */
@@ -517,10 +601,10 @@ static void start_sys_timer(void)
 
     /* Set the interval between timer events. */
     itimer.it_interval.tv_sec = 0;
-    itimer.it_interval.tv_usec = us;
+    itimer.it_interval.tv_usec = period;
     /* Set the current count-down. */
-    itimer.it_value.tv_sec = 0;
-    itimer.it_value.tv_usec = us;
+    itimer.it_value.tv_sec = us / 1000000;
+    itimer.it_value.tv_usec = us % 1000000;
 
     /* Set-up the timer interrupt. */
     if (0 != setitimer(TIMER_TYPE, &itimer, &oitimer))
@@ -551,11 +635,31 @@ static void mthread_signal_tick(int sig)
 /* isr return value: 1, should not be masked, if 0, can be masked */
 static int tick_interrupt_isr(void)
 {
+#ifdef RT_USING_TICKLESS
+    int wakeup;
+
+    /* the tick interrupt is the wakeup from tickless idle */
+    wakeup = tick_suspended;
+#endif
+
     TRACE("isr: systick enter!\n");
     /* enter interrupt */
     rt_interrupt_enter();
 
+#ifdef RT_USING_TICKLESS
+    if (wakeup)
+    {
+        /* the ticks are caught up in rt_interrupt_enter */
+        rt_timer_check();
+    }
+    else
+    {
+        gettimeofday(&tick_time, NULL);
+        rt_tick_increase();
+    }
+#else
     rt_tick_increase();
+#endif
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -564,3 +668,9 @@ static int tick_interrupt_isr(void)
     return 0;
 }
 
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+rt_bool_t rt_hw_atomic_cas(volatile rt_ubase_t *ptr, rt_ubase_t old, rt_ubase_t value)
+{
+    return __sync_bool_compare_and_swap(ptr, old, value);
+}
+#endif
@@ -230,6 +230,29 @@ void rt_hw_interrupt_enable(rt_base_t level)
 
 } /*** rt_hw_interrupt_enable ***/
 
+#ifdef RT_USING_SCHED_STAT
+/*
+*********************************************************************************************************
+*                                            rt_hw_stat_clock()
+* Description : the clock of scheduler statistics
+* Argument(s) : void
+* Return(s)   : rt_uint32_t, the time in microsecond
+* Caller(s)   : os_kernel
+* Note(s)     : none
+*********************************************************************************************************
+*/
+rt_uint32_t rt_hw_stat_clock(void)
+{
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return (rt_uint32_t)(counter.QuadPart / frequency.QuadPart * 1000000 +
+                         counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+} /*** rt_hw_stat_clock ***/
+#endif
+
 /*
 *********************************************************************************************************
 *                                            rt_hw_context_switch_interrupt()
@@ -677,3 +700,10 @@ rt_uint32_t YieldInterruptHandle(void)
 
     return 0;
 } /*** YieldInterruptHandle ***/
+
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+rt_bool_t rt_hw_atomic_cas(volatile rt_ubase_t *ptr, rt_ubase_t old, rt_ubase_t value)
+{
+    return InterlockedCompareExchange((volatile LONG *)ptr, (LONG)value, (LONG)old) == (LONG)old;
+}
+#endif
@@ -33,6 +33,15 @@
 
 static rt_tick_t rt_tick = 0;
 
+#ifdef RT_USING_TICKLESS
+#ifndef RT_TICKLESS_THRESHOLD
+#define RT_TICKLESS_THRESHOLD   2
+#endif
+
+/* the periodic tick is suspended by idle thread */
+static volatile rt_uint8_t rt_tick_suspended = 0;
+#endif
+
 extern void rt_timer_check(void);
 
 /**
@@ -104,6 +113,66 @@ void rt_tick_increase(void)
     rt_timer_check();
 }
 
+#ifdef RT_USING_TICKLESS
+/**
+ * This function will suspend the periodic tick until the next timer timeout,
+ * if there is no timer timeout in RT_TICKLESS_THRESHOLD ticks. It's invoked
+ * by idle thread.
+ */
+void rt_tick_suspend(void)
+{
+    rt_base_t level;
+    rt_tick_t timeout_tick, tick;
+
+    if (rt_tick_suspended)
+        return;
+
+    level = rt_hw_interrupt_disable();
+
+    timeout_tick = rt_timer_next_timeout_tick();
+    if (timeout_tick == RT_TICK_MAX)
+        tick = RT_TICK_MAX / 2;
+    else
+        tick = timeout_tick - rt_tick;
+
+    /* the timeout tick may be passed already */
+    if (!rt_tick_suspended &&
+        tick >= RT_TICKLESS_THRESHOLD && tick <= RT_TICK_MAX / 2)
+    {
+        rt_hw_tick_suspend(tick);
+        rt_tick_suspended = 1;
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * This function will resume the periodic tick and catch up the ticks passed
+ * during the suspension. It's invoked when an interrupt comes or a thread is
+ * scheduled.
+ *
+ * @note the timers timeout during the suspension are checked by the tick
+ * interrupt.
+ */
+void rt_tick_resume(void)
+{
+    rt_base_t level;
+
+    if (!rt_tick_suspended)
+        return;
+
+    level = rt_hw_interrupt_disable();
+
+    if (rt_tick_suspended)
+    {
+        rt_tick += rt_hw_tick_resume();
+        rt_tick_suspended = 0;
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+#endif
+
 /**
  * This function will calculate the tick from millisecond.
  *
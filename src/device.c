@@ -28,6 +28,7 @@
  */
 
 #include <rtthread.h>
+#include <rthw.h>
 
 #ifdef RT_USING_DEVICE
 
@@ -131,15 +132,31 @@ rt_err_t rt_device_init_all(void)
 rt_device_t rt_device_find(const char *name)
 {
     struct rt_object *object;
+#ifndef RT_USING_OBJECT_HASH
     struct rt_list_node *node;
     struct rt_object_information *information;
+#endif
 
+#ifdef RT_USING_OBJECT_HASH
+    extern rt_object_t rt_object_hash_find(const char *name, rt_uint8_t type);
+#else
     extern struct rt_object_information rt_object_container[];
+#endif
 
     /* enter critical */
     if (rt_thread_self() != RT_NULL)
         rt_enter_critical();
 
+#ifdef RT_USING_OBJECT_HASH
+    /* try to find device object in name hash index */
+    object = rt_object_hash_find(name, RT_Object_Class_Device);
+
+    /* leave critical */
+    if (rt_thread_self() != RT_NULL)
+        rt_exit_critical();
+
+    return (rt_device_t)object;
+#else
     /* try to find device object */
     information = &rt_object_container[RT_Object_Class_Device];
     for (node  = information->object_list.next;
@@ -163,6 +180,7 @@ rt_device_t rt_device_find(const char *name)
 
     /* not found */
     return RT_NULL;
+#endif
 }
 RTM_EXPORT(rt_device_find);
 
@@ -434,4 +452,176 @@ rt_device_set_tx_complete(rt_device_t dev,
 }
 RTM_EXPORT(rt_device_set_tx_complete);
 
+#ifdef RT_USING_DEVICE_ASYNC
+/**
+ * This function will initialize an asynchronous request of device.
+ *
+ * @param req the pointer of request descriptor
+ * @param type the request type, RT_DEVICE_REQ_READ or RT_DEVICE_REQ_WRITE
+ * @param pos the position of transfer
+ * @param buffer the data buffer
+ * @param size the size of transfer
+ * @param done the completion callback function, it may be invoked in interrupt
+ *             context
+ * @param user_data the user private data of request
+ */
+void rt_device_request_init(struct rt_device_request *req,
+                            rt_uint8_t                type,
+                            rt_off_t                  pos,
+                            void                     *buffer,
+                            rt_size_t                 size,
+                            void (*done)(rt_device_t dev, struct rt_device_request *req),
+                            void                     *user_data)
+{
+    RT_ASSERT(req != RT_NULL);
+
+    rt_list_init(&(req->list));
+    req->type      = type;
+    req->status    = RT_DEVICE_REQ_IDLE;
+    req->pos       = pos;
+    req->buffer    = buffer;
+    req->size      = size;
+    req->result    = 0;
+    req->error     = RT_EOK;
+    req->done      = done;
+    req->user_data = user_data;
+}
+RTM_EXPORT(rt_device_request_init);
+
+/**
+ * This function will submit an asynchronous request to a device. The request
+ * descriptor and its buffer shall be kept until the request is completed.
+ *
+ * If the device does not support asynchronous request (RT_DEVICE_FLAG_ASYNC),
+ * the request is performed by the read/write interface of device, and the
+ * completion callback is invoked before this function returns. A short
+ * transfer completes with the errno set by device, or -RT_EIO.
+ *
+ * @param dev the pointer of device driver structure
+ * @param req the pointer of request descriptor
+ *
+ * @return RT_EOK if the request is submitted, otherwise the error code and the
+ *         completion callback will not be invoked.
+ */
+rt_err_t rt_device_submit(rt_device_t dev, struct rt_device_request *req)
+{
+    rt_err_t result;
+    rt_size_t size;
+
+    RT_ASSERT(dev != RT_NULL);
+    RT_ASSERT(req != RT_NULL);
+
+    if (dev->ref_count == 0)
+        return -RT_ERROR;
+
+    if (req->status != RT_DEVICE_REQ_IDLE)
+        return -RT_EBUSY;
+
+    req->result = 0;
+    req->error  = RT_EOK;
+    req->status = RT_DEVICE_REQ_PENDING;
+
+    /* the driver queues the request and completes it later */
+    if ((dev->flag & RT_DEVICE_FLAG_ASYNC) && dev->submit != RT_NULL)
+    {
+        result = dev->submit(dev, req);
+        if (result != RT_EOK)
+            req->status = RT_DEVICE_REQ_IDLE;
+
+        return result;
+    }
+
+    /* synchronous fallback */
+    rt_set_errno(RT_EOK);
+    if (req->type == RT_DEVICE_REQ_READ && dev->read != RT_NULL)
+        size = dev->read(dev, req->pos, req->buffer, req->size);
+    else if (req->type == RT_DEVICE_REQ_WRITE && dev->write != RT_NULL)
+        size = dev->write(dev, req->pos, req->buffer, req->size);
+    else
+    {
+        req->status = RT_DEVICE_REQ_IDLE;
+
+        return -RT_ENOSYS;
+    }
+
+    if (size != req->size)
+    {
+        /* short transfer */
+        result = rt_get_errno();
+        if (result == RT_EOK)
+            result = -RT_EIO;
+    }
+    else
+    {
+        result = RT_EOK;
+    }
+    rt_device_request_done(dev, req, size, result);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_device_submit);
+
+/**
+ * This function will cancel an asynchronous request which is in flight. A
+ * cancelled request is completed with the error code -RT_EINTR.
+ *
+ * @param dev the pointer of device driver structure
+ * @param req the pointer of request descriptor
+ *
+ * @return RT_EOK on successfully, -RT_EBUSY if the transfer of request has
+ *         been started by device, or -RT_ERROR if the request is completed.
+ */
+rt_err_t rt_device_cancel(rt_device_t dev, struct rt_device_request *req)
+{
+    RT_ASSERT(dev != RT_NULL);
+    RT_ASSERT(req != RT_NULL);
+
+    if (req->status != RT_DEVICE_REQ_PENDING)
+        return -RT_ERROR;
+
+    if ((dev->flag & RT_DEVICE_FLAG_ASYNC) && dev->cancel != RT_NULL)
+        return dev->cancel(dev, req);
+
+    return -RT_EBUSY;
+}
+RTM_EXPORT(rt_device_cancel);
+
+/**
+ * This function will complete an asynchronous request, it is invoked by device
+ * driver when the request is finished or cancelled, and it could be invoked in
+ * interrupt context. A request is only completed once.
+ *
+ * @param dev the pointer of device driver structure
+ * @param req the pointer of request descriptor
+ * @param result the actually transferred size
+ * @param error the error code of request
+ */
+void rt_device_request_done(rt_device_t               dev,
+                            struct rt_device_request *req,
+                            rt_size_t                 result,
+                            rt_err_t                  error)
+{
+    register rt_base_t level;
+
+    RT_ASSERT(req != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    if (req->status != RT_DEVICE_REQ_PENDING)
+    {
+        /* it's completed by the other side, e.g. completed and cancelled */
+        rt_hw_interrupt_enable(level);
+
+        return;
+    }
+    req->result = result;
+    req->error  = error;
+    req->status = RT_DEVICE_REQ_IDLE;
+    rt_hw_interrupt_enable(level);
+
+    if (req->done != RT_NULL)
+        req->done(dev, req);
+}
+RTM_EXPORT(rt_device_request_done);
+#endif
+
 #endif
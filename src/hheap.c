@@ -0,0 +1,642 @@
+/*
+ * File      : hheap.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Handle heap, a heap of movable blocks.
+ *
+ * The blocks are laid out one after another from the start of heap to top,
+ * and the memory above top is free. A block is referenced by a handle, and
+ * its address is got by rt_hheap_lock, which pins the block until
+ * rt_hheap_unlock. A released block becomes a hole.
+ *
+ * The compaction moves the unlocked blocks down into the holes and updates
+ * their handles, so the free memory is gathered above top and large blocks
+ * can still be allocated after a long time. It's done one block in each
+ * step by the idle thread, or at once when an allocation can't be satisfied
+ * by the holes.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef RT_USING_HANDLE_HEAP
+
+struct rt_hheap_block
+{
+    rt_handle_t handle;                                 /* RT_NULL for a hole */
+    rt_size_t   size;                                   /* block size with this header */
+};
+
+#define HHEAP_BLOCK_SIZE        RT_ALIGN(sizeof(struct rt_hheap_block), RT_ALIGN_SIZE)
+#define HHEAP_MIN_SIZE          (HHEAP_BLOCK_SIZE + RT_ALIGN_SIZE)
+#define HHEAP_BLOCK(ptr)        ((struct rt_hheap_block *)((rt_uint8_t *)(ptr) - HHEAP_BLOCK_SIZE))
+#define HHEAP_NEXT(block)       ((struct rt_hheap_block *)((rt_uint8_t *)(block) + (block)->size))
+#define HHEAP_IS_HOLE(heap, block) \
+    ((rt_uint8_t *)(block) < (heap)->top && (block)->handle == RT_NULL)
+
+static rt_list_t _hheap_list = RT_LIST_OBJECT_INIT(_hheap_list);
+
+static void rt_hheap_set_top(struct rt_hheap *heap, struct rt_hheap_block *block)
+{
+    heap->top = (rt_uint8_t *)block;
+    if (heap->hole > heap->top)
+        heap->hole = heap->top;
+}
+
+/* merge the hole after block into it */
+static void rt_hheap_merge(struct rt_hheap *heap, struct rt_hheap_block *block)
+{
+    struct rt_hheap_block *next;
+
+    next = HHEAP_NEXT(block);
+    block->size += next->size;
+    if (heap->hole == (rt_uint8_t *)next)
+        heap->hole = (rt_uint8_t *)block;
+}
+
+/* split the tail of block as a hole, if it's large enough */
+static void rt_hheap_split(struct rt_hheap *heap,
+                           struct rt_hheap_block *block,
+                           rt_size_t size)
+{
+    struct rt_hheap_block *hole;
+
+    if (block->size < size + HHEAP_MIN_SIZE)
+        return;
+
+    hole = (struct rt_hheap_block *)((rt_uint8_t *)block + size);
+    hole->handle = RT_NULL;
+    hole->size = block->size - size;
+    block->size = size;
+
+    if (HHEAP_IS_HOLE(heap, HHEAP_NEXT(hole)))
+        rt_hheap_merge(heap, hole);
+    if (HHEAP_NEXT(hole) == (struct rt_hheap_block *)heap->top)
+        rt_hheap_set_top(heap, hole);
+    else if ((rt_uint8_t *)hole < heap->hole)
+        heap->hole = (rt_uint8_t *)hole;
+}
+
+/* make block a hole, and give it back above top if it's the last one */
+static void rt_hheap_release_block(struct rt_hheap *heap,
+                                   struct rt_hheap_block *block)
+{
+    block->handle = RT_NULL;
+    heap->available += block->size;
+
+    if (HHEAP_IS_HOLE(heap, HHEAP_NEXT(block)))
+        rt_hheap_merge(heap, block);
+    if (HHEAP_NEXT(block) == (struct rt_hheap_block *)heap->top)
+        rt_hheap_set_top(heap, block);
+    else if ((rt_uint8_t *)block < heap->hole)
+        heap->hole = (rt_uint8_t *)block;
+}
+
+/*
+ * move the first movable block above a hole into it, returns RT_FALSE if
+ * there is nothing to compact.
+ */
+static rt_bool_t rt_hheap_compact_step(struct rt_hheap *heap)
+{
+    struct rt_hheap_block *hole, *next;
+    rt_handle_t handle;
+    rt_size_t size;
+
+    /* find the first hole */
+    hole = (struct rt_hheap_block *)heap->hole;
+    while ((rt_uint8_t *)hole < heap->top && hole->handle != RT_NULL)
+        hole = HHEAP_NEXT(hole);
+    heap->hole = (rt_uint8_t *)hole;
+    if ((rt_uint8_t *)hole >= heap->top)
+        return RT_FALSE;
+
+    next = HHEAP_NEXT(hole);
+    if ((rt_uint8_t *)next == heap->top)
+    {
+        /* the last hole is given back above top */
+        rt_hheap_set_top(heap, hole);
+
+        return RT_FALSE;
+    }
+
+    if (next->handle == RT_NULL)
+    {
+        rt_hheap_merge(heap, hole);
+
+        return RT_TRUE;
+    }
+
+    if (next->handle->lock > 0)
+    {
+        /* the locked block can't be moved, compact the holes above it */
+        heap->hole = (rt_uint8_t *)HHEAP_NEXT(next);
+
+        return RT_TRUE;
+    }
+
+    /* move the block down, then the hole is above it */
+    handle = next->handle;
+    size   = hole->size;
+    if (size >= next->size)
+        rt_memcpy(hole, next, next->size);
+    else
+        rt_memmove(hole, next, next->size);
+    handle->ptr = (rt_uint8_t *)hole + HHEAP_BLOCK_SIZE;
+    heap->moved += hole->size;
+
+    next = HHEAP_NEXT(hole);
+    next->handle = RT_NULL;
+    next->size   = size;
+    heap->hole   = (rt_uint8_t *)next;
+
+    return RT_TRUE;
+}
+
+/* take a block of size from above top or a hole */
+static struct rt_hheap_block *rt_hheap_take(struct rt_hheap *heap, rt_size_t size)
+{
+    struct rt_hheap_block *block;
+
+    if ((rt_size_t)(heap->end - heap->top) >= size)
+    {
+        block = (struct rt_hheap_block *)heap->top;
+        block->size = size;
+        heap->top += size;
+
+        return block;
+    }
+
+    /* first fit in holes, the holes behind locked blocks are searched too */
+    for (block = (struct rt_hheap_block *)heap->start;
+         (rt_uint8_t *)block < heap->top;
+         block = HHEAP_NEXT(block))
+    {
+        if (block->handle != RT_NULL)
+            continue;
+
+        while (HHEAP_IS_HOLE(heap, HHEAP_NEXT(block)))
+            rt_hheap_merge(heap, block);
+
+        if (block->size >= size)
+        {
+            rt_hheap_split(heap, block, size);
+
+            return block;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static struct rt_hheap_block *rt_hheap_find_space(struct rt_hheap *heap,
+                                                  rt_size_t        size)
+{
+    struct rt_hheap_block *block;
+
+    if (size > heap->available)
+        return RT_NULL;
+
+    block = rt_hheap_take(heap, size);
+    if (block == RT_NULL)
+    {
+        /* gather the holes by compaction, then try again */
+        while (rt_hheap_compact_step(heap)) ;
+
+        block = rt_hheap_take(heap, size);
+    }
+
+    return block;
+}
+
+/**
+ * @addtogroup MM
+ */
+
+/*@{*/
+
+/**
+ * This function initializes a handle heap on a memory area. The handle
+ * table is placed at the beginning of the area.
+ *
+ * @param heap the handle heap object
+ * @param name the name of handle heap
+ * @param start_addr the start address of memory area
+ * @param size the size of memory area
+ * @param handle_count the max numbers of blocks
+ *
+ * @return RT_EOK on successful, -RT_ERROR if the memory area is too small.
+ */
+rt_err_t rt_hheap_init(struct rt_hheap *heap,
+                       const char      *name,
+                       void            *start_addr,
+                       rt_size_t        size,
+                       rt_size_t        handle_count)
+{
+    rt_size_t index;
+
+    RT_ASSERT(heap != RT_NULL);
+    RT_ASSERT(handle_count > 0);
+
+    rt_strncpy(heap->name, name, RT_NAME_MAX);
+
+    heap->handle_table = (struct rt_hheap_handle *)
+                         RT_ALIGN((rt_ubase_t)start_addr, RT_ALIGN_SIZE);
+    heap->handle_count = handle_count;
+    heap->start = (rt_uint8_t *)
+                  RT_ALIGN((rt_ubase_t)(heap->handle_table + handle_count), RT_ALIGN_SIZE);
+    heap->end   = (rt_uint8_t *)
+                  RT_ALIGN_DOWN((rt_ubase_t)start_addr + size, RT_ALIGN_SIZE);
+    if (heap->start + HHEAP_MIN_SIZE > heap->end)
+        return -RT_ERROR;
+
+    heap->top       = heap->start;
+    heap->hole      = heap->start;
+    heap->available = heap->end - heap->start;
+    heap->moved     = 0;
+
+    /* link all handles in free handle list */
+    for (index = 0; index < handle_count; index ++)
+    {
+        heap->handle_table[index].ptr  = &(heap->handle_table[index + 1]);
+        heap->handle_table[index].heap = heap;
+        heap->handle_table[index].lock = 0;
+    }
+    heap->handle_table[handle_count - 1].ptr = RT_NULL;
+    heap->free_handle = heap->handle_table;
+
+    rt_mutex_init(&(heap->lock), name, RT_IPC_FLAG_FIFO);
+
+    rt_enter_critical();
+    rt_list_insert_before(&_hheap_list, &(heap->list));
+    rt_exit_critical();
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_hheap_init);
+
+/**
+ * This function detaches a handle heap, all its blocks shall be released
+ * before.
+ *
+ * @param heap the handle heap object
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_hheap_detach(struct rt_hheap *heap)
+{
+    RT_ASSERT(heap != RT_NULL);
+
+    /* wait for the compaction step of idle thread */
+    rt_mutex_take(&(heap->lock), RT_WAITING_FOREVER);
+
+    rt_enter_critical();
+    rt_list_remove(&(heap->list));
+    rt_exit_critical();
+
+    rt_mutex_detach(&(heap->lock));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_hheap_detach);
+
+/**
+ * This function allocates a movable block from handle heap. The heap is
+ * compacted if the free memory is enough but not contiguous.
+ *
+ * @param heap the handle heap object
+ * @param size the size of block
+ *
+ * @return the handle of block, or RT_NULL on failed.
+ */
+rt_handle_t rt_hheap_alloc(struct rt_hheap *heap, rt_size_t size)
+{
+    struct rt_hheap_block *block;
+    rt_handle_t handle;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+    RT_ASSERT(heap != RT_NULL);
+
+    size = RT_ALIGN(size, RT_ALIGN_SIZE) + HHEAP_BLOCK_SIZE;
+
+    rt_mutex_take(&(heap->lock), RT_WAITING_FOREVER);
+
+    handle = heap->free_handle;
+    if (handle == RT_NULL)
+        goto __exit;
+
+    block = rt_hheap_find_space(heap, size);
+    if (block == RT_NULL)
+    {
+        handle = RT_NULL;
+        goto __exit;
+    }
+
+    heap->free_handle = (rt_handle_t)handle->ptr;
+    heap->available  -= block->size;
+
+    block->handle = handle;
+    handle->ptr   = (rt_uint8_t *)block + HHEAP_BLOCK_SIZE;
+    handle->lock  = 0;
+
+__exit:
+    rt_mutex_release(&(heap->lock));
+
+    return handle;
+}
+RTM_EXPORT(rt_hheap_alloc);
+
+/**
+ * This function changes the size of a movable block. The block keeps its
+ * handle, but it may be moved if it isn't locked.
+ *
+ * @param handle the handle of block
+ * @param newsize the new size of block
+ *
+ * @return RT_EOK on successful, -RT_EBUSY if the block is locked and can't
+ * grow in place, -RT_ENOMEM if there is no enough memory.
+ */
+rt_err_t rt_hheap_realloc(rt_handle_t handle, rt_size_t newsize)
+{
+    struct rt_hheap *heap;
+    struct rt_hheap_block *block, *next, *new_block;
+    rt_size_t size, old_size;
+    rt_err_t result = RT_EOK;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+    RT_ASSERT(handle != RT_NULL);
+
+    heap = handle->heap;
+    size = RT_ALIGN(newsize, RT_ALIGN_SIZE) + HHEAP_BLOCK_SIZE;
+
+    rt_mutex_take(&(heap->lock), RT_WAITING_FOREVER);
+
+    block    = HHEAP_BLOCK(handle->ptr);
+    old_size = block->size;
+    if (size <= block->size)
+    {
+        /* shrink in place */
+        rt_hheap_split(heap, block, size);
+        heap->available += old_size - block->size;
+
+        goto __exit;
+    }
+
+    next = HHEAP_NEXT(block);
+    if (HHEAP_IS_HOLE(heap, next))
+    {
+        while (HHEAP_IS_HOLE(heap, HHEAP_NEXT(next)))
+            rt_hheap_merge(heap, next);
+        if (HHEAP_NEXT(next) == (struct rt_hheap_block *)heap->top)
+            rt_hheap_set_top(heap, next);
+    }
+
+    if ((rt_uint8_t *)next == heap->top &&
+        (rt_size_t)(heap->end - (rt_uint8_t *)block) >= size)
+    {
+        /* grow in place above top */
+        block->size = size;
+        heap->top = (rt_uint8_t *)block + size;
+        heap->available -= size - old_size;
+        if (heap->hole > (rt_uint8_t *)block)
+            heap->hole = heap->top;
+
+        goto __exit;
+    }
+
+    if (HHEAP_IS_HOLE(heap, next) && block->size + next->size >= size)
+    {
+        /* grow in place into the next hole */
+        rt_hheap_merge(heap, block);
+        rt_hheap_split(heap, block, size);
+        heap->available -= block->size - old_size;
+
+        goto __exit;
+    }
+
+    if (handle->lock > 0)
+    {
+        result = -RT_EBUSY;
+        goto __exit;
+    }
+
+    /* move the block, which may be moved by compaction meanwhile */
+    new_block = rt_hheap_find_space(heap, size);
+    if (new_block == RT_NULL)
+    {
+        result = -RT_ENOMEM;
+        goto __exit;
+    }
+    heap->available -= new_block->size;
+    new_block->handle = handle;
+
+    block = HHEAP_BLOCK(handle->ptr);
+    rt_memcpy((rt_uint8_t *)new_block + HHEAP_BLOCK_SIZE, handle->ptr,
+              block->size - HHEAP_BLOCK_SIZE);
+    handle->ptr = (rt_uint8_t *)new_block + HHEAP_BLOCK_SIZE;
+    rt_hheap_release_block(heap, block);
+
+__exit:
+    rt_mutex_release(&(heap->lock));
+
+    return result;
+}
+RTM_EXPORT(rt_hheap_realloc);
+
+/**
+ * This function releases a movable block.
+ *
+ * @param handle the handle of block
+ */
+void rt_hheap_free(rt_handle_t handle)
+{
+    struct rt_hheap *heap;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+    RT_ASSERT(handle != RT_NULL);
+
+    heap = handle->heap;
+
+    rt_mutex_take(&(heap->lock), RT_WAITING_FOREVER);
+
+    rt_hheap_release_block(heap, HHEAP_BLOCK(handle->ptr));
+
+    /* put the handle back to free handle list */
+    handle->ptr  = heap->free_handle;
+    handle->lock = 0;
+    heap->free_handle = handle;
+
+    rt_mutex_release(&(heap->lock));
+}
+RTM_EXPORT(rt_hheap_free);
+
+/**
+ * This function locks a movable block, which is not moved until it's
+ * unlocked. The lock is counted.
+ *
+ * @param handle the handle of block
+ *
+ * @return the address of block
+ */
+void *rt_hheap_lock(rt_handle_t handle)
+{
+    void *ptr;
+
+    RT_ASSERT(handle != RT_NULL);
+
+    rt_mutex_take(&(handle->heap->lock), RT_WAITING_FOREVER);
+    handle->lock ++;
+    ptr = handle->ptr;
+    rt_mutex_release(&(handle->heap->lock));
+
+    return ptr;
+}
+RTM_EXPORT(rt_hheap_lock);
+
+/**
+ * This function unlocks a movable block, the address got by rt_hheap_lock
+ * shall not be used after the last unlock.
+ *
+ * @param handle the handle of block
+ */
+void rt_hheap_unlock(rt_handle_t handle)
+{
+    struct rt_hheap *heap;
+
+    RT_ASSERT(handle != RT_NULL);
+    RT_ASSERT(handle->lock > 0);
+
+    heap = handle->heap;
+
+    rt_mutex_take(&(heap->lock), RT_WAITING_FOREVER);
+    handle->lock --;
+    /* the holes below this block can be compacted now */
+    if (handle->lock == 0)
+        heap->hole = heap->start;
+    rt_mutex_release(&(heap->lock));
+}
+RTM_EXPORT(rt_hheap_unlock);
+
+/**
+ * This function returns the usable size of a movable block.
+ *
+ * @param handle the handle of block
+ *
+ * @return the usable size of block
+ */
+rt_size_t rt_hheap_size(rt_handle_t handle)
+{
+    RT_ASSERT(handle != RT_NULL);
+
+    return HHEAP_BLOCK(handle->ptr)->size - HHEAP_BLOCK_SIZE;
+}
+RTM_EXPORT(rt_hheap_size);
+
+/**
+ * This function compacts a handle heap at once, all the unlocked blocks are
+ * moved down to gather the free memory above top.
+ *
+ * @param heap the handle heap object
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_hheap_compact(struct rt_hheap *heap)
+{
+    RT_ASSERT(heap != RT_NULL);
+
+    rt_mutex_take(&(heap->lock), RT_WAITING_FOREVER);
+    while (rt_hheap_compact_step(heap)) ;
+    rt_mutex_release(&(heap->lock));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_hheap_compact);
+
+/**
+ * This function does one step of compaction on a handle heap in turn, it's
+ * invoked by the idle thread. The heap in use is skipped. The heap lock is a
+ * mutex, so a thread waiting for it raises the idle thread until the step,
+ * which moves one block, is done.
+ */
+void rt_hheap_idle_compact(void)
+{
+    struct rt_hheap *heap = RT_NULL;
+
+    rt_enter_critical();
+    if (!rt_list_isempty(&_hheap_list))
+    {
+        heap = rt_list_entry(_hheap_list.next, struct rt_hheap, list);
+
+        /* the next heap is compacted in next step */
+        rt_list_remove(&(heap->list));
+        rt_list_insert_before(&_hheap_list, &(heap->list));
+
+        if (rt_mutex_take(&(heap->lock), 0) != RT_EOK)
+            heap = RT_NULL;
+    }
+    rt_exit_critical();
+
+    if (heap != RT_NULL)
+    {
+        rt_hheap_compact_step(heap);
+        rt_mutex_release(&(heap->lock));
+    }
+}
+
+/*@}*/
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+void list_hheap(void)
+{
+    struct rt_hheap *heap;
+    struct rt_hheap_block *block;
+    struct rt_list_node *node;
+    rt_size_t largest, used;
+
+    rt_kprintf("hheap    pool size  available  largest    handle moved\n");
+    rt_kprintf("-------- ---------- ---------- ---------- ------ ----------\n");
+    rt_enter_critical();
+    for (node = _hheap_list.next; node != &_hheap_list; node = node->next)
+    {
+        heap = rt_list_entry(node, struct rt_hheap, list);
+
+        largest = heap->end - heap->top;
+        used = 0;
+        for (block = (struct rt_hheap_block *)heap->start;
+             (rt_uint8_t *)block < heap->top;
+             block = HHEAP_NEXT(block))
+        {
+            if (block->handle != RT_NULL)
+                used ++;
+            else if (block->size > largest)
+                largest = block->size;
+        }
+
+        rt_kprintf("%-8.*s %-10d %-10d %-10d %-6d %-10d\n",
+                   RT_NAME_MAX, heap->name, heap->end - heap->start,
+                   heap->available, largest, used, heap->moved);
+    }
+    rt_exit_critical();
+}
+FINSH_FUNCTION_EXPORT(list_hheap, list handle heap in system)
+#endif
+
+#endif
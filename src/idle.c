@@ -41,6 +41,50 @@ static rt_uint8_t rt_thread_stack[IDLE_THREAD_STACK_SIZE];
 
 extern rt_list_t rt_thread_defunct;
 
+#ifdef RT_USING_STACK_SAMPLER
+#ifndef RT_STACK_SAMPLER_WORDS
+#define RT_STACK_SAMPLER_WORDS  32
+#endif
+
+extern struct rt_object_information rt_object_container[];
+static rt_uint32_t rt_stack_sample_index;
+
+/* scan a slice of the stack of a thread, the threads are sampled in turn */
+static void rt_thread_idle_stack_sample(void)
+{
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    rt_uint32_t index;
+
+    information = &rt_object_container[RT_Object_Class_Thread];
+
+    rt_enter_critical();
+
+    index = 0;
+    for (node  = information->object_list.next;
+         node != &(information->object_list);
+         node  = node->next)
+    {
+        if (index == rt_stack_sample_index)
+            break;
+        index ++;
+    }
+
+    if (node == &(information->object_list))
+    {
+        /* start from the first thread again */
+        rt_stack_sample_index = 0;
+        node = information->object_list.next;
+    }
+
+    if (rt_thread_stack_scan(rt_list_entry(node, struct rt_thread, list),
+                             RT_STACK_SAMPLER_WORDS) == RT_TRUE)
+        rt_stack_sample_index ++;
+
+    rt_exit_critical();
+}
+#endif
+
 #ifdef RT_USING_HOOK
 /**
  * @addtogroup Hook
@@ -173,6 +217,21 @@ static void rt_thread_idle_entry(void *parameter)
         #endif
 
         rt_thread_idle_excute();
+
+#ifdef RT_USING_STACK_SAMPLER
+        /* track the stack high-water mark of threads */
+        rt_thread_idle_stack_sample();
+#endif
+
+#ifdef RT_USING_HANDLE_HEAP
+        /* move a block of handle heap to gather its free memory */
+        rt_hheap_idle_compact();
+#endif
+
+#ifdef RT_USING_TICKLESS
+        /* suspend the periodic tick until the next timer timeout */
+        rt_tick_suspend();
+#endif
     }
 }
 
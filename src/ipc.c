@@ -62,6 +62,14 @@ extern void (*rt_object_put_hook)(struct rt_object *object);
 
 /*@{*/
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+#define RT_IPC_PRIO_QUEUE(queue)    (queue)
+
+extern int __rt_ffs(int value);
+#else
+#define RT_IPC_PRIO_QUEUE(queue)    RT_NULL
+#endif
+
 /**
  * This function will initialize an IPC object
  *
@@ -73,28 +81,161 @@ rt_inline rt_err_t rt_ipc_object_init(struct rt_ipc_object *ipc)
 {
     /* init ipc object */
     rt_list_init(&(ipc->suspend_thread));
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    ipc->prio_queue = RT_NULL;
+#endif
 
     return RT_EOK;
 }
 
+#if defined(RT_USING_IPC_PRIO_QUEUE) && defined(RT_USING_HEAP)
+/**
+ * This function will create a priority indexed queue for the IPC object
+ * created with RT_IPC_FLAG_PRIO_QUEUE flag.
+ *
+ * @param flag the IPC object flag
+ *
+ * @return the created queue, RT_NULL if the flag is not set or no memory.
+ *         The IPC object without queue falls back to the priority ordered
+ *         suspend list.
+ */
+static struct rt_ipc_prio_queue *rt_ipc_prio_queue_create(rt_uint8_t flag)
+{
+    struct rt_ipc_prio_queue *queue;
+    register rt_ubase_t index;
+
+    if (!(flag & RT_IPC_FLAG_PRIO_QUEUE))
+        return RT_NULL;
+
+    queue = (struct rt_ipc_prio_queue *)rt_malloc(sizeof(struct rt_ipc_prio_queue));
+    if (queue == RT_NULL)
+        return RT_NULL;
+
+    queue->group = 0;
+#if RT_THREAD_PRIORITY_MAX > 32
+    rt_memset(queue->table, 0, sizeof(queue->table));
+#endif
+    for (index = 0; index < RT_THREAD_PRIORITY_MAX; index ++)
+        rt_list_init(&(queue->thread[index]));
+
+    return queue;
+}
+
+/**
+ * This function will delete the priority indexed queue of an IPC object.
+ *
+ * @param queue the priority indexed queue, RT_NULL if none
+ */
+static void rt_ipc_prio_queue_delete(struct rt_ipc_prio_queue *queue)
+{
+    if (queue != RT_NULL)
+        rt_free(queue);
+}
+#endif
+
+/**
+ * This function will get the highest priority thread suspended on a priority
+ * indexed queue.
+ *
+ * A thread may leave the queue without the knowledge of IPC object, such as
+ * timeout or deletion, so the bit of an empty priority is cleared here.
+ *
+ * @param queue the priority indexed queue
+ *
+ * @return the highest priority thread, RT_NULL if the queue is empty
+ */
+rt_inline struct rt_thread *rt_ipc_prio_queue_first(struct rt_ipc_prio_queue *queue)
+{
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    register rt_ubase_t priority;
+#if RT_THREAD_PRIORITY_MAX > 32
+    register rt_ubase_t number;
+#endif
+
+    while (queue->group)
+    {
+#if RT_THREAD_PRIORITY_MAX > 32
+        number = __rt_ffs(queue->group) - 1;
+        priority = (number << 3) + __rt_ffs(queue->table[number]) - 1;
+#else
+        priority = __rt_ffs(queue->group) - 1;
+#endif
+
+        if (!rt_list_isempty(&(queue->thread[priority])))
+            return rt_list_entry(queue->thread[priority].next,
+                                 struct rt_thread,
+                                 tlist);
+
+        /* no thread of this priority any more */
+#if RT_THREAD_PRIORITY_MAX > 32
+        queue->table[number] &= ~(1 << (priority & 0x07));
+        if (queue->table[number] == 0)
+            queue->group &= ~(1 << number);
+#else
+        queue->group &= ~(1 << priority);
+#endif
+    }
+#endif
+
+    return RT_NULL;
+}
+
+/**
+ * This function will get the first thread in the list of a IPC object.
+ *
+ * @param list the thread list
+ * @param queue the priority indexed queue of the list, RT_NULL if none
+ *
+ * @return the first thread, RT_NULL if no thread is suspended
+ */
+rt_inline struct rt_thread *rt_ipc_list_first(rt_list_t                *list,
+                                              struct rt_ipc_prio_queue *queue)
+{
+    if (queue != RT_NULL)
+        return rt_ipc_prio_queue_first(queue);
+
+    if (rt_list_isempty(list))
+        return RT_NULL;
+
+    return rt_list_entry(list->next, struct rt_thread, tlist);
+}
+
 /**
  * This function will suspend a thread to a specified list. IPC object or some
  * double-queue object (mailbox etc.) contains this kind of list.
  *
  * @param list the IPC suspended thread list
+ * @param queue the priority indexed queue of the list, RT_NULL if none
  * @param thread the thread object to be suspended
  * @param flag the IPC object flag,
- *        which shall be RT_IPC_FLAG_FIFO/RT_IPC_FLAG_PRIO.
+ *        which shall be RT_IPC_FLAG_FIFO/RT_IPC_FLAG_PRIO/RT_IPC_FLAG_PRIO_QUEUE.
  *
  * @return the operation status, RT_EOK on successful
  */
-rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
-                                       struct rt_thread *thread,
-                                       rt_uint8_t        flag)
+rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t                *list,
+                                       struct rt_ipc_prio_queue *queue,
+                                       struct rt_thread         *thread,
+                                       rt_uint8_t                flag)
 {
     /* suspend thread */
     rt_thread_suspend(thread);
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    if (queue != RT_NULL)
+    {
+        /* append to the list of its priority, which keeps FIFO in priority */
+        rt_list_insert_before(&(queue->thread[thread->current_priority]),
+                              &(thread->tlist));
+
+#if RT_THREAD_PRIORITY_MAX > 32
+        queue->table[thread->number] |= thread->high_mask;
+#endif
+        queue->group |= thread->number_mask;
+
+        return RT_EOK;
+    }
+#endif
+
     switch (flag)
     {
     case RT_IPC_FLAG_FIFO:
@@ -102,6 +243,7 @@ rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
         break;
 
     case RT_IPC_FLAG_PRIO:
+    case RT_IPC_FLAG_PRIO_QUEUE:
         {
             struct rt_list_node *n;
             struct rt_thread *sthread;
@@ -139,15 +281,17 @@ rt_inline rt_err_t rt_ipc_list_suspend(rt_list_t        *list,
  * - put the thread into system ready queue
  *
  * @param list the thread list
+ * @param queue the priority indexed queue of the list, RT_NULL if none
  *
  * @return the operation status, RT_EOK on successful
  */
-rt_inline rt_err_t rt_ipc_list_resume(rt_list_t *list)
+rt_inline rt_err_t rt_ipc_list_resume(rt_list_t                *list,
+                                      struct rt_ipc_prio_queue *queue)
 {
     struct rt_thread *thread;
 
     /* get thread entry */
-    thread = rt_list_entry(list->next, struct rt_thread, tlist);
+    thread = rt_ipc_list_first(list, queue);
 
     RT_DEBUG_LOG(RT_DEBUG_IPC, ("resume thread:%s\n", thread->name));
 
@@ -162,22 +306,32 @@ rt_inline rt_err_t rt_ipc_list_resume(rt_list_t *list)
  * suspend list of IPC object and private list of mailbox etc.
  *
  * @param list of the threads to resume
+ * @param queue the priority indexed queue of the list, RT_NULL if none
  *
  * @return the operation status, RT_EOK on successful
  */
-rt_inline rt_err_t rt_ipc_list_resume_all(rt_list_t *list)
+rt_inline rt_err_t rt_ipc_list_resume_all(rt_list_t                *list,
+                                          struct rt_ipc_prio_queue *queue)
 {
     struct rt_thread *thread;
     register rt_ubase_t temp;
 
     /* wakeup all suspend threads */
-    while (!rt_list_isempty(list))
+    while (1)
     {
         /* disable interrupt */
         temp = rt_hw_interrupt_disable();
 
         /* get next suspend thread */
-        thread = rt_list_entry(list->next, struct rt_thread, tlist);
+        thread = rt_ipc_list_first(list, queue);
+        if (thread == RT_NULL)
+        {
+            /* enable interrupt */
+            rt_hw_interrupt_enable(temp);
+
+            break;
+        }
+
         /* set error code to RT_ERROR */
         thread->error = -RT_ERROR;
 
@@ -195,6 +349,38 @@ rt_inline rt_err_t rt_ipc_list_resume_all(rt_list_t *list)
     return RT_EOK;
 }
 
+/**
+ * This function will start a batch of IPC release calls, the threads waked up
+ * in the batch don't preempt current thread until rt_ipc_batch_end, so there
+ * is only one re-schedule for the whole batch.
+ *
+ * The scheduler is locked in the batch, current thread shall not be blocked
+ * before rt_ipc_batch_end. The batches could be nested.
+ *
+ * @note this function shall not be invoked in interrupt status.
+ */
+void rt_ipc_batch_begin(void)
+{
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* the re-schedule of released IPC objects is deferred */
+    rt_enter_critical();
+}
+RTM_EXPORT(rt_ipc_batch_begin);
+
+/**
+ * This function will end a batch of IPC release calls, and re-schedule the
+ * threads waked up in the batch at once.
+ */
+void rt_ipc_batch_end(void)
+{
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* unlock scheduler and re-schedule */
+    rt_exit_critical();
+}
+RTM_EXPORT(rt_ipc_batch_end);
+
 #ifdef RT_USING_SEMAPHORE
 /**
  * This function will initialize a semaphore and put it under control of
@@ -244,7 +430,8 @@ rt_err_t rt_sem_detach(rt_sem_t sem)
     RT_ASSERT(sem != RT_NULL);
 
     /* wakeup all suspend threads */
-    rt_ipc_list_resume_all(&(sem->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(sem->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(sem->parent.prio_queue));
 
     /* detach semaphore object */
     rt_object_detach(&(sem->parent.parent));
@@ -285,6 +472,11 @@ rt_sem_t rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag)
     /* set parent */
     sem->parent.parent.flag = flag;
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* create priority indexed queue of suspended thread */
+    sem->parent.prio_queue = rt_ipc_prio_queue_create(flag);
+#endif
+
     return sem;
 }
 RTM_EXPORT(rt_sem_create);
@@ -305,7 +497,13 @@ rt_err_t rt_sem_delete(rt_sem_t sem)
     RT_ASSERT(sem != RT_NULL);
 
     /* wakeup all suspend threads */
-    rt_ipc_list_resume_all(&(sem->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(sem->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(sem->parent.prio_queue));
+
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* delete priority indexed queue of suspended thread */
+    rt_ipc_prio_queue_delete(sem->parent.prio_queue);
+#endif
 
     /* delete semaphore object */
     rt_object_delete(&(sem->parent.parent));
@@ -375,6 +573,7 @@ rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
 
             /* suspend thread */
             rt_ipc_list_suspend(&(sem->parent.suspend_thread),
+                                RT_IPC_PRIO_QUEUE(sem->parent.prio_queue),
                                 thread,
                                 sem->parent.parent.flag);
 
@@ -448,10 +647,12 @@ rt_err_t rt_sem_release(rt_sem_t sem)
                                 ((struct rt_object *)sem)->name,
                                 sem->value));
 
-    if (!rt_list_isempty(&sem->parent.suspend_thread))
+    if (rt_ipc_list_first(&(sem->parent.suspend_thread),
+                          RT_IPC_PRIO_QUEUE(sem->parent.prio_queue)) != RT_NULL)
     {
         /* resume the suspended thread */
-        rt_ipc_list_resume(&(sem->parent.suspend_thread));
+        rt_ipc_list_resume(&(sem->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(sem->parent.prio_queue));
         need_schedule = RT_TRUE;
     }
     else
@@ -468,6 +669,60 @@ rt_err_t rt_sem_release(rt_sem_t sem)
 }
 RTM_EXPORT(rt_sem_release);
 
+/**
+ * This function will release a semaphore by count units, the suspended
+ * threads are waked up as many as count, and there is only one re-schedule.
+ *
+ * @param sem the semaphore object
+ * @param count the units to be released
+ *
+ * @return the error code
+ */
+rt_err_t rt_sem_release_n(rt_sem_t sem, rt_uint16_t count)
+{
+    register rt_base_t temp;
+    register rt_bool_t need_schedule;
+
+    RT_ASSERT(sem != RT_NULL);
+
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(sem->parent.parent)));
+
+    need_schedule = RT_FALSE;
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    RT_DEBUG_LOG(RT_DEBUG_IPC, ("thread %s releases sem:%s by %d, which value is: %d\n",
+                                rt_thread_self()->name,
+                                ((struct rt_object *)sem)->name,
+                                count,
+                                sem->value));
+
+    /* resume the suspended threads */
+    while (count > 0 &&
+           rt_ipc_list_first(&(sem->parent.suspend_thread),
+                             RT_IPC_PRIO_QUEUE(sem->parent.prio_queue)) != RT_NULL)
+    {
+        rt_ipc_list_resume(&(sem->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(sem->parent.prio_queue));
+        need_schedule = RT_TRUE;
+        count --;
+    }
+
+    /* increase value by the left units */
+    sem->value += count;
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    /* resume threads, re-schedule */
+    if (need_schedule == RT_TRUE)
+        rt_schedule();
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_sem_release_n);
+
 /**
  * This function can get or set some extra attributions of a semaphore object.
  *
@@ -492,7 +747,8 @@ rt_err_t rt_sem_control(rt_sem_t sem, rt_uint8_t cmd, void *arg)
         level = rt_hw_interrupt_disable();
 
         /* resume all waiting thread */
-        rt_ipc_list_resume_all(&sem->parent.suspend_thread);
+        rt_ipc_list_resume_all(&(sem->parent.suspend_thread),
+                               RT_IPC_PRIO_QUEUE(sem->parent.prio_queue));
 
         /* set new value */
         sem->value = (rt_uint16_t)value;
@@ -557,7 +813,8 @@ rt_err_t rt_mutex_detach(rt_mutex_t mutex)
     RT_ASSERT(mutex != RT_NULL);
 
     /* wakeup all suspend threads */
-    rt_ipc_list_resume_all(&(mutex->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(mutex->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mutex->parent.prio_queue));
 
     /* detach semaphore object */
     rt_object_detach(&(mutex->parent.parent));
@@ -599,6 +856,11 @@ rt_mutex_t rt_mutex_create(const char *name, rt_uint8_t flag)
     /* set flag */
     mutex->parent.parent.flag = flag;
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* create priority indexed queue of suspended thread */
+    mutex->parent.prio_queue = rt_ipc_prio_queue_create(flag);
+#endif
+
     return mutex;
 }
 RTM_EXPORT(rt_mutex_create);
@@ -619,7 +881,13 @@ rt_err_t rt_mutex_delete(rt_mutex_t mutex)
     RT_ASSERT(mutex != RT_NULL);
 
     /* wakeup all suspend threads */
-    rt_ipc_list_resume_all(&(mutex->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(mutex->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mutex->parent.prio_queue));
+
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* delete priority indexed queue of suspended thread */
+    rt_ipc_prio_queue_delete(mutex->parent.prio_queue);
+#endif
 
     /* delete semaphore object */
     rt_object_delete(&(mutex->parent.parent));
@@ -713,6 +981,7 @@ rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
 
                 /* suspend current thread */
                 rt_ipc_list_suspend(&(mutex->parent.suspend_thread),
+                                    RT_IPC_PRIO_QUEUE(mutex->parent.prio_queue),
                                     thread,
                                     mutex->parent.parent.flag);
 
@@ -812,14 +1081,13 @@ rt_err_t rt_mutex_release(rt_mutex_t mutex)
                               &(mutex->original_priority));
         }
 
+        /* get suspended thread */
+        thread = rt_ipc_list_first(&(mutex->parent.suspend_thread),
+                                   RT_IPC_PRIO_QUEUE(mutex->parent.prio_queue));
+
         /* wakeup suspended thread */
-        if (!rt_list_isempty(&mutex->parent.suspend_thread))
+        if (thread != RT_NULL)
         {
-            /* get suspended thread */
-            thread = rt_list_entry(mutex->parent.suspend_thread.next,
-                                   struct rt_thread,
-                                   tlist);
-
             RT_DEBUG_LOG(RT_DEBUG_IPC, ("mutex_release: resume thread: %s\n",
                                         thread->name));
 
@@ -829,7 +1097,8 @@ rt_err_t rt_mutex_release(rt_mutex_t mutex)
             mutex->hold ++;
 
             /* resume thread */
-            rt_ipc_list_resume(&(mutex->parent.suspend_thread));
+            rt_ipc_list_resume(&(mutex->parent.suspend_thread),
+                               RT_IPC_PRIO_QUEUE(mutex->parent.prio_queue));
 
             need_schedule = RT_TRUE;
         }
@@ -915,7 +1184,7 @@ rt_err_t rt_event_detach(rt_event_t event)
     RT_ASSERT(event != RT_NULL);
 
     /* resume all suspended thread */
-    rt_ipc_list_resume_all(&(event->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(event->parent.suspend_thread), RT_NULL);
 
     /* detach event object */
     rt_object_detach(&(event->parent.parent));
@@ -972,7 +1241,7 @@ rt_err_t rt_event_delete(rt_event_t event)
     RT_DEBUG_NOT_IN_INTERRUPT;
 
     /* resume all suspended thread */
-    rt_ipc_list_resume_all(&(event->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(event->parent.suspend_thread), RT_NULL);
 
     /* delete event object */
     rt_object_delete(&(event->parent.parent));
@@ -1148,6 +1417,7 @@ rt_err_t rt_event_recv(rt_event_t   event,
 
         /* put thread to suspended thread list */
         rt_ipc_list_suspend(&(event->parent.suspend_thread),
+                            RT_NULL,
                             thread,
                             event->parent.parent.flag);
 
@@ -1209,7 +1479,7 @@ rt_err_t rt_event_control(rt_event_t event, rt_uint8_t cmd, void *arg)
         level = rt_hw_interrupt_disable();
 
         /* resume all waiting thread */
-        rt_ipc_list_resume_all(&event->parent.suspend_thread);
+        rt_ipc_list_resume_all(&(event->parent.suspend_thread), RT_NULL);
 
         /* init event set */
         event->set = 0;
@@ -1267,6 +1537,10 @@ rt_err_t rt_mb_init(rt_mailbox_t mb,
     /* init an additional list of sender suspend thread */
     rt_list_init(&(mb->suspend_sender_thread));
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    mb->sender_prio_queue = RT_NULL;
+#endif
+
     return RT_EOK;
 }
 RTM_EXPORT(rt_mb_init);
@@ -1284,9 +1558,11 @@ rt_err_t rt_mb_detach(rt_mailbox_t mb)
     RT_ASSERT(mb != RT_NULL);
 
     /* resume all suspended thread */
-    rt_ipc_list_resume_all(&(mb->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(mb->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mb->parent.prio_queue));
     /* also resume all mailbox private suspended thread */
-    rt_ipc_list_resume_all(&(mb->suspend_sender_thread));
+    rt_ipc_list_resume_all(&(mb->suspend_sender_thread),
+                           RT_IPC_PRIO_QUEUE(mb->sender_prio_queue));
 
     /* detach mailbox object */
     rt_object_detach(&(mb->parent.parent));
@@ -1339,6 +1615,12 @@ rt_mailbox_t rt_mb_create(const char *name, rt_size_t size, rt_uint8_t flag)
     /* init an additional list of sender suspend thread */
     rt_list_init(&(mb->suspend_sender_thread));
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* create priority indexed queue of suspended thread */
+    mb->parent.prio_queue = rt_ipc_prio_queue_create(flag);
+    mb->sender_prio_queue = rt_ipc_prio_queue_create(flag);
+#endif
+
     return mb;
 }
 RTM_EXPORT(rt_mb_create);
@@ -1358,10 +1640,18 @@ rt_err_t rt_mb_delete(rt_mailbox_t mb)
     RT_ASSERT(mb != RT_NULL);
 
     /* resume all suspended thread */
-    rt_ipc_list_resume_all(&(mb->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(mb->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mb->parent.prio_queue));
 
     /* also resume all mailbox private suspended thread */
-    rt_ipc_list_resume_all(&(mb->suspend_sender_thread));
+    rt_ipc_list_resume_all(&(mb->suspend_sender_thread),
+                           RT_IPC_PRIO_QUEUE(mb->sender_prio_queue));
+
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* delete priority indexed queue of suspended thread */
+    rt_ipc_prio_queue_delete(mb->parent.prio_queue);
+    rt_ipc_prio_queue_delete(mb->sender_prio_queue);
+#endif
 
 #if defined(RT_USING_MODULE) && defined(RT_USING_SLAB)
     /* the mb object belongs to an application module */
@@ -1438,6 +1728,7 @@ rt_err_t rt_mb_send_wait(rt_mailbox_t mb,
         RT_DEBUG_NOT_IN_INTERRUPT;
         /* suspend current thread */
         rt_ipc_list_suspend(&(mb->suspend_sender_thread),
+                            RT_IPC_PRIO_QUEUE(mb->sender_prio_queue),
                             thread,
                             mb->parent.parent.flag);
 
@@ -1493,9 +1784,11 @@ rt_err_t rt_mb_send_wait(rt_mailbox_t mb,
     mb->entry ++;
 
     /* resume suspended thread */
-    if (!rt_list_isempty(&mb->parent.suspend_thread))
+    if (rt_ipc_list_first(&(mb->parent.suspend_thread),
+                          RT_IPC_PRIO_QUEUE(mb->parent.prio_queue)) != RT_NULL)
     {
-        rt_ipc_list_resume(&(mb->parent.suspend_thread));
+        rt_ipc_list_resume(&(mb->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mb->parent.prio_queue));
 
         /* enable interrupt */
         rt_hw_interrupt_enable(temp);
@@ -1585,6 +1878,7 @@ rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_uint32_t *value, rt_int32_t timeout)
         RT_DEBUG_NOT_IN_INTERRUPT;
         /* suspend current thread */
         rt_ipc_list_suspend(&(mb->parent.suspend_thread),
+                            RT_IPC_PRIO_QUEUE(mb->parent.prio_queue),
                             thread,
                             mb->parent.parent.flag);
 
@@ -1641,9 +1935,11 @@ rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_uint32_t *value, rt_int32_t timeout)
     mb->entry --;
 
     /* resume suspended thread */
-    if (!rt_list_isempty(&(mb->suspend_sender_thread)))
+    if (rt_ipc_list_first(&(mb->suspend_sender_thread),
+                          RT_IPC_PRIO_QUEUE(mb->sender_prio_queue)) != RT_NULL)
     {
-        rt_ipc_list_resume(&(mb->suspend_sender_thread));
+        rt_ipc_list_resume(&(mb->suspend_sender_thread),
+                           RT_IPC_PRIO_QUEUE(mb->sender_prio_queue));
 
         /* enable interrupt */
         rt_hw_interrupt_enable(temp);
@@ -1684,9 +1980,11 @@ rt_err_t rt_mb_control(rt_mailbox_t mb, rt_uint8_t cmd, void *arg)
         level = rt_hw_interrupt_disable();
 
         /* resume all waiting thread */
-        rt_ipc_list_resume_all(&(mb->parent.suspend_thread));
+        rt_ipc_list_resume_all(&(mb->parent.suspend_thread),
+                               RT_IPC_PRIO_QUEUE(mb->parent.prio_queue));
         /* also resume all mailbox private suspended thread */
-        rt_ipc_list_resume_all(&(mb->suspend_sender_thread));
+        rt_ipc_list_resume_all(&(mb->suspend_sender_thread),
+                               RT_IPC_PRIO_QUEUE(mb->sender_prio_queue));
 
         /* re-init mailbox */
         mb->entry      = 0;
@@ -1788,7 +2086,8 @@ rt_err_t rt_mq_detach(rt_mq_t mq)
     RT_ASSERT(mq != RT_NULL);
 
     /* resume all suspended thread */
-    rt_ipc_list_resume_all(&mq->parent.suspend_thread);
+    rt_ipc_list_resume_all(&(mq->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mq->parent.prio_queue));
 
     /* detach message queue object */
     rt_object_detach(&(mq->parent.parent));
@@ -1830,6 +2129,11 @@ rt_mq_t rt_mq_create(const char *name,
     /* init ipc object */
     rt_ipc_object_init(&(mq->parent));
 
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* create priority indexed queue of suspended thread */
+    mq->parent.prio_queue = rt_ipc_prio_queue_create(flag);
+#endif
+
     /* init message queue */
 
     /* get correct message size */
@@ -1881,7 +2185,13 @@ rt_err_t rt_mq_delete(rt_mq_t mq)
     RT_ASSERT(mq != RT_NULL);
 
     /* resume all suspended thread */
-    rt_ipc_list_resume_all(&(mq->parent.suspend_thread));
+    rt_ipc_list_resume_all(&(mq->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mq->parent.prio_queue));
+
+#ifdef RT_USING_IPC_PRIO_QUEUE
+    /* delete priority indexed queue of suspended thread */
+    rt_ipc_prio_queue_delete(mq->parent.prio_queue);
+#endif
 
 #if defined(RT_USING_MODULE) && defined(RT_USING_SLAB)
     /* the mq object belongs to an application module */
@@ -1901,54 +2211,73 @@ rt_err_t rt_mq_delete(rt_mq_t mq)
 RTM_EXPORT(rt_mq_delete);
 #endif
 
+/* check whether the buffer is a message buffer of message queue object */
+#define RT_MQ_MSG_IN_POOL(mq, buffer)                                         \
+    ((rt_uint8_t *)(buffer) > (rt_uint8_t *)(mq)->msg_pool &&                 \
+     (rt_uint8_t *)(buffer) < (rt_uint8_t *)(mq)->msg_pool +                  \
+         ((mq)->msg_size + sizeof(struct rt_mq_message)) * (mq)->max_msgs)
+
 /**
- * This function will send a message to message queue object, if there are
- * threads suspended on message queue object, it will be waked up.
+ * This function will get a free message from message queue object.
  *
  * @param mq the message queue object
- * @param buffer the message
- * @param size the size of buffer
  *
- * @return the error code
+ * @return the free message, RT_NULL if the message queue is full
  */
-rt_err_t rt_mq_send(rt_mq_t mq, void *buffer, rt_size_t size)
+rt_inline struct rt_mq_message *rt_mq_msg_alloc(rt_mq_t mq)
 {
     register rt_ubase_t temp;
     struct rt_mq_message *msg;
 
-    RT_ASSERT(mq != RT_NULL);
-    RT_ASSERT(buffer != RT_NULL);
-    RT_ASSERT(size != 0);
-
-    /* greater than one message size */
-    if (size > mq->msg_size)
-        return -RT_ERROR;
-
-    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
-
     /* disable interrupt */
     temp = rt_hw_interrupt_disable();
 
-    /* get a free list, there must be an empty item */
-    msg = (struct rt_mq_message*)mq->msg_queue_free;
-    /* message queue is full */
-    if (msg == RT_NULL)
-    {
-        /* enable interrupt */
-        rt_hw_interrupt_enable(temp);
-
-        return -RT_EFULL;
-    }
+    /* get a free list */
+    msg = (struct rt_mq_message *)mq->msg_queue_free;
     /* move free list pointer */
-    mq->msg_queue_free = msg->next;
+    if (msg != RT_NULL)
+        mq->msg_queue_free = msg->next;
 
     /* enable interrupt */
     rt_hw_interrupt_enable(temp);
 
+    return msg;
+}
+
+/**
+ * This function will put a message back to the free list of message queue
+ * object.
+ *
+ * @param mq the message queue object
+ * @param msg the message
+ */
+rt_inline void rt_mq_msg_free(rt_mq_t mq, struct rt_mq_message *msg)
+{
+    register rt_ubase_t temp;
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+    /* put message to free list */
+    msg->next = (struct rt_mq_message *)mq->msg_queue_free;
+    mq->msg_queue_free = msg;
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+}
+
+/**
+ * This function will link a filled message to the tail of message queue
+ * object, if there are threads suspended on message queue object, it will be
+ * waked up.
+ *
+ * @param mq the message queue object
+ * @param msg the message
+ */
+static void rt_mq_msg_put(rt_mq_t mq, struct rt_mq_message *msg)
+{
+    register rt_ubase_t temp;
+
     /* the msg is the new tailer of list, the next shall be NULL */
     msg->next = RT_NULL;
-    /* copy buffer */
-    rt_memcpy(msg + 1, buffer, size);
 
     /* disable interrupt */
     temp = rt_hw_interrupt_disable();
@@ -1969,20 +2298,59 @@ rt_err_t rt_mq_send(rt_mq_t mq, void *buffer, rt_size_t size)
     mq->entry ++;
 
     /* resume suspended thread */
-    if (!rt_list_isempty(&mq->parent.suspend_thread))
+    if (rt_ipc_list_first(&(mq->parent.suspend_thread),
+                          RT_IPC_PRIO_QUEUE(mq->parent.prio_queue)) != RT_NULL)
     {
-        rt_ipc_list_resume(&(mq->parent.suspend_thread));
+        rt_ipc_list_resume(&(mq->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mq->parent.prio_queue));
 
         /* enable interrupt */
         rt_hw_interrupt_enable(temp);
 
         rt_schedule();
 
-        return RT_EOK;
+        return;
     }
 
     /* enable interrupt */
     rt_hw_interrupt_enable(temp);
+}
+
+/**
+ * This function will send a message to message queue object, if there are
+ * threads suspended on message queue object, it will be waked up.
+ *
+ * @param mq the message queue object
+ * @param buffer the message
+ * @param size the size of buffer
+ *
+ * @return the error code
+ */
+rt_err_t rt_mq_send(rt_mq_t mq, void *buffer, rt_size_t size)
+{
+    struct rt_mq_message *msg;
+
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+
+    /* greater than one message size */
+    if (size > mq->msg_size)
+        return -RT_ERROR;
+
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
+
+    /* get a free list, there must be an empty item */
+    msg = rt_mq_msg_alloc(mq);
+    /* message queue is full */
+    if (msg == RT_NULL)
+        return -RT_EFULL;
+
+    /* copy buffer */
+    rt_memcpy(msg + 1, buffer, size);
+
+    /* link msg to message queue */
+    rt_mq_msg_put(mq, msg);
 
     return RT_EOK;
 }
@@ -2051,9 +2419,11 @@ rt_err_t rt_mq_urgent(rt_mq_t mq, void *buffer, rt_size_t size)
     mq->entry ++;
 
     /* resume suspended thread */
-    if (!rt_list_isempty(&mq->parent.suspend_thread))
+    if (rt_ipc_list_first(&(mq->parent.suspend_thread),
+                          RT_IPC_PRIO_QUEUE(mq->parent.prio_queue)) != RT_NULL)
     {
-        rt_ipc_list_resume(&(mq->parent.suspend_thread));
+        rt_ipc_list_resume(&(mq->parent.suspend_thread),
+                           RT_IPC_PRIO_QUEUE(mq->parent.prio_queue));
 
         /* enable interrupt */
         rt_hw_interrupt_enable(temp);
@@ -2071,31 +2441,24 @@ rt_err_t rt_mq_urgent(rt_mq_t mq, void *buffer, rt_size_t size)
 RTM_EXPORT(rt_mq_urgent);
 
 /**
- * This function will receive a message from message queue object, if there is
- * no message in message queue object, the thread shall wait for a specified
- * time.
+ * This function will take the head message from message queue object, if
+ * there is no message in message queue object, the thread shall wait for a
+ * specified time.
  *
  * @param mq the message queue object
- * @param buffer the received message will be saved in
- * @param size the size of buffer
+ * @param msg the taken message
  * @param timeout the waiting time
  *
  * @return the error code
  */
-rt_err_t rt_mq_recv(rt_mq_t    mq,
-                    void      *buffer,
-                    rt_size_t  size,
-                    rt_int32_t timeout)
+static rt_err_t rt_mq_msg_take(rt_mq_t               mq,
+                               struct rt_mq_message **msg,
+                               rt_int32_t            timeout)
 {
     struct rt_thread *thread;
     register rt_ubase_t temp;
-    struct rt_mq_message *msg;
     rt_uint32_t tick_delta;
 
-    RT_ASSERT(mq != RT_NULL);
-    RT_ASSERT(buffer != RT_NULL);
-    RT_ASSERT(size != 0);
-
     /* initialize delta tick */
     tick_delta = 0;
     /* get current thread */
@@ -2134,6 +2497,7 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
 
         /* suspend current thread */
         rt_ipc_list_suspend(&(mq->parent.suspend_thread),
+                            RT_IPC_PRIO_QUEUE(mq->parent.prio_queue),
                             thread,
                             mq->parent.parent.flag);
 
@@ -2180,12 +2544,12 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
     }
 
     /* get message from queue */
-    msg = (struct rt_mq_message *)mq->msg_queue_head;
+    *msg = (struct rt_mq_message *)mq->msg_queue_head;
 
     /* move message queue head */
-    mq->msg_queue_head = msg->next;
+    mq->msg_queue_head = (*msg)->next;
     /* reach queue tail, set to NULL */
-    if (mq->msg_queue_tail == msg)
+    if (mq->msg_queue_tail == *msg)
         mq->msg_queue_tail = RT_NULL;
 
     /* decrease message entry */
@@ -2194,16 +2558,43 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
     /* enable interrupt */
     rt_hw_interrupt_enable(temp);
 
+    return RT_EOK;
+}
+
+/**
+ * This function will receive a message from message queue object, if there is
+ * no message in message queue object, the thread shall wait for a specified
+ * time.
+ *
+ * @param mq the message queue object
+ * @param buffer the received message will be saved in
+ * @param size the size of buffer
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_mq_recv(rt_mq_t    mq,
+                    void      *buffer,
+                    rt_size_t  size,
+                    rt_int32_t timeout)
+{
+    struct rt_mq_message *msg;
+    rt_err_t result;
+
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+
+    /* take message from queue */
+    result = rt_mq_msg_take(mq, &msg, timeout);
+    if (result != RT_EOK)
+        return result;
+
     /* copy message */
     rt_memcpy(buffer, msg + 1, size > mq->msg_size ? mq->msg_size : size);
 
-    /* disable interrupt */
-    temp = rt_hw_interrupt_disable();
     /* put message to free list */
-    msg->next = (struct rt_mq_message *)mq->msg_queue_free;
-    mq->msg_queue_free = msg;
-    /* enable interrupt */
-    rt_hw_interrupt_enable(temp);
+    rt_mq_msg_free(mq, msg);
 
     RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(mq->parent.parent)));
 
@@ -2211,6 +2602,116 @@ rt_err_t rt_mq_recv(rt_mq_t    mq,
 }
 RTM_EXPORT(rt_mq_recv);
 
+/**
+ * This function will reserve a free message of message queue object, the
+ * message could be filled in place and then sent by rt_mq_commit without
+ * copying.
+ *
+ * @param mq the message queue object
+ * @param buffer the reserved message buffer, its size is the message size of
+ *        message queue object
+ *
+ * @return the error code, -RT_EFULL if there is no free message
+ */
+rt_err_t rt_mq_reserve(rt_mq_t mq, void **buffer)
+{
+    struct rt_mq_message *msg;
+
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+
+    /* get a free list */
+    msg = rt_mq_msg_alloc(mq);
+    /* message queue is full */
+    if (msg == RT_NULL)
+        return -RT_EFULL;
+
+    *buffer = msg + 1;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_reserve);
+
+/**
+ * This function will send a message reserved by rt_mq_reserve to message
+ * queue object, if there are threads suspended on message queue object, it
+ * will be waked up.
+ *
+ * @param mq the message queue object
+ * @param buffer the reserved message buffer
+ *
+ * @return the error code
+ */
+rt_err_t rt_mq_commit(rt_mq_t mq, void *buffer)
+{
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(RT_MQ_MSG_IN_POOL(mq, buffer));
+
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
+
+    /* link msg to message queue */
+    rt_mq_msg_put(mq, (struct rt_mq_message *)buffer - 1);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_commit);
+
+/**
+ * This function will receive a message from message queue object without
+ * copying, the message buffer is loaned to the receiver until it's released
+ * by rt_mq_release. If there is no message in message queue object, the
+ * thread shall wait for a specified time.
+ *
+ * @param mq the message queue object
+ * @param buffer the received message buffer
+ * @param timeout the waiting time
+ *
+ * @return the error code
+ */
+rt_err_t rt_mq_recv_loan(rt_mq_t mq, void **buffer, rt_int32_t timeout)
+{
+    struct rt_mq_message *msg;
+    rt_err_t result;
+
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+
+    /* take message from queue */
+    result = rt_mq_msg_take(mq, &msg, timeout);
+    if (result != RT_EOK)
+        return result;
+
+    *buffer = msg + 1;
+
+    RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(mq->parent.parent)));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_recv_loan);
+
+/**
+ * This function will release a message buffer received by rt_mq_recv_loan,
+ * or a reserved message buffer which is not sent, to message queue object.
+ *
+ * @param mq the message queue object
+ * @param buffer the message buffer
+ *
+ * @return the error code
+ */
+rt_err_t rt_mq_release(rt_mq_t mq, void *buffer)
+{
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(RT_MQ_MSG_IN_POOL(mq, buffer));
+
+    /* put message to free list */
+    rt_mq_msg_free(mq, (struct rt_mq_message *)buffer - 1);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_release);
+
 /**
  * This function can get or set some extra attributions of a message queue
  * object.
@@ -2234,7 +2735,8 @@ rt_err_t rt_mq_control(rt_mq_t mq, rt_uint8_t cmd, void *arg)
         level = rt_hw_interrupt_disable();
 
         /* resume all waiting thread */
-        rt_ipc_list_resume_all(&mq->parent.suspend_thread);
+        rt_ipc_list_resume_all(&(mq->parent.suspend_thread),
+                               RT_IPC_PRIO_QUEUE(mq->parent.prio_queue));
 
         /* release all message in the queue */
         while (mq->msg_queue_head != RT_NULL)
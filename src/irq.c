@@ -52,6 +52,10 @@ void rt_interrupt_enter(void)
 
     level = rt_hw_interrupt_disable();
     rt_interrupt_nest ++;
+#ifdef RT_USING_TICKLESS
+    /* the interrupt wakes up the system from tickless idle */
+    rt_tick_resume();
+#endif
     rt_hw_interrupt_enable(level);
 }
 RTM_EXPORT(rt_interrupt_enter);
@@ -93,5 +97,162 @@ RTM_EXPORT(rt_interrupt_get_nest);
 RTM_EXPORT(rt_hw_interrupt_disable);
 RTM_EXPORT(rt_hw_interrupt_enable);
 
+#ifdef RT_USING_SCHED_STAT
+extern rt_uint8_t rt_scheduler_stat_on;
+
+static struct rt_irq_stat rt_irq_stat_table[RT_SCHED_STAT_IRQ_SITES];
+
+/* the outermost interrupt lock, which is released with the same level */
+static rt_uint8_t   rt_irq_stat_locked;
+static rt_base_t    rt_irq_stat_level;
+static rt_uint32_t  rt_irq_stat_stamp;
+static const char  *rt_irq_stat_function;
+static rt_uint32_t  rt_irq_stat_line;
+
+/*
+ * This function will account the outermost interrupt lock to its call site,
+ * it shall be invoked with interrupt disabled. The lock shorter than
+ * RT_SCHED_STAT_IRQ_MIN is not accounted, which saves the lookup of call site
+ * for the most of locks, and the call sites beyond the table are not
+ * accounted either.
+ */
+static void _rt_interrupt_stat_account(rt_uint32_t now)
+{
+    struct rt_irq_stat *stat;
+    rt_uint32_t index, probe, span;
+
+    rt_irq_stat_locked = 0;
+    span = now - rt_irq_stat_stamp;
+    if (span < RT_SCHED_STAT_IRQ_MIN)
+        return;
+
+    index = ((rt_ubase_t)rt_irq_stat_function >> 2) ^ rt_irq_stat_line;
+    for (probe = 0; probe < RT_SCHED_STAT_IRQ_SITES; probe ++, index ++)
+    {
+        stat = &rt_irq_stat_table[index & (RT_SCHED_STAT_IRQ_SITES - 1)];
+        if (stat->function == RT_NULL)
+        {
+            /* a new call site */
+            stat->function = rt_irq_stat_function;
+            stat->line     = rt_irq_stat_line;
+        }
+        else if (stat->function != rt_irq_stat_function ||
+                 stat->line != rt_irq_stat_line)
+        {
+            continue;
+        }
+
+        stat->count ++;
+        stat->total_time += span;
+        if (span > stat->max_time)
+            stat->max_time = span;
+
+        return;
+    }
+}
+
+/**
+ * This function will disable interrupt and start to account the interrupt
+ * lock of the call site. It's invoked by rt_hw_interrupt_disable with
+ * RT_USING_SCHED_STAT.
+ *
+ * @param function the function of call site
+ * @param line the line of call site
+ *
+ * @return the interrupt level
+ */
+rt_base_t rt_interrupt_stat_disable(const char *function, rt_uint32_t line)
+{
+    rt_base_t level;
+
+    level = (rt_hw_interrupt_disable)();
+    if (!rt_irq_stat_locked && rt_scheduler_stat_on)
+    {
+        rt_irq_stat_locked   = 1;
+        rt_irq_stat_level    = level;
+        rt_irq_stat_function = function;
+        rt_irq_stat_line     = line;
+        rt_irq_stat_stamp    = rt_hw_stat_clock();
+    }
+
+    return level;
+}
+RTM_EXPORT(rt_interrupt_stat_disable);
+
+/**
+ * This function will end the accounting of the interrupt lock if it's the
+ * outermost one, and restore the interrupt level. It's invoked by
+ * rt_hw_interrupt_enable with RT_USING_SCHED_STAT.
+ *
+ * @param level the interrupt level
+ */
+void rt_interrupt_stat_enable(rt_base_t level)
+{
+    if (rt_irq_stat_locked && level == rt_irq_stat_level)
+        _rt_interrupt_stat_account(rt_hw_stat_clock());
+
+    (rt_hw_interrupt_enable)(level);
+}
+RTM_EXPORT(rt_interrupt_stat_enable);
+
+/*
+ * This function will be invoked by the scheduler on thread switch with
+ * interrupt disabled. A thread switched away in thread context resumes with
+ * its interrupt lock held, and one switched away on leaving interrupt or
+ * never run resumes with interrupt enabled, which ends the interrupt lock.
+ */
+void rt_interrupt_stat_switch(struct rt_thread *from,
+                              struct rt_thread *to)
+{
+    if (from != RT_NULL)
+        from->sched_stat.irq_locked = (rt_interrupt_nest == 0);
+
+    if (rt_irq_stat_locked && rt_interrupt_nest == 0 && !to->sched_stat.irq_locked)
+        _rt_interrupt_stat_account(rt_hw_stat_clock());
+}
+
+/*
+ * This function will clear the interrupt lock statistics, it shall be
+ * invoked with interrupt disabled.
+ */
+void rt_interrupt_stat_reset(void)
+{
+    rt_irq_stat_locked = 0;
+    rt_memset(rt_irq_stat_table, 0, sizeof(rt_irq_stat_table));
+}
+
+/**
+ * This function will get a snapshot of the interrupt lock statistics of the
+ * call sites.
+ *
+ * @param stat the statistics array to be saved in
+ * @param size the size of array
+ *
+ * @return the number of call sites saved
+ */
+rt_uint32_t rt_interrupt_stat_get(struct rt_irq_stat *stat, rt_uint32_t size)
+{
+    rt_base_t level;
+    rt_uint32_t index, count;
+
+    RT_ASSERT(stat != RT_NULL);
+
+    count = 0;
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+    for (index = 0; index < RT_SCHED_STAT_IRQ_SITES && count < size; index ++)
+    {
+        if (rt_irq_stat_table[index].function != RT_NULL)
+            stat[count ++] = rt_irq_stat_table[index];
+    }
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+
+    return count;
+}
+RTM_EXPORT(rt_interrupt_stat_get);
+#endif
+
 /*@}*/
 
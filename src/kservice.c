@@ -122,6 +122,7 @@ int *_rt_errno(void)
 }
 RTM_EXPORT(_rt_errno);
 
+#ifndef RT_USING_CPU_MEMOPS
 /**
  * This function will set the content of memory to specified value
  *
@@ -141,35 +142,29 @@ void *rt_memset(void *s, int c, rt_ubase_t count)
 
     return s;
 #else
-#define LBLOCKSIZE      (sizeof(rt_int32_t))
-#define UNALIGNED(X)    ((rt_int32_t)X & (LBLOCKSIZE - 1))
-#define TOO_SMALL(LEN)  ((LEN) < LBLOCKSIZE)
+#define LBLOCKSIZE      (sizeof(rt_ubase_t))
+#define UNALIGNED(X)    ((rt_ubase_t)X & (LBLOCKSIZE - 1))
+#define TOO_SMALL(LEN)  ((LEN) < LBLOCKSIZE * 2)
 
-    int i;
     char *m = (char *)s;
-    rt_uint32_t buffer;
-    rt_uint32_t *aligned_addr;
-    rt_uint32_t d = c & 0xff;
+    rt_ubase_t buffer;
+    rt_ubase_t *aligned_addr;
+    rt_ubase_t d = c & 0xff;
 
-    if (!TOO_SMALL(count) && !UNALIGNED(s))
+    if (!TOO_SMALL(count))
     {
-        /* If we get this far, we know that n is large and m is word-aligned. */
-        aligned_addr = (rt_uint32_t *)s;
+        /* Set the unaligned head bytewise, then m is word-aligned. */
+        while (UNALIGNED(m))
+        {
+            *m++ = (char)d;
+            count --;
+        }
+        aligned_addr = (rt_ubase_t *)m;
 
         /* Store D into each char sized location in BUFFER so that
          * we can set large blocks quickly.
          */
-        if (LBLOCKSIZE == 4)
-        {
-            buffer = (d << 8) | d;
-            buffer |= (buffer << 16);
-        }
-        else
-        {
-            buffer = 0;
-            for (i = 0; i < LBLOCKSIZE; i ++)
-                buffer = (buffer << 8) | d;
-        }
+        buffer = d * (~(rt_ubase_t)0 / 0xff);
 
         while (count >= LBLOCKSIZE * 4)
         {
@@ -225,25 +220,30 @@ void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
     return dst;
 #else
 
-#define UNALIGNED(X, Y)                                               \
-                        (((rt_int32_t)X & (sizeof(rt_int32_t) - 1)) | \
-                         ((rt_int32_t)Y & (sizeof(rt_int32_t) - 1)))
-#define BIGBLOCKSIZE    (sizeof(rt_int32_t) << 2)
-#define LITTLEBLOCKSIZE (sizeof(rt_int32_t))
+#define LITTLEBLOCKSIZE (sizeof(rt_ubase_t))
+#define BIGBLOCKSIZE    (LITTLEBLOCKSIZE << 2)
+#define UNALIGNED(X)    ((rt_ubase_t)X & (LITTLEBLOCKSIZE - 1))
 #define TOO_SMALL(LEN)  ((LEN) < BIGBLOCKSIZE)
 
     char *dst_ptr = (char *)dst;
     char *src_ptr = (char *)src;
-    rt_int32_t *aligned_dst;
-    rt_int32_t *aligned_src;
-    int len = count;
+    rt_ubase_t *aligned_dst;
+    rt_ubase_t *aligned_src;
+    rt_ubase_t len = count;
 
-    /* If the size is small, or either SRC or DST is unaligned,
-    then punt into the byte copy loop.  This should be rare. */
-    if (!TOO_SMALL(len) && !UNALIGNED(src_ptr, dst_ptr))
+    /* If the size is small, or SRC and DST are in different alignment,
+    then punt into the byte copy loop. */
+    if (!TOO_SMALL(len) && UNALIGNED(src_ptr) == UNALIGNED(dst_ptr))
     {
-        aligned_dst = (rt_int32_t *)dst_ptr;
-        aligned_src = (rt_int32_t *)src_ptr;
+        /* Copy the unaligned head bytewise, then both are word-aligned. */
+        while (UNALIGNED(dst_ptr))
+        {
+            *dst_ptr++ = *src_ptr++;
+            len --;
+        }
+
+        aligned_dst = (rt_ubase_t *)dst_ptr;
+        aligned_src = (rt_ubase_t *)src_ptr;
 
         /* Copy 4X long words at a time if possible. */
         while (len >= BIGBLOCKSIZE)
@@ -278,6 +278,7 @@ void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
 #endif
 }
 RTM_EXPORT(rt_memcpy);
+#endif
 
 /**
  * This function will move memory content from source address to destination
@@ -311,6 +312,7 @@ void *rt_memmove(void *dest, const void *src, rt_ubase_t n)
 }
 RTM_EXPORT(rt_memmove);
 
+#ifndef RT_USING_CPU_MEMOPS
 /**
  * This function will compare two areas of memory
  *
@@ -325,13 +327,48 @@ rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_ubase_t count)
     const unsigned char *su1, *su2;
     int res = 0;
 
-    for (su1 = cs, su2 = ct; 0 < count; ++su1, ++su2, count--)
+    su1 = cs;
+    su2 = ct;
+#ifndef RT_TINY_SIZE
+#define LBLOCKSIZE      (sizeof(rt_ubase_t))
+#define UNALIGNED(X)    ((rt_ubase_t)X & (LBLOCKSIZE - 1))
+
+    if (count >= LBLOCKSIZE * 2 && UNALIGNED(su1) == UNALIGNED(su2))
+    {
+        /* Compare the unaligned head bytewise. */
+        while (UNALIGNED(su1))
+        {
+            if ((res = *su1 - *su2) != 0)
+                return res;
+            su1 ++;
+            su2 ++;
+            count --;
+        }
+
+        /* Skip the equal words, the different one is found by the
+         * byte loop below.
+         */
+        while (count >= LBLOCKSIZE &&
+               *(const rt_ubase_t *)su1 == *(const rt_ubase_t *)su2)
+        {
+            su1 += LBLOCKSIZE;
+            su2 += LBLOCKSIZE;
+            count -= LBLOCKSIZE;
+        }
+    }
+
+#undef LBLOCKSIZE
+#undef UNALIGNED
+#endif
+
+    for (; 0 < count; ++su1, ++su2, count--)
         if ((res = *su1 - *su2) != 0)
             break;
 
     return res;
 }
 RTM_EXPORT(rt_memcmp);
+#endif
 
 /**
  * This function will return the first occurrence of a string.
@@ -362,6 +362,7 @@ void *rt_malloc(rt_size_t size)
 
             RT_OBJECT_HOOK_CALL(rt_malloc_hook,
                                 (((void *)((rt_uint8_t *)mem + SIZEOF_STRUCT_MEM)), size));
+            RT_MEM_PROFILE_ALLOC((rt_uint8_t *)mem + SIZEOF_STRUCT_MEM, size);
 
             /* return the memory data except mem struct */
             return (rt_uint8_t *)mem + SIZEOF_STRUCT_MEM;
@@ -402,7 +403,12 @@ void *rt_realloc(void *rmem, rt_size_t newsize)
 
     /* allocate a new memory block */
     if (rmem == RT_NULL)
-        return rt_malloc(newsize);
+    {
+        nmem = rt_malloc(newsize);
+        RT_MEM_PROFILE_ALLOC(nmem, newsize);
+
+        return nmem;
+    }
 
     rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
 
@@ -450,6 +456,8 @@ void *rt_realloc(void *rmem, rt_size_t newsize)
 
         rt_sem_release(&heap_sem);
 
+        RT_MEM_PROFILE_ALLOC(rmem, newsize);
+
         return rmem;
     }
     rt_sem_release(&heap_sem);
@@ -461,6 +469,7 @@ void *rt_realloc(void *rmem, rt_size_t newsize)
         rt_memcpy(nmem, rmem, size < newsize ? size : newsize);
         rt_free(rmem);
     }
+    RT_MEM_PROFILE_ALLOC(nmem, newsize);
 
     return nmem;
 }
@@ -490,6 +499,7 @@ void *rt_calloc(rt_size_t count, rt_size_t size)
     /* zero the memory */
     if (p)
         rt_memset(p, 0, count * size);
+    RT_MEM_PROFILE_ALLOC(p, count * size);
 
     return p;
 }
@@ -514,6 +524,7 @@ void rt_free(void *rmem)
               (rt_uint8_t *)rmem < (rt_uint8_t *)heap_end);
 
     RT_OBJECT_HOOK_CALL(rt_free_hook, (rmem));
+    RT_MEM_PROFILE_FREE(rmem);
 
     if ((rt_uint8_t *)rmem < (rt_uint8_t *)heap_ptr ||
         (rt_uint8_t *)rmem >= (rt_uint8_t *)heap_end)
@@ -45,6 +45,157 @@
 #define RT_MEMHEAP_SIZE         RT_ALIGN(sizeof(struct rt_memheap_item), RT_ALIGN_SIZE)
 #define MEMITEM_SIZE(item)      ((rt_uint32_t)item->next - (rt_uint32_t)item - RT_MEMHEAP_SIZE)
 
+extern int __rt_ffs(int value);
+
+/*
+ * The free blocks are kept in RT_MEMHEAP_BIN_MAX lists by power-of-two size
+ * class, and the bit n of free_bitmap is set when the list n is not empty.
+ * A free block is always linked in the list of the class of its size, so it
+ * shall be removed from the list before its size is changed.
+ */
+static rt_uint32_t rt_memheap_bin(rt_uint32_t size)
+{
+    rt_uint32_t bin;
+
+    /* the most significant bit of size */
+    bin = 0;
+    if (size & 0xffff0000) { size >>= 16; bin += 16; }
+    if (size & 0xff00)     { size >>= 8;  bin += 8;  }
+    if (size & 0xf0)       { size >>= 4;  bin += 4;  }
+    if (size & 0x0c)       { size >>= 2;  bin += 2;  }
+    if (size & 0x02)       {              bin += 1;  }
+
+    /* the blocks less than 32 bytes are in the first class */
+    if (bin < 5)
+        return 0;
+    bin -= 4;
+
+    return bin < RT_MEMHEAP_BIN_MAX ? bin : RT_MEMHEAP_BIN_MAX - 1;
+}
+
+static void rt_memheap_insert_free(struct rt_memheap      *heap,
+                                   struct rt_memheap_item *item)
+{
+    rt_uint32_t bin;
+
+    bin = rt_memheap_bin(MEMITEM_SIZE(item));
+
+    /* insert to the head of free list */
+    item->prev_free = RT_NULL;
+    item->next_free = heap->free_bin[bin];
+    if (item->next_free != RT_NULL)
+        item->next_free->prev_free = item;
+    heap->free_bin[bin] = item;
+    heap->free_bitmap |= 1ul << bin;
+
+    RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
+                 ("insert to free list %d: block[0x%08x], next_free 0x%08x\n",
+                  bin, item, item->next_free));
+}
+
+static void rt_memheap_remove_free(struct rt_memheap      *heap,
+                                   struct rt_memheap_item *item)
+{
+    rt_uint32_t bin;
+
+    bin = rt_memheap_bin(MEMITEM_SIZE(item));
+
+    if (item->next_free != RT_NULL)
+        item->next_free->prev_free = item->prev_free;
+    if (item->prev_free != RT_NULL)
+        item->prev_free->next_free = item->next_free;
+    else
+    {
+        /* it's the head of free list */
+        heap->free_bin[bin] = item->next_free;
+        if (heap->free_bin[bin] == RT_NULL)
+            heap->free_bitmap &= ~(1ul << bin);
+    }
+
+    item->next_free = RT_NULL;
+    item->prev_free = RT_NULL;
+}
+
+/*
+ * find a free block which is not less than size and remove it from the free
+ * list, the blocks in a larger class are always big enough, so only when
+ * there is none of them the free list of the same class is searched.
+ */
+static struct rt_memheap_item *rt_memheap_find_free(struct rt_memheap *heap,
+                                                    rt_uint32_t        size)
+{
+    rt_uint32_t bin, bitmap;
+    struct rt_memheap_item *item;
+
+    bin  = rt_memheap_bin(size);
+    item = heap->free_bin[bin];
+
+    /* try the first block of the same class */
+    if (item == RT_NULL || MEMITEM_SIZE(item) < size)
+    {
+        bitmap = heap->free_bitmap & ~((2ul << bin) - 1);
+        if (bitmap != 0)
+        {
+            item = heap->free_bin[__rt_ffs(bitmap) - 1];
+        }
+        else
+        {
+            while (item != RT_NULL && MEMITEM_SIZE(item) < size)
+                item = item->next_free;
+        }
+    }
+
+    if (item != RT_NULL)
+        rt_memheap_remove_free(heap, item);
+
+    return item;
+}
+
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+/* the preference order of new memory heap */
+#define RT_MEMHEAP_PREFERENCE_DEFAULT   0x80
+
+/* the memory heaps sorted by preference order */
+static struct rt_memheap *_heap_order = RT_NULL;
+
+static void rt_memheap_order_insert(struct rt_memheap *heap)
+{
+    register rt_base_t level;
+    struct rt_memheap **node;
+
+    level = rt_hw_interrupt_disable();
+
+    /* insert after the heaps with the same preference */
+    for (node = &_heap_order;
+         *node != RT_NULL && (*node)->preference <= heap->preference;
+         node = &((*node)->next_heap)) ;
+    heap->next_heap = *node;
+    *node = heap;
+
+    rt_hw_interrupt_enable(level);
+}
+
+static void rt_memheap_order_remove(struct rt_memheap *heap)
+{
+    register rt_base_t level;
+    struct rt_memheap **node;
+
+    level = rt_hw_interrupt_disable();
+
+    for (node = &_heap_order; *node != RT_NULL; node = &((*node)->next_heap))
+    {
+        if (*node == heap)
+        {
+            *node = heap->next_heap;
+            break;
+        }
+    }
+    heap->next_heap = RT_NULL;
+
+    rt_hw_interrupt_enable(level);
+}
+#endif
+
 /*
  * The initialized memory pool will be:
  * +-----------------------------------+--------------------------+
@@ -73,17 +224,9 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
     memheap->available_size = memheap->pool_size - (2 * RT_MEMHEAP_SIZE);
     memheap->max_used_size  = memheap->pool_size - memheap->available_size;
 
-    /* initialize the free list header */
-    item            = &(memheap->free_header);
-    item->magic     = RT_MEMHEAP_MAGIC;
-    item->pool_ptr  = memheap;
-    item->next      = RT_NULL;
-    item->prev      = RT_NULL;
-    item->next_free = item;
-    item->prev_free = item;
-
-    /* set the free list to free list header */
-    memheap->free_list = item;
+    /* initialize the free lists */
+    memheap->free_bitmap = 0;
+    rt_memset(memheap->free_bin, 0, sizeof(memheap->free_bin));
 
     /* initialize the first big memory block */
     item            = (struct rt_memheap_item *)start_addr;
@@ -91,8 +234,8 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
     item->pool_ptr  = memheap;
     item->next      = RT_NULL;
     item->prev      = RT_NULL;
-    item->next_free = item;
-    item->prev_free = item;
+    item->next_free = RT_NULL;
+    item->prev_free = RT_NULL;
 
     item->next = (struct rt_memheap_item *)
         ((rt_uint8_t *)item + memheap->available_size + RT_MEMHEAP_SIZE);
@@ -102,10 +245,7 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
     memheap->block_list = item;
 
     /* place the big memory block to free list */
-    item->next_free = memheap->free_list->next_free;
-    item->prev_free = memheap->free_list;
-    memheap->free_list->next_free->prev_free = item;
-    memheap->free_list->next_free            = item;
+    rt_memheap_insert_free(memheap, item);
 
     /* move to the end of memory pool to build a small tailer block,
      * which prevents block merging
@@ -122,9 +262,17 @@ rt_err_t rt_memheap_init(struct rt_memheap *memheap,
     /* initialize semaphore lock */
     rt_sem_init(&(memheap->lock), name, 1, RT_IPC_FLAG_FIFO);
 
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+    /* serve the default class only, until placement is set */
+    memheap->placement  = 0;
+    memheap->preference = RT_MEMHEAP_PREFERENCE_DEFAULT;
+    rt_memset(memheap->served, 0, sizeof(memheap->served));
+    rt_memheap_order_insert(memheap);
+#endif
+
     RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                 ("memory heap: start addr 0x%08x, size %d, free list header 0x%08x\n",
-                  start_addr, size, &(memheap->free_header)));
+                 ("memory heap: start addr 0x%08x, size %d\n",
+                  start_addr, size));
 
     return RT_EOK;
 }
@@ -134,6 +282,10 @@ rt_err_t rt_memheap_detach(struct rt_memheap *heap)
 {
     RT_ASSERT(heap);
 
+#ifdef RT_USING_MEMHEAP_AS_HEAP
+    rt_memheap_order_remove(heap);
+#endif
+
     rt_object_detach(&(heap->lock.parent.parent));
     rt_object_detach(&(heap->parent));
 
@@ -142,10 +294,72 @@ rt_err_t rt_memheap_detach(struct rt_memheap *heap)
 }
 RTM_EXPORT(rt_memheap_detach);
 
+/*
+ * split the tail of a block, which is larger than size, to a new free block.
+ * The new free block is merged with its next neighbor if it's free too.
+ */
+static void rt_memheap_split(struct rt_memheap      *heap,
+                             struct rt_memheap_item *header_ptr,
+                             rt_uint32_t             size)
+{
+    struct rt_memheap_item *new_ptr;
+
+    /* don't split when there is less than one node space left */
+    if (MEMITEM_SIZE(header_ptr) < size + RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC)
+        return;
+
+    new_ptr = (struct rt_memheap_item *)
+              (((rt_uint8_t *)header_ptr) + size + RT_MEMHEAP_SIZE);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
+                 ("split: block[0x%08x] nextm[0x%08x] prevm[0x%08x] to new[0x%08x]\n",
+                  header_ptr,
+                  header_ptr->next,
+                  header_ptr->prev,
+                  new_ptr));
+
+    /* mark the new block as a memory block and freed. */
+    new_ptr->magic = RT_MEMHEAP_MAGIC;
+
+    /* put the pool pointer into the new block. */
+    new_ptr->pool_ptr = heap;
+
+    /* break down the block list */
+    new_ptr->prev          = header_ptr;
+    new_ptr->next          = header_ptr->next;
+    header_ptr->next->prev = new_ptr;
+    header_ptr->next       = new_ptr;
+
+    /* determine if the block can be merged with the next neighbor. */
+    if (!RT_MEMHEAP_IS_USED(new_ptr->next))
+    {
+        struct rt_memheap_item *free_ptr;
+
+        /* merge block with next neighbor. */
+        free_ptr = new_ptr->next;
+        heap->available_size = heap->available_size - MEMITEM_SIZE(free_ptr);
+
+        RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
+                     ("merge: right node 0x%08x, next_free 0x%08x, prev_free 0x%08x\n",
+                      free_ptr, free_ptr->next_free, free_ptr->prev_free));
+
+        /* remove free ptr from free list before its size is changed */
+        rt_memheap_remove_free(heap, free_ptr);
+
+        free_ptr->next->prev = new_ptr;
+        new_ptr->next        = free_ptr->next;
+    }
+
+    /* insert the split block to free list */
+    rt_memheap_insert_free(heap, new_ptr);
+
+    /* increment the available byte count.  */
+    heap->available_size = heap->available_size + MEMITEM_SIZE(new_ptr);
+}
+
 void *rt_memheap_alloc(struct rt_memheap *heap, rt_uint32_t size)
 {
     rt_err_t result;
-    rt_uint32_t free_size;
     struct rt_memheap_item *header_ptr;
 
     RT_ASSERT(heap != RT_NULL);
@@ -160,9 +374,6 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_uint32_t size)
 
     if (size < heap->available_size)
     {
-        /* search on free list */
-        free_size = 0;
-
         /* lock memheap */
         result = rt_sem_take(&(heap->lock), RT_WAITING_FOREVER);
         if (result != RT_EOK)
@@ -172,93 +383,20 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_uint32_t size)
             return RT_NULL;
         }
 
-        /* get the first free memory block */
-        header_ptr = heap->free_list->next_free;
-        while (header_ptr != heap->free_list && free_size < size)
-        {
-            /* get current freed memory block size */
-            free_size = MEMITEM_SIZE(header_ptr);
-            if (free_size < size)
-            {
-                /* move to next free memory block */
-                header_ptr = header_ptr->next_free;
-            }
-        }
-
-        /* determine if the memory is available. */
-        if (free_size >= size)
+        /* get a free memory block from the free lists */
+        header_ptr = rt_memheap_find_free(heap, size);
+        if (header_ptr != RT_NULL)
         {
             /* a block that satisfies the request has been found. */
 
-            /* determine if the block needs to be split. */
-            if (free_size >= (size + RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC))
-            {
-                struct rt_memheap_item *new_ptr;
-
-                /* split the block. */
-                new_ptr = (struct rt_memheap_item *)
-                          (((rt_uint8_t *)header_ptr) + size + RT_MEMHEAP_SIZE);
-
-                RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                             ("split: block[0x%08x] nextm[0x%08x] prevm[0x%08x] to new[0x%08x]\n",
-                              header_ptr,
-                              header_ptr->next,
-                              header_ptr->prev,
-                              new_ptr));
-
-                /* mark the new block as a memory block and freed. */
-                new_ptr->magic = RT_MEMHEAP_MAGIC;
-
-                /* put the pool pointer into the new block. */
-                new_ptr->pool_ptr = heap;
-
-                /* break down the block list */
-                new_ptr->prev          = header_ptr;
-                new_ptr->next          = header_ptr->next;
-                header_ptr->next->prev = new_ptr;
-                header_ptr->next       = new_ptr;
-
-                /* remove header ptr from free list */
-                header_ptr->next_free->prev_free = header_ptr->prev_free;
-                header_ptr->prev_free->next_free = header_ptr->next_free;
-                header_ptr->next_free = RT_NULL;
-                header_ptr->prev_free = RT_NULL;
-
-                /* insert new_ptr to free list */
-                new_ptr->next_free = heap->free_list->next_free;
-                new_ptr->prev_free = heap->free_list;
-                heap->free_list->next_free->prev_free = new_ptr;
-                heap->free_list->next_free            = new_ptr;
-                RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("new ptr: next_free 0x%08x, prev_free 0x%08x\n",
-                                                new_ptr->next_free,
-                                                new_ptr->prev_free));
-
-                /* decrement the available byte count.  */
-                heap->available_size = heap->available_size -
-                                       size -
-                                       RT_MEMHEAP_SIZE;
-                if (heap->pool_size - heap->available_size > heap->max_used_size)
-                    heap->max_used_size = heap->pool_size - heap->available_size;
-            }
-            else
-            {
-                /* decrement the entire free size from the available bytes count. */
-                heap->available_size = heap->available_size - free_size;
-                if (heap->pool_size - heap->available_size > heap->max_used_size)
-                    heap->max_used_size = heap->pool_size - heap->available_size;
-
-                /* remove header_ptr from free list */
-                RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                             ("one block: block[0x%08x], next_free 0x%08x, prev_free 0x%08x\n",
-                              header_ptr,
-                              header_ptr->next_free,
-                              header_ptr->prev_free));
-
-                header_ptr->next_free->prev_free = header_ptr->prev_free;
-                header_ptr->prev_free->next_free = header_ptr->next_free;
-                header_ptr->next_free = RT_NULL;
-                header_ptr->prev_free = RT_NULL;
-            }
+            /* decrement the entire free size from the available bytes count. */
+            heap->available_size = heap->available_size - MEMITEM_SIZE(header_ptr);
+
+            /* split the block, the rest is given back to the available bytes */
+            rt_memheap_split(heap, header_ptr, size);
+
+            if (heap->pool_size - heap->available_size > heap->max_used_size)
+                heap->max_used_size = heap->pool_size - heap->available_size;
 
             /* Mark the allocated block as not available. */
             header_ptr->magic |= RT_MEMHEAP_USED;
@@ -287,50 +425,24 @@ void *rt_memheap_alloc(struct rt_memheap *heap, rt_uint32_t size)
 }
 RTM_EXPORT(rt_memheap_alloc);
 
-void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
+/*
+ * resize a memory block in place, by splitting its tail or merging the free
+ * next neighbor, returns RT_NULL if the block could not be resized in place.
+ */
+static void *rt_memheap_resize(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
 {
     rt_err_t result;
     rt_size_t oldsize;
     struct rt_memheap_item *header_ptr;
-    struct rt_memheap_item *new_ptr;
-
-    if (newsize == 0)
-    {
-        rt_memheap_free(ptr);
-
-        return RT_NULL;
-    }
-    /* align allocated size */
-    newsize = RT_ALIGN(newsize, RT_ALIGN_SIZE);
-    if (newsize < RT_MEMHEAP_MINIALLOC)
-        newsize = RT_MEMHEAP_MINIALLOC;
-
-    if (ptr == RT_NULL)
-    {
-        return rt_memheap_alloc(heap, newsize);
-    }
 
     /* get memory block header and get the size of memory block */
     header_ptr = (struct rt_memheap_item *)
                  ((rt_uint8_t *)ptr - RT_MEMHEAP_SIZE);
     oldsize = MEMITEM_SIZE(header_ptr);
-     /* re-allocate memory */
-    if (newsize > oldsize)
-    {
-        void* new_ptr;
-        /* re-allocate a memory block */
-        new_ptr = (void*)rt_memheap_alloc(heap, newsize);
-        if (new_ptr != RT_NULL)
-        {
-            rt_memcpy(new_ptr, ptr, oldsize < newsize ? oldsize : newsize);
-            rt_memheap_free(ptr);
-        }
-
-        return new_ptr;
-    }
 
     /* don't split when there is less than one node space left */
-    if (newsize + RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC >= oldsize)
+    if (newsize <= oldsize &&
+        newsize + RT_MEMHEAP_SIZE + RT_MEMHEAP_MINIALLOC >= oldsize)
         return ptr;
 
     /* lock memheap */
@@ -342,60 +454,42 @@ void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
         return RT_NULL;
     }
 
-    /* split the block. */
-    new_ptr = (struct rt_memheap_item *)
-              (((rt_uint8_t *)header_ptr) + newsize + RT_MEMHEAP_SIZE);
-
-    RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                 ("split: block[0x%08x] nextm[0x%08x] prevm[0x%08x] to new[0x%08x]\n",
-                  header_ptr,
-                  header_ptr->next,
-                  header_ptr->prev,
-                  new_ptr));
-
-    /* mark the new block as a memory block and freed. */
-    new_ptr->magic = RT_MEMHEAP_MAGIC;
-    /* put the pool pointer into the new block. */
-    new_ptr->pool_ptr = heap;
-
-    /* break down the block list */
-    new_ptr->prev          = header_ptr;
-    new_ptr->next          = header_ptr->next;
-    header_ptr->next->prev = new_ptr;
-    header_ptr->next       = new_ptr;
-
-    /* determine if the block can be merged with the next neighbor. */
-    if (!RT_MEMHEAP_IS_USED(new_ptr->next))
+    if (newsize > oldsize)
     {
-        struct rt_memheap_item *free_ptr;
+        struct rt_memheap_item *next_ptr;
 
-        /* merge block with next neighbor. */
-        free_ptr = new_ptr->next;
-        heap->available_size = heap->available_size - MEMITEM_SIZE(free_ptr);
+        /* try to grow in place by merging the free next neighbor */
+        next_ptr = header_ptr->next;
+        if (RT_MEMHEAP_IS_USED(next_ptr) ||
+            oldsize + RT_MEMHEAP_SIZE + MEMITEM_SIZE(next_ptr) < newsize)
+        {
+            /* release lock */
+            rt_sem_release(&(heap->lock));
+
+            return RT_NULL;
+        }
 
         RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                     ("merge: right node 0x%08x, next_free 0x%08x, prev_free 0x%08x\n",
-                      header_ptr, header_ptr->next_free, header_ptr->prev_free));
+                     ("grow: block[0x%08x] merge right node 0x%08x\n",
+                      header_ptr, next_ptr));
 
-        free_ptr->next->prev = new_ptr;
-        new_ptr->next   = free_ptr->next;
+        heap->available_size = heap->available_size - MEMITEM_SIZE(next_ptr);
+        rt_memheap_remove_free(heap, next_ptr);
 
-        /* remove free ptr from free list */
-        free_ptr->next_free->prev_free = free_ptr->prev_free;
-        free_ptr->prev_free->next_free = free_ptr->next_free;
-    }
+        next_ptr->next->prev = header_ptr;
+        header_ptr->next     = next_ptr->next;
 
-    /* insert the split block to free list */
-    new_ptr->next_free = heap->free_list->next_free;
-    new_ptr->prev_free = heap->free_list;
-    heap->free_list->next_free->prev_free = new_ptr;
-    heap->free_list->next_free            = new_ptr;
-    RT_DEBUG_LOG(RT_DEBUG_MEMHEAP, ("new free ptr: next_free 0x%08x, prev_free 0x%08x\n",
-                                    new_ptr->next_free,
-                                    new_ptr->prev_free));
+        /* give the rest of merged block back */
+        rt_memheap_split(heap, header_ptr, newsize);
 
-    /* increment the available byte count.  */
-    heap->available_size = heap->available_size + MEMITEM_SIZE(new_ptr);
+        if (heap->pool_size - heap->available_size > heap->max_used_size)
+            heap->max_used_size = heap->pool_size - heap->available_size;
+    }
+    else
+    {
+        /* split the block. */
+        rt_memheap_split(heap, header_ptr, newsize);
+    }
 
     /* release lock */
     rt_sem_release(&(heap->lock));
@@ -403,6 +497,46 @@ void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
     /* return the old memory block */
     return ptr;
 }
+
+void *rt_memheap_realloc(struct rt_memheap *heap, void *ptr, rt_size_t newsize)
+{
+    rt_size_t oldsize;
+    struct rt_memheap_item *header_ptr;
+    void *new_ptr;
+
+    if (newsize == 0)
+    {
+        rt_memheap_free(ptr);
+
+        return RT_NULL;
+    }
+    /* align allocated size */
+    newsize = RT_ALIGN(newsize, RT_ALIGN_SIZE);
+    if (newsize < RT_MEMHEAP_MINIALLOC)
+        newsize = RT_MEMHEAP_MINIALLOC;
+
+    if (ptr == RT_NULL)
+    {
+        return rt_memheap_alloc(heap, newsize);
+    }
+
+    if (rt_memheap_resize(heap, ptr, newsize) != RT_NULL)
+        return ptr;
+
+    /* re-allocate a memory block */
+    new_ptr = (void*)rt_memheap_alloc(heap, newsize);
+    if (new_ptr != RT_NULL)
+    {
+        /* get memory block header and get the size of memory block */
+        header_ptr = (struct rt_memheap_item *)
+                     ((rt_uint8_t *)ptr - RT_MEMHEAP_SIZE);
+        oldsize = MEMITEM_SIZE(header_ptr);
+        rt_memcpy(new_ptr, ptr, oldsize < newsize ? oldsize : newsize);
+        rt_memheap_free(ptr);
+    }
+
+    return new_ptr;
+}
 RTM_EXPORT(rt_memheap_realloc);
 
 void rt_memheap_free(void *ptr)
@@ -410,13 +544,11 @@ void rt_memheap_free(void *ptr)
     rt_err_t result;
     struct rt_memheap *heap;
     struct rt_memheap_item *header_ptr, *new_ptr;
-    rt_uint32_t insert_header;
 
 	/* NULL check */
 	if (ptr == RT_NULL) return;
 
     /* set initial status as OK */
-    insert_header = 1;
     new_ptr       = RT_NULL;
     header_ptr    = (struct rt_memheap_item *)
                     ((rt_uint8_t *)ptr - RT_MEMHEAP_SIZE);
@@ -453,14 +585,15 @@ void rt_memheap_free(void *ptr)
         /* adjust the available number of bytes. */
         heap->available_size = heap->available_size + RT_MEMHEAP_SIZE;
 
+        /* the size class of previous neighbor will be changed */
+        rt_memheap_remove_free(heap, header_ptr->prev);
+
         /* yes, merge block with previous neighbor. */
         (header_ptr->prev)->next = header_ptr->next;
         (header_ptr->next)->prev = header_ptr->prev;
 
         /* move header pointer to previous. */
         header_ptr = header_ptr->prev;
-        /* don't insert header to free list */
-        insert_header = 0;
     }
 
     /* determine if the block can be merged with the next neighbor. */
@@ -476,26 +609,15 @@ void rt_memheap_free(void *ptr)
                      ("merge: right node 0x%08x, next_free 0x%08x, prev_free 0x%08x\n",
                       new_ptr, new_ptr->next_free, new_ptr->prev_free));
 
+        /* remove new ptr from free list */
+        rt_memheap_remove_free(heap, new_ptr);
+
         new_ptr->next->prev = header_ptr;
         header_ptr->next    = new_ptr->next;
-
-        /* remove new ptr from free list */
-        new_ptr->next_free->prev_free = new_ptr->prev_free;
-        new_ptr->prev_free->next_free = new_ptr->next_free;
     }
 
-    if (insert_header)
-    {
-        /* no left merge, insert to free list */
-        header_ptr->next_free = heap->free_list->next_free;
-        header_ptr->prev_free = heap->free_list;
-        heap->free_list->next_free->prev_free = header_ptr;
-        heap->free_list->next_free            = header_ptr;
-
-        RT_DEBUG_LOG(RT_DEBUG_MEMHEAP,
-                     ("insert to free list: next_free 0x%08x, prev_free 0x%08x\n",
-                      header_ptr->next_free, header_ptr->prev_free));
-    }
+    /* insert the merged block to the free list of its size class */
+    rt_memheap_insert_free(heap, header_ptr);
 
     /* release lock */
     rt_sem_release(&(heap->lock));
@@ -512,47 +634,150 @@ void rt_system_heap_init(void *begin_addr, void *end_addr)
                     "heap",
                     begin_addr,
                     (rt_uint32_t)end_addr - (rt_uint32_t)begin_addr);
+
+    /* the default system heap is tried at first */
+    rt_memheap_set_placement(&_heap, 0, 0);
 }
 
-void *rt_malloc(rt_size_t size)
+/**
+ * This function sets the placement classes served by a memory heap and its
+ * preference order in rt_malloc_ex.
+ *
+ * @param heap the memory heap
+ * @param placement the placement classes, RT_MEM_FAST, RT_MEM_DMA or RT_MEM_BULK
+ * @param preference the preference order, the heap with smaller one is tried first
+ *
+ * @return RT_EOK
+ */
+rt_err_t rt_memheap_set_placement(struct rt_memheap *heap,
+                                  rt_uint8_t         placement,
+                                  rt_uint8_t         preference)
 {
-    void* ptr;
+    RT_ASSERT(heap != RT_NULL);
 
-    /* try to allocate in system heap */
-    ptr = rt_memheap_alloc(&_heap, size);
-    if (ptr == RT_NULL)
+    /* re-sort the heap with the new preference */
+    rt_memheap_order_remove(heap);
+    heap->placement  = placement & (RT_MEM_FAST | RT_MEM_DMA | RT_MEM_BULK);
+    heap->preference = preference;
+    rt_memheap_order_insert(heap);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_memheap_set_placement);
+
+static void rt_memheap_served(struct rt_memheap *heap, rt_uint32_t flags)
+{
+    rt_uint32_t index;
+
+    if (flags == 0)
+    {
+        heap->served[0] ++;
+
+        return;
+    }
+
+    for (index = 1; index < RT_MEM_CLASS_MAX; index ++)
     {
-        struct rt_object *object;
-        struct rt_list_node *node;
-        struct rt_memheap *heap;
-        struct rt_object_information *information;
-        extern struct rt_object_information rt_object_container[];
-
-        /* try to allocate on other memory heap */
-        information = &rt_object_container[RT_Object_Class_MemHeap];
-        for (node  = information->object_list.next;
-             node != &(information->object_list);
-             node  = node->next)
+        if (flags & (1 << (index - 1)))
+            heap->served[index] ++;
+    }
+}
+
+/*
+ * allocate a memory block by placement classes, the allocation is recorded
+ * by the public function, so the profiler gets the caller of it.
+ */
+static void *rt_memheap_malloc(rt_size_t size, rt_uint32_t flags)
+{
+    void *ptr;
+    struct rt_memheap *heap;
+
+    flags &= RT_MEM_FAST | RT_MEM_DMA | RT_MEM_BULK;
+
+    /* try the heaps serving the classes */
+    for (heap = _heap_order; heap != RT_NULL; heap = heap->next_heap)
+    {
+        if ((heap->placement & flags) != flags)
+            continue;
+        /* the fast heaps are kept for the fast class */
+        if (flags == 0 && (heap->placement & RT_MEM_FAST))
+            continue;
+
+        ptr = rt_memheap_alloc(heap, size);
+        if (ptr != RT_NULL)
         {
-            object = rt_list_entry(node, struct rt_object, list);
-            heap   = (struct rt_memheap *)object;
+            rt_memheap_served(heap, flags);
 
-            /* not allocate in the default system heap */
-            if (heap == &_heap)
-                continue;
+            return ptr;
+        }
+    }
+
+    if (flags == 0 || (flags & RT_MEM_DMA))
+        return RT_NULL;
 
-            ptr = rt_memheap_alloc(heap, size);
-            if (ptr != RT_NULL)
-                break;
+    /* fall back to the other heaps */
+    for (heap = _heap_order; heap != RT_NULL; heap = heap->next_heap)
+    {
+        if ((heap->placement & flags) == flags)
+            continue;
+        if ((heap->placement & RT_MEM_FAST) && !(flags & RT_MEM_FAST))
+            continue;
+
+        ptr = rt_memheap_alloc(heap, size);
+        if (ptr != RT_NULL)
+        {
+            rt_memheap_served(heap, flags);
+
+            return ptr;
         }
     }
 
+    return RT_NULL;
+}
+
+/**
+ * This function allocates a memory block from the memory heaps by placement
+ * classes.
+ *
+ * The heaps serving all the requested classes are tried in preference order
+ * at first. Then the request falls back to the other heaps except the ones
+ * serving RT_MEM_FAST, which are kept for the fast class only. There is no
+ * fall back for RT_MEM_DMA class.
+ *
+ * Without any class, all the heaps except the ones serving RT_MEM_FAST are
+ * tried in preference order.
+ *
+ * @param size the size of memory block
+ * @param flags the placement classes, RT_MEM_FAST, RT_MEM_DMA or RT_MEM_BULK
+ *
+ * @return the allocated memory block or RT_NULL on failure
+ */
+void *rt_malloc_ex(rt_size_t size, rt_uint32_t flags)
+{
+    void *ptr;
+
+    ptr = rt_memheap_malloc(size, flags);
+    RT_MEM_PROFILE_ALLOC(ptr, size);
+
+    return ptr;
+}
+RTM_EXPORT(rt_malloc_ex);
+
+void *rt_malloc(rt_size_t size)
+{
+    void *ptr;
+
+    /* try the default system heap at first, then other memory heaps */
+    ptr = rt_memheap_malloc(size, 0);
+    RT_MEM_PROFILE_ALLOC(ptr, size);
+
     return ptr;
 }
 RTM_EXPORT(rt_malloc);
 
 void rt_free(void *rmem)
 {
+    RT_MEM_PROFILE_FREE(rmem);
     rt_memheap_free(rmem);
 }
 RTM_EXPORT(rt_free);
@@ -560,32 +785,55 @@ RTM_EXPORT(rt_free);
 void *rt_realloc(void *rmem, rt_size_t newsize)
 {
     void *new_ptr;
+    rt_size_t oldsize, size;
+    struct rt_memheap *heap;
     struct rt_memheap_item *header_ptr;
 
     if (rmem == RT_NULL)
-        return rt_malloc(newsize);
+    {
+        new_ptr = rt_memheap_malloc(newsize, 0);
+        RT_MEM_PROFILE_ALLOC(new_ptr, newsize);
+
+        return new_ptr;
+    }
+
+    if (newsize == 0)
+    {
+        rt_free(rmem);
+
+        return RT_NULL;
+    }
 
     /* get old memory item */
     header_ptr = (struct rt_memheap_item *)
                  ((rt_uint8_t *)rmem - RT_MEMHEAP_SIZE);
+    heap = header_ptr->pool_ptr;
 
-    new_ptr = rt_memheap_realloc(header_ptr->pool_ptr, rmem, newsize);
-    if (new_ptr == RT_NULL && newsize != 0)
+    /* align allocated size */
+    size = RT_ALIGN(newsize, RT_ALIGN_SIZE);
+    if (size < RT_MEMHEAP_MINIALLOC)
+        size = RT_MEMHEAP_MINIALLOC;
+
+    new_ptr = rt_memheap_resize(heap, rmem, size);
+    if (new_ptr == RT_NULL)
     {
-        /* allocate memory block from other memheap */
-        new_ptr = rt_malloc(newsize);
-        if (new_ptr != RT_NULL && rmem != RT_NULL)
-        {
-            rt_size_t oldsize;
-
-            /* get the size of old memory block */
-            oldsize = MEMITEM_SIZE(header_ptr);
-            if (newsize > oldsize)
-                rt_memcpy(new_ptr, rmem, oldsize);
-            else
-                rt_memcpy(new_ptr, rmem, newsize);
-        }
+        /*
+         * move to a new block of the same memheap or other memheap, the old
+         * block is recorded as freed by rt_free before it could be reused.
+         */
+        new_ptr = rt_memheap_alloc(heap, newsize);
+        if (new_ptr == RT_NULL)
+            new_ptr = rt_memheap_malloc(newsize, 0);
+        if (new_ptr == RT_NULL)
+            return RT_NULL;
+
+        /* get the size of old memory block */
+        oldsize = MEMITEM_SIZE(header_ptr);
+        rt_memcpy(new_ptr, rmem, oldsize < newsize ? oldsize : newsize);
+
+        rt_free(rmem);
     }
+    RT_MEM_PROFILE_ALLOC(new_ptr, newsize);
 
     return new_ptr;
 }
@@ -597,17 +845,31 @@ void *rt_calloc(rt_size_t count, rt_size_t size)
     rt_size_t total_size;
 
     total_size = count * size;
-    ptr = rt_malloc(total_size);
+    ptr = rt_memheap_malloc(total_size, 0);
     if (ptr != RT_NULL)
     {
         /* clean memory */
         rt_memset(ptr, 0, total_size);
     }
+    RT_MEM_PROFILE_ALLOC(ptr, total_size);
 
     return ptr;
 }
 RTM_EXPORT(rt_calloc);
 
+void rt_memory_info(rt_uint32_t *total,
+                    rt_uint32_t *used,
+                    rt_uint32_t *max_used)
+{
+    /* the information of the default system heap */
+    if (total != RT_NULL)
+        *total = _heap.pool_size;
+    if (used  != RT_NULL)
+        *used = _heap.pool_size - _heap.available_size;
+    if (max_used != RT_NULL)
+        *max_used = _heap.max_used_size;
+}
+
 #endif
 
 #endif
@@ -70,6 +70,104 @@ void rt_mp_free_sethook(void (*hook)(struct rt_mempool *mp, void *block))
 /*@}*/
 #endif
 
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+/*
+ * In lock-free mode, the free blocks are linked by index in a Treiber stack.
+ * free_stack keeps the index of the first free block (starting from 1, 0 is
+ * the end of stack) in the low bits and a tag in the rest high bits, which is
+ * increased on each change to avoid the ABA problem. The index takes only the
+ * bits needed by the blocks of pool, so the tag is as wide as possible.
+ */
+#define RT_MP_TAG_MIN_BITS      8
+#define RT_MP_INDEX_MASK(mp)    ((mp)->free_index_mask)
+#define RT_MP_TAG_NEXT(mp, head) (((head) & ~RT_MP_INDEX_MASK(mp)) + RT_MP_INDEX_MASK(mp) + 1)
+#define RT_MP_BLOCK(mp, index)  ((rt_uint8_t *)(mp)->start_address + \
+                                 ((index) - 1) * ((mp)->block_size + sizeof(rt_uint8_t *)))
+
+static rt_uint8_t *rt_mp_pop(struct rt_mempool *mp)
+{
+    rt_ubase_t head, next;
+    rt_uint8_t *block_ptr;
+
+    do
+    {
+        head = *(volatile rt_ubase_t *)&(mp->free_stack);
+        if ((head & RT_MP_INDEX_MASK(mp)) == 0)
+            return RT_NULL;
+
+        /*
+         * the next index is stale if the block is taken meanwhile, then the
+         * tag is changed and the swap fails.
+         */
+        block_ptr = RT_MP_BLOCK(mp, head & RT_MP_INDEX_MASK(mp));
+        next = *(volatile rt_ubase_t *)block_ptr & RT_MP_INDEX_MASK(mp);
+    } while (!rt_hw_atomic_cas(&(mp->free_stack), head, RT_MP_TAG_NEXT(mp, head) | next));
+
+    return block_ptr;
+}
+
+static void rt_mp_push(struct rt_mempool *mp, rt_uint8_t *block_ptr)
+{
+    rt_ubase_t head, index;
+
+    index = (block_ptr - (rt_uint8_t *)mp->start_address) /
+            (mp->block_size + sizeof(rt_uint8_t *)) + 1;
+
+    do
+    {
+        head = *(volatile rt_ubase_t *)&(mp->free_stack);
+        *(rt_ubase_t *)block_ptr = head & RT_MP_INDEX_MASK(mp);
+    } while (!rt_hw_atomic_cas(&(mp->free_stack), head, RT_MP_TAG_NEXT(mp, head) | index));
+}
+
+static void rt_mp_count(struct rt_mempool *mp, rt_base_t delta)
+{
+    rt_ubase_t count;
+
+    do
+    {
+        count = *(volatile rt_ubase_t *)&(mp->block_free_count);
+    } while (!rt_hw_atomic_cas(&(mp->block_free_count), count, count + delta));
+}
+#endif
+
+static void rt_mp_block_list_init(struct rt_mempool *mp)
+{
+    rt_uint8_t *block_ptr;
+    register rt_base_t offset;
+    rt_size_t block_size;
+
+    block_ptr  = (rt_uint8_t *)mp->start_address;
+    block_size = mp->block_size + sizeof(rt_uint8_t *);
+
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+    /* the least bits to index the blocks, at least RT_MP_TAG_MIN_BITS are left for tag */
+    mp->free_index_mask = 1;
+    while (mp->free_index_mask < mp->block_total_count &&
+           mp->free_index_mask < ((rt_ubase_t)-1 >> RT_MP_TAG_MIN_BITS))
+        mp->free_index_mask = (mp->free_index_mask << 1) | 1;
+    if (mp->block_total_count > mp->free_index_mask)
+        mp->block_total_count = mp->free_index_mask;
+    mp->block_free_count = mp->block_total_count;
+
+    for (offset = 0; offset < mp->block_total_count; offset ++)
+        *(rt_ubase_t *)(block_ptr + offset * block_size) = offset + 2;
+    *(rt_ubase_t *)(block_ptr + (offset - 1) * block_size) = 0;
+
+    mp->free_stack = 1;
+#else
+    for (offset = 0; offset < mp->block_total_count; offset ++)
+    {
+        *(rt_uint8_t **)(block_ptr + offset * block_size) =
+            (rt_uint8_t *)(block_ptr + (offset + 1) * block_size);
+    }
+
+    *(rt_uint8_t **)(block_ptr + (offset - 1) * block_size) = RT_NULL;
+
+    mp->block_list = block_ptr;
+#endif
+}
+
 /**
  * @addtogroup MM
  */
@@ -94,9 +192,6 @@ rt_err_t rt_mp_init(struct rt_mempool *mp,
                     rt_size_t          size,
                     rt_size_t          block_size)
 {
-    rt_uint8_t *block_ptr;
-    register rt_base_t offset;
-
     /* parameter check */
     RT_ASSERT(mp != RT_NULL);
 
@@ -120,17 +215,7 @@ rt_err_t rt_mp_init(struct rt_mempool *mp,
     mp->suspend_thread_count = 0;
 
     /* initialize free block list */
-    block_ptr = (rt_uint8_t *)mp->start_address;
-    for (offset = 0; offset < mp->block_total_count; offset ++)
-    {
-        *(rt_uint8_t **)(block_ptr + offset * (block_size + sizeof(rt_uint8_t *))) =
-            (rt_uint8_t *)(block_ptr + (offset + 1) * (block_size + sizeof(rt_uint8_t *)));
-    }
-
-    *(rt_uint8_t **)(block_ptr + (offset - 1) * (block_size + sizeof(rt_uint8_t *))) =
-        RT_NULL;
-
-    mp->block_list = block_ptr;
+    rt_mp_block_list_init(mp);
 
     return RT_EOK;
 }
@@ -198,9 +283,7 @@ rt_mp_t rt_mp_create(const char *name,
                      rt_size_t   block_count,
                      rt_size_t   block_size)
 {
-    rt_uint8_t *block_ptr;
     struct rt_mempool *mp;
-    register rt_base_t offset;
 
     RT_DEBUG_NOT_IN_INTERRUPT;
 
@@ -234,17 +317,7 @@ rt_mp_t rt_mp_create(const char *name,
     mp->suspend_thread_count = 0;
 
     /* initialize free block list */
-    block_ptr = (rt_uint8_t *)mp->start_address;
-    for (offset = 0; offset < mp->block_total_count; offset ++)
-    {
-        *(rt_uint8_t **)(block_ptr + offset * (block_size + sizeof(rt_uint8_t *)))
-            = block_ptr + (offset + 1) * (block_size + sizeof(rt_uint8_t *));
-    }
-
-    *(rt_uint8_t **)(block_ptr + (offset - 1) * (block_size + sizeof(rt_uint8_t *)))
-        = RT_NULL;
-
-    mp->block_list = block_ptr;
+    rt_mp_block_list_init(mp);
 
     return mp;
 }
@@ -310,6 +383,171 @@ rt_err_t rt_mp_delete(rt_mp_t mp)
 RTM_EXPORT(rt_mp_delete);
 #endif
 
+#ifdef RT_USING_MEMPOOL_LOCKFREE
+static rt_uint8_t *rt_mp_alloc_wait(rt_mp_t mp, rt_int32_t time)
+{
+    rt_uint8_t *block_ptr;
+    register rt_base_t level;
+    struct rt_thread *thread;
+    rt_tick_t tick;
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* get current thread */
+    thread = rt_thread_self();
+
+    while (1)
+    {
+        /* disable interrupt */
+        level = rt_hw_interrupt_disable();
+
+        /* a block may be released before interrupt is disabled */
+        block_ptr = rt_mp_pop(mp);
+        if (block_ptr != RT_NULL || time == 0)
+        {
+            /* enable interrupt */
+            rt_hw_interrupt_enable(level);
+
+            return block_ptr;
+        }
+
+        /* need suspend thread */
+        rt_thread_suspend(thread);
+        rt_list_insert_after(&(mp->suspend_thread), &(thread->tlist));
+        mp->suspend_thread_count ++;
+
+        tick = rt_tick_get();
+        if (time > 0)
+        {
+            /* init thread timer and start it */
+            rt_timer_control(&(thread->thread_timer),
+                             RT_TIMER_CTRL_SET_TIME,
+                             &time);
+            rt_timer_start(&(thread->thread_timer));
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(level);
+
+        /* do a schedule */
+        rt_schedule();
+
+        if (thread->error != RT_EOK)
+            return RT_NULL;
+
+        /*
+         * the released block may be taken by an interrupt before this
+         * thread runs, then wait for the remaining time.
+         */
+        if (time > 0)
+        {
+            tick = rt_tick_get() - tick;
+            time = ((rt_int32_t)tick < time) ? time - (rt_int32_t)tick : 0;
+        }
+    }
+}
+
+/**
+ * This function will allocate a block from memory pool. Without waiting
+ * thread, the block is taken without disabling interrupt.
+ *
+ * @param mp the memory pool object
+ * @param time the waiting time
+ *
+ * @return the allocated memory block or RT_NULL on allocated failed
+ */
+void *rt_mp_alloc(rt_mp_t mp, rt_int32_t time)
+{
+    rt_uint8_t *block_ptr;
+
+    block_ptr = rt_mp_pop(mp);
+    if (block_ptr == RT_NULL)
+    {
+        /* memory block is unavailable. */
+        if (time == 0)
+            return RT_NULL;
+
+        block_ptr = rt_mp_alloc_wait(mp, time);
+        if (block_ptr == RT_NULL)
+            return RT_NULL;
+    }
+
+    /* decrease the free block counter */
+    rt_mp_count(mp, -1);
+
+    /* point to memory pool */
+    *(rt_uint8_t **)block_ptr = (rt_uint8_t *)mp;
+
+    RT_OBJECT_HOOK_CALL(rt_mp_alloc_hook,
+                        (mp, (rt_uint8_t *)(block_ptr + sizeof(rt_uint8_t *))));
+
+    return (rt_uint8_t *)(block_ptr + sizeof(rt_uint8_t *));
+}
+RTM_EXPORT(rt_mp_alloc);
+
+/**
+ * This function will release a memory block. Without suspended thread, the
+ * block is released without disabling interrupt.
+ *
+ * @param block the address of memory block to be released
+ */
+void rt_mp_free(void *block)
+{
+    rt_uint8_t **block_ptr;
+    struct rt_mempool *mp;
+    struct rt_thread *thread;
+    register rt_base_t level;
+
+    /* get the control block of pool which the block belongs to */
+    block_ptr = (rt_uint8_t **)((rt_uint8_t *)block - sizeof(rt_uint8_t *));
+    mp        = (struct rt_mempool *)*block_ptr;
+
+    RT_OBJECT_HOOK_CALL(rt_mp_free_hook, (mp, block));
+
+    /* increase the free block count and link the block into the stack */
+    rt_mp_count(mp, 1);
+    rt_mp_push(mp, (rt_uint8_t *)block_ptr);
+
+    /*
+     * check the suspended thread after the block is pushed, a thread
+     * suspended before it finds the block, or it's resumed here.
+     */
+    if (mp->suspend_thread_count > 0)
+    {
+        /* disable interrupt */
+        level = rt_hw_interrupt_disable();
+
+        if (mp->suspend_thread_count > 0)
+        {
+            /* get the suspended thread */
+            thread = rt_list_entry(mp->suspend_thread.next,
+                                   struct rt_thread,
+                                   tlist);
+
+            /* set error */
+            thread->error = RT_EOK;
+
+            /* resume thread */
+            rt_thread_resume(thread);
+
+            /* decrease suspended thread count */
+            mp->suspend_thread_count --;
+
+            /* enable interrupt */
+            rt_hw_interrupt_enable(level);
+
+            /* do a schedule */
+            rt_schedule();
+
+            return;
+        }
+
+        /* enable interrupt */
+        rt_hw_interrupt_enable(level);
+    }
+}
+RTM_EXPORT(rt_mp_free);
+#else
 /**
  * This function will allocate a block from memory pool
  *
@@ -461,6 +699,7 @@ void rt_mp_free(void *block)
     rt_hw_interrupt_enable(level);
 }
 RTM_EXPORT(rt_mp_free);
+#endif
 
 /*@}*/
 
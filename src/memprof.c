@@ -0,0 +1,440 @@
+/*
+ * File      : memprof.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Heap allocation profiler.
+ *
+ * The heap backends record each allocation with the return address of its
+ * caller by RT_MEM_PROFILE_ALLOC, and each release by RT_MEM_PROFILE_FREE.
+ *
+ * The allocations are counted in call sites, which are keyed by the caller
+ * and the current thread in a hash table of RT_MEM_PROFILER_SITES entries.
+ * The live blocks are kept in another hash table of RT_MEM_PROFILER_BLOCKS
+ * entries, so the released bytes are given back to the call site which
+ * allocated them. Both tables are fixed size and never allocate from heap.
+ *
+ * A block recorded twice, such as by rt_calloc over rt_malloc, is moved to
+ * the call site of the last record.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#if defined(RT_USING_HEAP) && defined(RT_USING_MEM_PROFILER)
+
+#ifndef RT_MEM_PROFILER_SITES
+#define RT_MEM_PROFILER_SITES       64
+#endif
+#ifndef RT_MEM_PROFILER_BLOCKS
+#define RT_MEM_PROFILER_BLOCKS      512
+#endif
+
+#if (RT_MEM_PROFILER_SITES & (RT_MEM_PROFILER_SITES - 1)) || \
+    (RT_MEM_PROFILER_BLOCKS & (RT_MEM_PROFILER_BLOCKS - 1))
+#error "the sizes of memory profiler tables shall be powers of two"
+#endif
+
+#define MEM_PROFILE_HASH(key)       \
+    ((((rt_uint32_t)(key) >> 2) * 2654435761u) >> 16)
+
+/* the name of a call site is never empty */
+#define MEM_PROFILE_SITE_USED(site) ((site)->name[0] != '\0')
+
+struct mem_profile_block
+{
+    void        *ptr;                   /* the block, RT_NULL for empty entry */
+    rt_uint32_t  size;                  /* the recorded size */
+    rt_uint16_t  site;                  /* the index of call site */
+};
+
+static struct rt_mem_profile_site _site[RT_MEM_PROFILER_SITES];
+static struct mem_profile_block _block[RT_MEM_PROFILER_BLOCKS];
+static rt_uint32_t _site_count, _dropped, _untracked;
+
+static rt_uint32_t mem_profile_histogram(rt_uint32_t size)
+{
+    rt_uint32_t index, limit;
+
+    for (index = 0, limit = 16;
+         index < RT_MEM_PROFILE_HISTOGRAM - 1 && size > limit;
+         index ++, limit <<= 1) ;
+
+    return index;
+}
+
+/* find or create the call site, the interrupt shall be disabled */
+static rt_int32_t mem_profile_site(void *caller, rt_thread_t thread)
+{
+    struct rt_mem_profile_site *site;
+    rt_uint32_t index, probe;
+
+    index = MEM_PROFILE_HASH((rt_uint32_t)caller ^ (rt_uint32_t)thread);
+    for (probe = 0; probe < RT_MEM_PROFILER_SITES; probe ++)
+    {
+        index &= RT_MEM_PROFILER_SITES - 1;
+        site = &_site[index];
+
+        /* an empty entry, create the call site */
+        if (!MEM_PROFILE_SITE_USED(site))
+        {
+            site->caller = caller;
+            site->thread = thread;
+            if (thread != RT_NULL && thread->name[0] != '\0')
+                rt_strncpy(site->name, thread->name, RT_NAME_MAX);
+            else
+                rt_strncpy(site->name, "-", RT_NAME_MAX);
+            _site_count ++;
+
+            return index;
+        }
+
+        if (site->caller == caller && site->thread == thread)
+            return index;
+
+        index ++;
+    }
+
+    return -1;
+}
+
+/* find the live block, the interrupt shall be disabled */
+static rt_int32_t mem_profile_block(void *ptr)
+{
+    rt_uint32_t index, probe;
+
+    index = MEM_PROFILE_HASH(ptr);
+    for (probe = 0; probe < RT_MEM_PROFILER_BLOCKS; probe ++)
+    {
+        index &= RT_MEM_PROFILER_BLOCKS - 1;
+        if (_block[index].ptr == ptr)
+            return index;
+        if (_block[index].ptr == RT_NULL)
+            break;
+
+        index ++;
+    }
+
+    return -1;
+}
+
+/* remove the live block, the interrupt shall be disabled */
+static void mem_profile_block_remove(rt_uint32_t index)
+{
+    rt_uint32_t next, home;
+
+    /* shift the following blocks back, so there is no hole in probing */
+    next = index;
+    while (1)
+    {
+        next = (next + 1) & (RT_MEM_PROFILER_BLOCKS - 1);
+        if (_block[next].ptr == RT_NULL)
+            break;
+
+        home = MEM_PROFILE_HASH(_block[next].ptr) & (RT_MEM_PROFILER_BLOCKS - 1);
+        if (index <= next ? (index < home && home <= next)
+                          : (index < home || home <= next))
+            continue;
+
+        _block[index] = _block[next];
+        index = next;
+    }
+
+    _block[index].ptr = RT_NULL;
+}
+
+/**
+ * This function records an allocated block to the call site of caller and
+ * current thread. It's invoked by heap backends.
+ *
+ * @param ptr the allocated block
+ * @param size the size of block
+ * @param caller the return address of allocation
+ */
+void rt_mem_profile_alloc(void *ptr, rt_size_t size, void *caller)
+{
+    register rt_base_t level;
+    struct rt_mem_profile_site *site;
+    rt_int32_t index, block;
+    rt_uint32_t probe;
+
+    if (ptr == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+
+    /* the block is recorded again, take it back from the last call site */
+    block = mem_profile_block(ptr);
+    if (block >= 0)
+    {
+        site = &_site[_block[block].site];
+        site->alloc_count --;
+        site->live_bytes -= _block[block].size;
+        site->histogram[mem_profile_histogram(_block[block].size)] --;
+
+        mem_profile_block_remove(block);
+    }
+
+    index = mem_profile_site(caller, rt_thread_self());
+    if (index < 0)
+    {
+        _dropped ++;
+        rt_hw_interrupt_enable(level);
+
+        return;
+    }
+
+    site = &_site[index];
+    site->alloc_count ++;
+    site->histogram[mem_profile_histogram(size)] ++;
+
+    /* track the live block until it's released */
+    block = MEM_PROFILE_HASH(ptr);
+    for (probe = 0; probe < RT_MEM_PROFILER_BLOCKS; probe ++)
+    {
+        block &= RT_MEM_PROFILER_BLOCKS - 1;
+        if (_block[block].ptr == RT_NULL)
+        {
+            _block[block].ptr  = ptr;
+            _block[block].size = size;
+            _block[block].site = index;
+
+            site->live_bytes += size;
+            if (site->live_bytes > site->peak_bytes)
+                site->peak_bytes = site->live_bytes;
+            break;
+        }
+
+        block ++;
+    }
+    if (probe == RT_MEM_PROFILER_BLOCKS)
+        _untracked ++;
+
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_mem_profile_alloc);
+
+/**
+ * This function records a released block to the call site which allocated
+ * it. It's invoked by heap backends.
+ *
+ * @param ptr the released block
+ */
+void rt_mem_profile_free(void *ptr)
+{
+    register rt_base_t level;
+    struct rt_mem_profile_site *site;
+    rt_int32_t block;
+
+    if (ptr == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+
+    block = mem_profile_block(ptr);
+    if (block >= 0)
+    {
+        site = &_site[_block[block].site];
+        site->free_count ++;
+        site->live_bytes -= _block[block].size;
+
+        mem_profile_block_remove(block);
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_mem_profile_free);
+
+/**
+ * This function clears all the call sites and live blocks.
+ */
+void rt_mem_profile_reset(void)
+{
+    register rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    rt_memset(_site, 0, sizeof(_site));
+    rt_memset(_block, 0, sizeof(_block));
+    _site_count = _dropped = _untracked = 0;
+
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_mem_profile_reset);
+
+/**
+ * This function dumps the profile in binary, a struct rt_mem_profile_header
+ * followed by the records of struct rt_mem_profile_site.
+ *
+ * @param write the function to write out the data, which returns the size
+ *              written
+ * @param parameter the parameter of write function
+ *
+ * @return the size of dumped data
+ */
+rt_size_t rt_mem_profile_dump(rt_size_t (*write)(const void *buffer,
+                                                 rt_size_t   size,
+                                                 void       *parameter),
+                              void *parameter)
+{
+    register rt_base_t level;
+    struct rt_mem_profile_header header;
+    struct rt_mem_profile_site site;
+    rt_uint32_t index;
+    rt_size_t length;
+
+    RT_ASSERT(write != RT_NULL);
+
+    level = rt_hw_interrupt_disable();
+    header.magic      = RT_MEM_PROFILE_MAGIC;
+    header.version    = RT_MEM_PROFILE_VERSION;
+    header.site_size  = sizeof(struct rt_mem_profile_site);
+    header.site_count = _site_count;
+    header.dropped    = _dropped;
+    header.untracked  = _untracked;
+    rt_hw_interrupt_enable(level);
+
+    length = write(&header, sizeof(header), parameter);
+    if (length != sizeof(header))
+        return length;
+
+    for (index = 0; index < RT_MEM_PROFILER_SITES && header.site_count > 0; index ++)
+    {
+        /* take a snapshot of call site */
+        level = rt_hw_interrupt_disable();
+        site = _site[index];
+        rt_hw_interrupt_enable(level);
+
+        if (!MEM_PROFILE_SITE_USED(&site))
+            continue;
+
+        if (write(&site, sizeof(site), parameter) != sizeof(site))
+            break;
+        length += sizeof(site);
+        header.site_count --;
+    }
+
+    return length;
+}
+RTM_EXPORT(rt_mem_profile_dump);
+
+#ifdef RT_USING_FINSH
+#ifdef RT_USING_DFS
+#include <dfs_posix.h>
+#endif
+#include <finsh.h>
+
+void list_memprof(void)
+{
+    struct rt_mem_profile_site *site;
+    rt_uint32_t index;
+
+    rt_kprintf("caller     thread   alloc    free     live     peak\n");
+    rt_kprintf("---------- -------- -------- -------- -------- --------\n");
+    for (index = 0; index < RT_MEM_PROFILER_SITES; index ++)
+    {
+        site = &_site[index];
+        if (!MEM_PROFILE_SITE_USED(site))
+            continue;
+
+        rt_kprintf("0x%08x %-8.*s %-8d %-8d %-8d %-8d\n",
+                   site->caller, RT_NAME_MAX, site->name,
+                   site->alloc_count, site->free_count,
+                   site->live_bytes, site->peak_bytes);
+    }
+    rt_kprintf("%d sites, %d allocations dropped, %d untracked\n",
+               _site_count, _dropped, _untracked);
+}
+FINSH_FUNCTION_EXPORT(list_memprof, list heap allocation profile of call sites)
+
+static rt_size_t memprof_hex_write(const void *buffer, rt_size_t size, void *parameter)
+{
+    const rt_uint8_t *ptr;
+    rt_uint32_t *column;
+    rt_size_t index;
+
+    ptr = (const rt_uint8_t *)buffer;
+    column = (rt_uint32_t *)parameter;
+    for (index = 0; index < size; index ++)
+    {
+        rt_kprintf("%02x", ptr[index]);
+        if (++ *column == 32)
+        {
+            rt_kprintf("\n");
+            *column = 0;
+        }
+    }
+
+    return size;
+}
+
+#ifdef RT_USING_DFS
+static rt_size_t memprof_file_write(const void *buffer, rt_size_t size, void *parameter)
+{
+    int length;
+
+    length = write(*(int *)parameter, buffer, size);
+
+    return length < 0 ? 0 : length;
+}
+#endif
+
+/* dump the binary profile to a file, or to console in hex without file */
+void memprof_dump(const char *path)
+{
+    rt_uint32_t column;
+    rt_size_t length;
+
+#ifdef RT_USING_DFS
+    if (path != RT_NULL)
+    {
+        int fd;
+
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0);
+        if (fd < 0)
+        {
+            rt_kprintf("open %s failed\n", path);
+
+            return;
+        }
+
+        length = rt_mem_profile_dump(memprof_file_write, &fd);
+        close(fd);
+        rt_kprintf("%d bytes dumped to %s\n", length, path);
+
+        return;
+    }
+#endif
+
+    column = 0;
+    length = rt_mem_profile_dump(memprof_hex_write, &column);
+    if (column != 0)
+        rt_kprintf("\n");
+    rt_kprintf("%d bytes dumped\n", length);
+}
+FINSH_FUNCTION_EXPORT(memprof_dump, dump heap allocation profile to file or console)
+
+void memprof_reset(void)
+{
+    rt_mem_profile_reset();
+}
+FINSH_FUNCTION_EXPORT(memprof_reset, clear heap allocation profile)
+#endif
+
+#endif
@@ -76,6 +76,96 @@ struct rt_object_information rt_object_container[RT_Object_Class_Unknown] =
 #endif
 };
 
+#ifdef RT_USING_OBJECT_HASH
+#ifndef RT_OBJECT_HASH_SIZE
+#define RT_OBJECT_HASH_SIZE     16
+#endif
+#if (RT_OBJECT_HASH_SIZE & (RT_OBJECT_HASH_SIZE - 1)) != 0
+#error "RT_OBJECT_HASH_SIZE must be a power of two"
+#endif
+
+/* name hash index of the objects in object container */
+static rt_list_t rt_object_hash_table[RT_Object_Class_Unknown][RT_OBJECT_HASH_SIZE];
+static rt_uint8_t rt_object_hash_inited = 0;
+
+/*
+ * This function will calculate the hash of an object name, only the first
+ * RT_NAME_MAX characters are used as same as the name comparison.
+ */
+rt_inline rt_uint32_t rt_object_hash(const char *name)
+{
+    register rt_uint32_t hash;
+    register rt_ubase_t index;
+
+    hash = 5381;
+    for (index = 0; index < RT_NAME_MAX && name[index] != '\0'; index ++)
+        hash = (hash << 5) + hash + (rt_uint8_t)name[index];
+
+    return hash & (RT_OBJECT_HASH_SIZE - 1);
+}
+
+/*
+ * This function will insert an object to the name hash index of its class,
+ * it shall be invoked with interrupt disabled.
+ */
+static void rt_object_hash_insert(struct rt_object            *object,
+                                  struct rt_object_information *information)
+{
+    register rt_ubase_t type, index;
+
+    rt_list_init(&(object->hash_list));
+
+    /* only the objects in object container are indexed */
+    type = information->type;
+    if (information != &rt_object_container[type])
+        return;
+
+    if (!rt_object_hash_inited)
+    {
+        for (type = 0; type < RT_Object_Class_Unknown; type ++)
+        {
+            for (index = 0; index < RT_OBJECT_HASH_SIZE; index ++)
+                rt_list_init(&(rt_object_hash_table[type][index]));
+        }
+        rt_object_hash_inited = 1;
+        type = information->type;
+    }
+
+    /* the latest object is found first as same as the object list */
+    rt_list_insert_after(&(rt_object_hash_table[type][rt_object_hash(object->name)]),
+                         &(object->hash_list));
+}
+
+/**
+ * This function will find the object by name in the name hash index. It's
+ * used by the object finding functions which have locked the scheduler.
+ *
+ * @param name the specified name of object.
+ * @param type the type of object
+ *
+ * @return the found object or RT_NULL if there is no this object
+ * in object container.
+ */
+rt_object_t rt_object_hash_find(const char *name, rt_uint8_t type)
+{
+    struct rt_object *object;
+    struct rt_list_node *node, *list;
+
+    if (!rt_object_hash_inited || type >= RT_Object_Class_Unknown)
+        return RT_NULL;
+
+    list = &(rt_object_hash_table[type][rt_object_hash(name)]);
+    for (node = list->next; node != list; node = node->next)
+    {
+        object = rt_list_entry(node, struct rt_object, hash_list);
+        if (rt_strncmp(object->name, name, RT_NAME_MAX) == 0)
+            return object;
+    }
+
+    return RT_NULL;
+}
+#endif
+
 #ifdef RT_USING_HOOK
 static void (*rt_object_attach_hook)(struct rt_object *object);
 static void (*rt_object_detach_hook)(struct rt_object *object);
@@ -232,6 +322,10 @@ void rt_object_init(struct rt_object         *object,
 
     /* insert object into information object list */
     rt_list_insert_after(&(information->object_list), &(object->list));
+#ifdef RT_USING_OBJECT_HASH
+    /* insert object into name hash index */
+    rt_object_hash_insert(object, information);
+#endif
 
     /* unlock interrupt */
     rt_hw_interrupt_enable(temp);
@@ -257,12 +351,158 @@ void rt_object_detach(rt_object_t object)
 
     /* remove from old list */
     rt_list_remove(&(object->list));
+#ifdef RT_USING_OBJECT_HASH
+    rt_list_remove(&(object->hash_list));
+#endif
 
     /* unlock interrupt */
     rt_hw_interrupt_enable(temp);
 }
 
 #ifdef RT_USING_HEAP
+#ifdef RT_USING_OBJECT_CACHE
+#ifndef RT_USING_MEMPOOL
+#error "RT_USING_OBJECT_CACHE requires RT_USING_MEMPOOL"
+#endif
+#ifndef RT_OBJECT_CACHE_RESERVE
+#define RT_OBJECT_CACHE_RESERVE 4
+#endif
+
+/* object cache of each object class in object container */
+static struct rt_object_cache rt_object_cache[RT_Object_Class_Unknown];
+
+/**
+ * This function will set up the object cache of an object class, the objects
+ * of this class are allocated from the cache until the warm reserve is used
+ * up, and then from the heap.
+ *
+ * If the object cache is not set up before the first object of the class is
+ * allocated, it's set up with RT_OBJECT_CACHE_RESERVE objects.
+ *
+ * @param type the type of object
+ * @param reserve the number of objects in warm reserve
+ *
+ * @return the error code, -RT_EBUSY if the object cache has been set up.
+ */
+rt_err_t rt_object_cache_setup(enum rt_object_class_type type, rt_size_t reserve)
+{
+    struct rt_object_cache *cache;
+    register rt_base_t temp;
+    rt_size_t block_size, size;
+    void *start;
+
+    RT_ASSERT(type < RT_Object_Class_Unknown);
+    RT_ASSERT(reserve != 0);
+
+    cache = &rt_object_cache[type];
+
+    /* lock interrupt */
+    temp = rt_hw_interrupt_disable();
+    if (cache->reserve != 0)
+    {
+        /* unlock interrupt */
+        rt_hw_interrupt_enable(temp);
+
+        return -RT_EBUSY;
+    }
+    /* objects are allocated from heap until the cache is ready */
+    cache->reserve = reserve;
+    /* unlock interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    block_size = RT_ALIGN(rt_object_container[type].object_size, RT_ALIGN_SIZE);
+    size = reserve * (block_size + sizeof(rt_uint8_t *));
+    start = RT_KERNEL_MALLOC(size);
+    if (start == RT_NULL)
+    {
+        /* no memory can be allocated */
+        return -RT_ENOMEM;
+    }
+
+    rt_mp_init(&(cache->pool), "objcache", start, size, block_size);
+    cache->ready = 1;
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_object_cache_setup);
+
+/**
+ * This function will get the object cache of an object class.
+ *
+ * @param type the type of object
+ *
+ * @return the object cache, RT_NULL if it's not ready.
+ */
+struct rt_object_cache *rt_object_cache_get(enum rt_object_class_type type)
+{
+    if (type >= RT_Object_Class_Unknown || !rt_object_cache[type].ready)
+        return RT_NULL;
+
+    return &rt_object_cache[type];
+}
+RTM_EXPORT(rt_object_cache_get);
+
+/*
+ * This function will allocate an object from the object cache of its class,
+ * or from the heap if the warm reserve is used up.
+ */
+static struct rt_object *rt_object_cache_alloc(enum rt_object_class_type type)
+{
+    struct rt_object_cache *cache;
+    struct rt_object *object;
+    rt_size_t used;
+
+#ifdef RT_USING_MODULE
+    /* module objects are seldom allocated, which are not cached */
+    if (type == RT_Object_Class_Module)
+        return (struct rt_object *)RT_KERNEL_MALLOC(rt_object_container[type].object_size);
+#endif
+
+    cache = &rt_object_cache[type];
+    if (cache->reserve == 0)
+        rt_object_cache_setup(type, RT_OBJECT_CACHE_RESERVE);
+
+    object = RT_NULL;
+    if (cache->ready)
+        object = (struct rt_object *)rt_mp_alloc(&(cache->pool), 0);
+
+    if (object == RT_NULL)
+    {
+        cache->miss ++;
+
+        return (struct rt_object *)RT_KERNEL_MALLOC(rt_object_container[type].object_size);
+    }
+
+    cache->hit ++;
+    used = cache->pool.block_total_count - cache->pool.block_free_count;
+    if (used > cache->peak)
+        cache->peak = used;
+
+    return object;
+}
+
+/*
+ * This function will free an object to the object cache of its class if it's
+ * allocated from the cache, or to the heap.
+ */
+static void rt_object_cache_free(struct rt_object *object)
+{
+    struct rt_object_cache *cache;
+
+    cache = &rt_object_cache[object->type];
+    if (cache->ready &&
+        (rt_uint8_t *)object >= (rt_uint8_t *)cache->pool.start_address &&
+        (rt_uint8_t *)object < (rt_uint8_t *)cache->pool.start_address + cache->pool.size)
+    {
+        rt_mp_free(object);
+
+        return;
+    }
+
+    RT_KERNEL_FREE(object);
+}
+#endif
+
 /**
  * This function will allocate an object from object system
  *
@@ -291,6 +531,12 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
     information = &rt_object_container[type];
 #endif
 
+#ifdef RT_USING_OBJECT_CACHE
+    /* only the objects in object container are cached */
+    if (information == &rt_object_container[type])
+        object = rt_object_cache_alloc(type);
+    else
+#endif
     object = (struct rt_object *)RT_KERNEL_MALLOC(information->object_size);
     if (object == RT_NULL)
     {
@@ -324,6 +570,10 @@ rt_object_t rt_object_allocate(enum rt_object_class_type type, const char *name)
 
     /* insert object into information object list */
     rt_list_insert_after(&(information->object_list), &(object->list));
+#ifdef RT_USING_OBJECT_HASH
+    /* insert object into name hash index */
+    rt_object_hash_insert(object, information);
+#endif
 
     /* unlock interrupt */
     rt_hw_interrupt_enable(temp);
@@ -352,6 +602,9 @@ void rt_object_delete(rt_object_t object)
 
     /* remove from old list */
     rt_list_remove(&(object->list));
+#ifdef RT_USING_OBJECT_HASH
+    rt_list_remove(&(object->hash_list));
+#endif
 
     /* unlock interrupt */
     rt_hw_interrupt_enable(temp);
@@ -361,9 +614,13 @@ void rt_object_delete(rt_object_t object)
         rt_module_free((rt_module_t)object->module_id, object);
     else
 #endif
-
+#ifdef RT_USING_OBJECT_CACHE
+    /* free the memory of object to object cache or heap */
+    rt_object_cache_free(object);
+#else
     /* free the memory of object */
     RT_KERNEL_FREE(object);
+#endif
 }
 #endif
 
@@ -402,8 +659,10 @@ rt_bool_t rt_object_is_systemobject(rt_object_t object)
 rt_object_t rt_object_find(const char *name, rt_uint8_t type)
 {
     struct rt_object *object;
+#ifndef RT_USING_OBJECT_HASH
     struct rt_list_node *node;
     struct rt_object_information *information;
+#endif
     extern volatile rt_uint8_t rt_interrupt_nest;
 
     /* parameter check */
@@ -417,6 +676,15 @@ rt_object_t rt_object_find(const char *name, rt_uint8_t type)
     /* enter critical */
     rt_enter_critical();
 
+#ifdef RT_USING_OBJECT_HASH
+    /* try to find object in name hash index */
+    object = rt_object_hash_find(name, type);
+
+    /* leave critical */
+    rt_exit_critical();
+
+    return object;
+#else
     /* try to find object */
     information = &rt_object_container[type];
     for (node  = information->object_list.next;
@@ -437,6 +705,7 @@ rt_object_t rt_object_find(const char *name, rt_uint8_t type)
     rt_exit_critical();
 
     return RT_NULL;
+#endif
 }
 
 /*@}*/
@@ -112,6 +112,56 @@ static void _rt_scheduler_stack_check(struct rt_thread *thread)
 }
 #endif
 
+#ifdef RT_USING_SCHED_STAT
+extern void rt_interrupt_stat_switch(struct rt_thread *from,
+                                     struct rt_thread *to);
+extern void rt_interrupt_stat_reset(void);
+
+/* the statistics are collected, which is set by rt_scheduler_stat_enable */
+rt_uint8_t rt_scheduler_stat_on = 1;
+
+static rt_uint32_t rt_scheduler_lock_stamp;
+static rt_uint32_t rt_scheduler_lock_max;
+
+/*
+ * This function will account a thread switch in the scheduler statistics, it
+ * shall be invoked with interrupt disabled.
+ */
+static void _rt_scheduler_stat_switch(struct rt_thread *from_thread,
+                                      struct rt_thread *to_thread)
+{
+    rt_uint32_t now, latency;
+
+    /* hand over the interrupt lock to the thread switched to */
+    rt_interrupt_stat_switch(from_thread, to_thread);
+
+    /* the clock is not read while the statistics are stopped */
+    if (!rt_scheduler_stat_on)
+        return;
+
+    now = rt_hw_stat_clock();
+
+    if (from_thread != RT_NULL)
+    {
+        from_thread->sched_stat.run_time += now - from_thread->sched_stat.run_stamp;
+
+        /* switched away while it's ready, it's preempted or yielded */
+        if (from_thread->stat == RT_THREAD_READY)
+        {
+            from_thread->sched_stat.preempt_count ++;
+            from_thread->sched_stat.ready_stamp = now;
+        }
+    }
+
+    latency = now - to_thread->sched_stat.ready_stamp;
+    if (latency > to_thread->sched_stat.max_latency)
+        to_thread->sched_stat.max_latency = latency;
+
+    to_thread->sched_stat.switch_count ++;
+    to_thread->sched_stat.run_stamp = now;
+}
+#endif
+
 /**
  * @ingroup SystemInit
  * This function will initialize the system scheduler
@@ -171,6 +221,10 @@ void rt_system_scheduler_start(void)
 
     rt_current_thread = to_thread;
 
+#ifdef RT_USING_SCHED_STAT
+    _rt_scheduler_stat_switch(RT_NULL, to_thread);
+#endif
+
     /* switch to new thread */
     rt_hw_context_switch_to((rt_uint32_t)&to_thread->sp);
 
@@ -218,12 +272,20 @@ void rt_schedule(void)
         /* if the destination thread is not the same as current thread */
         if (to_thread != rt_current_thread)
         {
+#ifdef RT_USING_TICKLESS
+            /* catch up the ticks before leaving the tickless idle thread */
+            rt_tick_resume();
+#endif
             rt_current_priority = (rt_uint8_t)highest_ready_priority;
             from_thread         = rt_current_thread;
             rt_current_thread   = to_thread;
 
             RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (from_thread, to_thread));
 
+#ifdef RT_USING_SCHED_STAT
+            _rt_scheduler_stat_switch(from_thread, to_thread);
+#endif
+
             /* switch to new thread */
             RT_DEBUG_LOG(RT_DEBUG_SCHEDULER,
                          ("[%d]switch to priority#%d thread:%s\n",
@@ -273,6 +335,12 @@ void rt_schedule_insert_thread(struct rt_thread *thread)
     /* change stat */
     thread->stat = RT_THREAD_READY;
 
+#ifdef RT_USING_SCHED_STAT
+    /* the ready to run latency starts */
+    if (rt_scheduler_stat_on)
+        thread->sched_stat.ready_stamp = rt_hw_stat_clock();
+#endif
+
     /* insert thread to ready list */
     rt_list_insert_before(&(rt_thread_priority_table[thread->current_priority]),
                           &(thread->tlist));
@@ -362,6 +430,11 @@ void rt_enter_critical(void)
      */
     rt_scheduler_lock_nest ++;
 
+#ifdef RT_USING_SCHED_STAT
+    if (rt_scheduler_lock_nest == 1 && rt_scheduler_stat_on)
+        rt_scheduler_lock_stamp = rt_hw_stat_clock();
+#endif
+
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
 }
@@ -372,6 +445,9 @@ void rt_enter_critical(void)
 void rt_exit_critical(void)
 {
     register rt_base_t level;
+#ifdef RT_USING_SCHED_STAT
+    rt_uint32_t span;
+#endif
 
     /* disable interrupt */
     level = rt_hw_interrupt_disable();
@@ -381,6 +457,17 @@ void rt_exit_critical(void)
     if (rt_scheduler_lock_nest <= 0)
     {
         rt_scheduler_lock_nest = 0;
+
+#ifdef RT_USING_SCHED_STAT
+        /* the time of scheduler locked */
+        if (rt_scheduler_stat_on)
+        {
+            span = rt_hw_stat_clock() - rt_scheduler_lock_stamp;
+            if (span > rt_scheduler_lock_max)
+                rt_scheduler_lock_max = span;
+        }
+#endif
+
         /* enable interrupt */
         rt_hw_interrupt_enable(level);
 
@@ -393,5 +480,99 @@ void rt_exit_critical(void)
     }
 }
 
+#ifdef RT_USING_SCHED_STAT
+/**
+ * This function will get a snapshot of the scheduler statistics of a thread.
+ *
+ * @param thread the thread
+ * @param stat the statistics to be saved in
+ */
+void rt_thread_sched_stat(rt_thread_t thread, struct rt_sched_stat *stat)
+{
+    register rt_base_t level;
+
+    RT_ASSERT(thread != RT_NULL);
+    RT_ASSERT(stat != RT_NULL);
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    *stat = thread->sched_stat;
+    /* the run time of current thread is not accounted yet */
+    if (thread == rt_current_thread && rt_scheduler_stat_on)
+        stat->run_time += rt_hw_stat_clock() - stat->run_stamp;
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_thread_sched_stat);
+
+/**
+ * This function will return the max time of the thread scheduler locked by
+ * rt_enter_critical.
+ *
+ * @return the max time of scheduler locked
+ */
+rt_uint32_t rt_scheduler_lock_time(void)
+{
+    return rt_scheduler_lock_max;
+}
+RTM_EXPORT(rt_scheduler_lock_time);
+
+/**
+ * This function will reset the scheduler statistics of all threads.
+ */
+void rt_scheduler_stat_reset(void)
+{
+    register rt_base_t level;
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    struct rt_thread *thread;
+    rt_uint32_t now;
+
+    information = rt_object_get_information(RT_Object_Class_Thread);
+
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    now = rt_hw_stat_clock();
+    for (node = information->object_list.next;
+         node != &(information->object_list);
+         node = node->next)
+    {
+        thread = rt_list_entry(node, struct rt_thread, list);
+
+        thread->sched_stat.switch_count  = 0;
+        thread->sched_stat.preempt_count = 0;
+        thread->sched_stat.run_time      = 0;
+        thread->sched_stat.max_latency   = 0;
+        thread->sched_stat.ready_stamp   = now;
+        thread->sched_stat.run_stamp     = now;
+    }
+    rt_scheduler_lock_max   = 0;
+    rt_scheduler_lock_stamp = now;
+    rt_interrupt_stat_reset();
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_scheduler_stat_reset);
+
+/**
+ * This function will start or stop collecting the scheduler statistics, the
+ * statistics are reset when started. They are collected from system startup.
+ *
+ * @param enable RT_TRUE to start and RT_FALSE to stop
+ */
+void rt_scheduler_stat_enable(rt_bool_t enable)
+{
+    if (enable)
+        rt_scheduler_stat_reset();
+
+    rt_scheduler_stat_on = enable ? 1 : 0;
+}
+RTM_EXPORT(rt_scheduler_stat_enable);
+#endif
+
 /*@}*/
 
@@ -468,6 +468,305 @@ rt_inline int zoneindex(rt_uint32_t *bytes)
     return 0;
 }
 
+/*
+ * take a chunk from the zones of index zi, the heap shall be locked.
+ */
+static slab_chunk *slab_chunk_alloc(rt_int32_t zi, rt_size_t size)
+{
+    slab_zone *z;
+    slab_chunk *chunk;
+
+    if ((z = zone_array[zi]) == RT_NULL)
+        return RT_NULL;
+
+    RT_ASSERT(z->z_nfree > 0);
+
+    /* Remove us from the zone_array[] when we become empty */
+    if (--z->z_nfree == 0)
+    {
+        zone_array[zi] = z->z_next;
+        z->z_next = RT_NULL;
+    }
+
+    /*
+     * No chunks are available but nfree said we had some memory, so
+     * it must be available in the never-before-used-memory area
+     * governed by uindex.  The consequences are very serious if our zone
+     * got corrupted so we use an explicit rt_kprintf rather then a KASSERT.
+     */
+    if (z->z_uindex + 1 != z->z_nmax)
+    {
+        z->z_uindex = z->z_uindex + 1;
+        chunk = (slab_chunk *)(z->z_baseptr + z->z_uindex * size);
+    }
+    else
+    {
+        /* find on free chunk list */
+        chunk = z->z_freechunk;
+
+        /* remove this chunk from list */
+        z->z_freechunk = z->z_freechunk->c_next;
+    }
+
+#ifdef RT_MEM_STATS
+    used_mem += z->z_chunksize;
+    if (used_mem > max_mem)
+        max_mem = used_mem;
+#endif
+
+    return chunk;
+}
+
+/*
+ * give a chunk back to its zone, the heap shall be locked. It returns the
+ * zone which shall be released to page allocator after the heap is unlocked.
+ */
+static slab_zone *slab_chunk_free(slab_chunk *chunk)
+{
+    slab_zone *z;
+    struct memusage *kup;
+
+    kup = btokup((rt_uint32_t)chunk & ~RT_MM_PAGE_MASK);
+
+    /* zone case. get out zone. */
+    z = (slab_zone *)(((rt_uint32_t)chunk & ~RT_MM_PAGE_MASK) -
+                      kup->size * RT_MM_PAGE_SIZE);
+    RT_ASSERT(z->z_magic == ZALLOC_SLAB_MAGIC);
+
+    chunk->c_next  = z->z_freechunk;
+    z->z_freechunk = chunk;
+
+#ifdef RT_MEM_STATS
+    used_mem -= z->z_chunksize;
+#endif
+
+    /*
+     * Bump the number of free chunks.  If it becomes non-zero the zone
+     * must be added back onto the appropriate list.
+     */
+    if (z->z_nfree++ == 0)
+    {
+        z->z_next = zone_array[z->z_zoneindex];
+        zone_array[z->z_zoneindex] = z;
+    }
+
+    /*
+     * If the zone becomes totally free, and there are other zones we
+     * can allocate from, move this zone to the FreeZones list.  Since
+     * this code can be called from an IPI callback, do *NOT* try to mess
+     * with kernel_map here.  Hysteresis will be performed at malloc() time.
+     */
+    if (z->z_nfree == z->z_nmax &&
+        (z->z_next || zone_array[z->z_zoneindex] != z))
+    {
+        slab_zone **pz;
+
+        RT_DEBUG_LOG(RT_DEBUG_SLAB, ("free zone 0x%x\n",
+                                     (rt_uint32_t)z, z->z_zoneindex));
+
+        /* remove zone from zone array list */
+        for (pz = &zone_array[z->z_zoneindex]; z != *pz; pz = &(*pz)->z_next)
+            ;
+        *pz = z->z_next;
+
+        /* reset zone */
+        z->z_magic = -1;
+
+        /* insert to free zone list */
+        z->z_next = zone_free;
+        zone_free = z;
+
+        ++ zone_free_cnt;
+
+        /* release zone to page allocator */
+        if (zone_free_cnt > ZONE_RELEASE_THRESH)
+        {
+            register rt_base_t i;
+
+            z         = zone_free;
+            zone_free = z->z_next;
+            -- zone_free_cnt;
+
+            /* set message usage */
+            for (i = 0, kup = btokup(z); i < zone_page_cnt; i ++)
+            {
+                kup->type = PAGE_TYPE_FREE;
+                kup->size = 0;
+                kup ++;
+            }
+
+            return z;
+        }
+    }
+
+    return RT_NULL;
+}
+
+#ifdef RT_USING_SLAB_MAGAZINE
+/*
+ * The magazines cache the recently freed chunks of the smallest zones, the
+ * threads in the same priority band share one magazine, which is protected
+ * by disabling interrupt instead of the heap lock. The chunks in magazines
+ * are counted as used memory.
+ *
+ * On an empty magazine, it's refilled with half of RT_SLAB_MAGAZINE_SIZE
+ * chunks in one heap lock; on a full magazine, the older half of chunks are
+ * flushed back to the zones in one heap lock.
+ */
+#ifndef RT_SLAB_MAGAZINE_SIZE
+#define RT_SLAB_MAGAZINE_SIZE   8
+#endif
+#ifndef RT_SLAB_MAGAZINE_BAND
+#define RT_SLAB_MAGAZINE_BAND   4
+#endif
+
+#define MAGAZINE_ZONES          8   /* zones of 8 to 64 bytes chunk */
+
+struct slab_magazine
+{
+    slab_chunk  *chunk[MAGAZINE_ZONES];     /* cached chunks of each zone */
+    rt_uint16_t  count[MAGAZINE_ZONES];     /* number of cached chunks */
+
+    rt_uint32_t  hit[MAGAZINE_ZONES];       /* allocations from magazine */
+    rt_uint32_t  miss[MAGAZINE_ZONES];      /* allocations from zones */
+};
+static struct slab_magazine magazine[RT_SLAB_MAGAZINE_BAND];
+
+rt_inline struct slab_magazine *slab_magazine_self(void)
+{
+    rt_thread_t thread;
+
+    /* scheduler is not started */
+    thread = rt_thread_self();
+    if (thread == RT_NULL)
+        return &magazine[0];
+
+    return &magazine[thread->current_priority * RT_SLAB_MAGAZINE_BAND /
+                     RT_THREAD_PRIORITY_MAX];
+}
+
+static slab_chunk *slab_magazine_alloc(rt_int32_t zi)
+{
+    register rt_base_t level;
+    struct slab_magazine *mag;
+    slab_chunk *chunk;
+
+    level = rt_hw_interrupt_disable();
+
+    mag = slab_magazine_self();
+    chunk = mag->chunk[zi];
+    if (chunk != RT_NULL)
+    {
+        mag->chunk[zi] = chunk->c_next;
+        mag->count[zi] --;
+        mag->hit[zi] ++;
+    }
+    else
+    {
+        mag->miss[zi] ++;
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    return chunk;
+}
+
+/*
+ * refill the magazine from the zones of index zi, the heap shall be locked.
+ */
+static void slab_magazine_refill(rt_int32_t zi, rt_size_t size)
+{
+    register rt_base_t level;
+    struct slab_magazine *mag;
+    slab_chunk *chunk, *list, *tail;
+    rt_uint32_t count;
+
+    list = tail = RT_NULL;
+    for (count = 0; count < RT_SLAB_MAGAZINE_SIZE / 2; count ++)
+    {
+        chunk = slab_chunk_alloc(zi, size);
+        if (chunk == RT_NULL)
+            break;
+
+        chunk->c_next = list;
+        list = chunk;
+        if (tail == RT_NULL)
+            tail = chunk;
+    }
+
+    if (list == RT_NULL)
+        return;
+
+    level = rt_hw_interrupt_disable();
+
+    mag = slab_magazine_self();
+    tail->c_next = mag->chunk[zi];
+    mag->chunk[zi] = list;
+    mag->count[zi] += count;
+
+    rt_hw_interrupt_enable(level);
+}
+
+static void slab_magazine_free(slab_chunk *chunk, rt_int32_t zi)
+{
+    register rt_base_t level;
+    struct slab_magazine *mag;
+    slab_chunk *list;
+    slab_zone *z, *release;
+    rt_uint32_t index;
+
+    level = rt_hw_interrupt_disable();
+
+    mag = slab_magazine_self();
+    chunk->c_next = mag->chunk[zi];
+    mag->chunk[zi] = chunk;
+    if (++ mag->count[zi] < RT_SLAB_MAGAZINE_SIZE)
+    {
+        rt_hw_interrupt_enable(level);
+
+        return;
+    }
+
+    /* keep the recently freed half of chunks and flush the others */
+    for (index = 1; index < RT_SLAB_MAGAZINE_SIZE / 2; index ++)
+        chunk = chunk->c_next;
+    list = chunk->c_next;
+    chunk->c_next = RT_NULL;
+    mag->count[zi] = RT_SLAB_MAGAZINE_SIZE / 2;
+
+    rt_hw_interrupt_enable(level);
+
+    /* lock heap */
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
+
+    release = RT_NULL;
+    while (list != RT_NULL)
+    {
+        chunk = list;
+        list  = list->c_next;
+
+        z = slab_chunk_free(chunk);
+        if (z != RT_NULL)
+        {
+            z->z_next = release;
+            release   = z;
+        }
+    }
+
+    /* unlock heap */
+    rt_sem_release(&heap_sem);
+
+    /* release pages */
+    while (release != RT_NULL)
+    {
+        z = release;
+        release = release->z_next;
+
+        rt_page_free(z, zone_size / RT_MM_PAGE_SIZE);
+    }
+}
+#endif
+
 /**
  * @addtogroup MM
  */
@@ -535,9 +834,6 @@ void *rt_malloc(rt_size_t size)
         goto done;
     }
 
-    /* lock heap */
-    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
-
     /*
      * Attempt to allocate out of an existing zone.  First try the free list,
      * then allocate out of unallocated space.  If we find a good zone move
@@ -549,43 +845,31 @@ void *rt_malloc(rt_size_t size)
     zi = zoneindex(&size);
     RT_ASSERT(zi < NZONES);
 
-    RT_DEBUG_LOG(RT_DEBUG_SLAB, ("try to malloc 0x%x on zone: %d\n", size, zi));
-
-    if ((z = zone_array[zi]) != RT_NULL)
+#ifdef RT_USING_SLAB_MAGAZINE
+    if (zi < MAGAZINE_ZONES)
     {
-        RT_ASSERT(z->z_nfree > 0);
-
-        /* Remove us from the zone_array[] when we become empty */
-        if (--z->z_nfree == 0)
+        /* try the magazine without heap lock */
+        chunk = slab_magazine_alloc(zi);
+        if (chunk != RT_NULL)
         {
-            zone_array[zi] = z->z_next;
-            z->z_next = RT_NULL;
-        }
+            RT_OBJECT_HOOK_CALL(rt_malloc_hook, ((char *)chunk, size));
+            RT_MEM_PROFILE_ALLOC(chunk, size);
 
-        /*
-         * No chunks are available but nfree said we had some memory, so
-         * it must be available in the never-before-used-memory area
-         * governed by uindex.  The consequences are very serious if our zone
-         * got corrupted so we use an explicit rt_kprintf rather then a KASSERT.
-         */
-        if (z->z_uindex + 1 != z->z_nmax)
-        {
-            z->z_uindex = z->z_uindex + 1;
-            chunk = (slab_chunk *)(z->z_baseptr + z->z_uindex * size);
+            return chunk;
         }
-        else
-        {
-            /* find on free chunk list */
-            chunk = z->z_freechunk;
+    }
+#endif
 
-            /* remove this chunk from list */
-            z->z_freechunk = z->z_freechunk->c_next;
-        }
+    /* lock heap */
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
 
-#ifdef RT_MEM_STATS
-        used_mem += z->z_chunksize;
-        if (used_mem > max_mem)
-            max_mem = used_mem;
+    RT_DEBUG_LOG(RT_DEBUG_SLAB, ("try to malloc 0x%x on zone: %d\n", size, zi));
+
+    if ((chunk = slab_chunk_alloc(zi, size)) != RT_NULL)
+    {
+#ifdef RT_USING_SLAB_MAGAZINE
+        if (zi < MAGAZINE_ZONES)
+            slab_magazine_refill(zi, size);
 #endif
 
         goto done;
@@ -668,12 +952,18 @@ void *rt_malloc(rt_size_t size)
         if (used_mem > max_mem)
             max_mem = used_mem;
 #endif
+
+#ifdef RT_USING_SLAB_MAGAZINE
+        if (zi < MAGAZINE_ZONES)
+            slab_magazine_refill(zi, size);
+#endif
     }
 
 done:
     rt_sem_release(&heap_sem);
 
     RT_OBJECT_HOOK_CALL(rt_malloc_hook, ((char *)chunk, size));
+    RT_MEM_PROFILE_ALLOC(chunk, size);
 
     return chunk;
 
@@ -699,7 +989,12 @@ void *rt_realloc(void *ptr, rt_size_t size)
     struct memusage *kup;
 
     if (ptr == RT_NULL)
-        return rt_malloc(size);
+    {
+        nptr = rt_malloc(size);
+        RT_MEM_PROFILE_ALLOC(nptr, size);
+
+        return nptr;
+    }
     if (size == 0)
     {
         rt_free(ptr);
@@ -726,6 +1021,7 @@ void *rt_realloc(void *ptr, rt_size_t size)
             return RT_NULL;
         rt_memcpy(nptr, ptr, size > osize ? osize : size);
         rt_free(ptr);
+        RT_MEM_PROFILE_ALLOC(nptr, size);
 
         return nptr;
     }
@@ -749,6 +1045,7 @@ void *rt_realloc(void *ptr, rt_size_t size)
 
         rt_memcpy(nptr, ptr, size > z->z_chunksize ? z->z_chunksize : size);
         rt_free(ptr);
+        RT_MEM_PROFILE_ALLOC(nptr, size);
 
         return nptr;
     }
@@ -779,6 +1076,7 @@ void *rt_calloc(rt_size_t count, rt_size_t size)
     /* zero the memory */
     if (p)
         rt_memset(p, 0, count * size);
+    RT_MEM_PROFILE_ALLOC(p, count * size);
 
     return p;
 }
@@ -793,7 +1091,6 @@ RTM_EXPORT(rt_calloc);
 void rt_free(void *ptr)
 {
     slab_zone *z;
-    slab_chunk *chunk;
     struct memusage *kup;
 
     /* free a RT_NULL pointer */
@@ -801,6 +1098,7 @@ void rt_free(void *ptr)
         return ;
 
     RT_OBJECT_HOOK_CALL(rt_free_hook, (ptr));
+    RT_MEM_PROFILE_FREE(ptr);
 
 #ifdef RT_USING_MODULE
     if(rt_module_self() != RT_NULL)
@@ -850,88 +1148,31 @@ void rt_free(void *ptr)
         return;
     }
 
-    /* lock heap */
-    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
-
-    /* zone case. get out zone. */
+#ifdef RT_USING_SLAB_MAGAZINE
     z = (slab_zone *)(((rt_uint32_t)ptr & ~RT_MM_PAGE_MASK) -
                       kup->size * RT_MM_PAGE_SIZE);
     RT_ASSERT(z->z_magic == ZALLOC_SLAB_MAGIC);
 
-    chunk          = (slab_chunk *)ptr;
-    chunk->c_next  = z->z_freechunk;
-    z->z_freechunk = chunk;
-
-#ifdef RT_MEM_STATS
-    used_mem -= z->z_chunksize;
-#endif
-
-    /*
-     * Bump the number of free chunks.  If it becomes non-zero the zone
-     * must be added back onto the appropriate list.
-     */
-    if (z->z_nfree++ == 0)
+    /* cache the chunk in the magazine without heap lock */
+    if (z->z_zoneindex < MAGAZINE_ZONES)
     {
-        z->z_next = zone_array[z->z_zoneindex];
-        zone_array[z->z_zoneindex] = z;
-    }
-
-    /*
-     * If the zone becomes totally free, and there are other zones we
-     * can allocate from, move this zone to the FreeZones list.  Since
-     * this code can be called from an IPI callback, do *NOT* try to mess
-     * with kernel_map here.  Hysteresis will be performed at malloc() time.
-     */
-    if (z->z_nfree == z->z_nmax &&
-        (z->z_next || zone_array[z->z_zoneindex] != z))
-    {
-        slab_zone **pz;
+        slab_magazine_free((slab_chunk *)ptr, z->z_zoneindex);
 
-        RT_DEBUG_LOG(RT_DEBUG_SLAB, ("free zone 0x%x\n",
-                                     (rt_uint32_t)z, z->z_zoneindex));
-
-        /* remove zone from zone array list */
-        for (pz = &zone_array[z->z_zoneindex]; z != *pz; pz = &(*pz)->z_next)
-            ;
-        *pz = z->z_next;
-
-        /* reset zone */
-        z->z_magic = -1;
-
-        /* insert to free zone list */
-        z->z_next = zone_free;
-        zone_free = z;
-
-        ++ zone_free_cnt;
-
-        /* release zone to page allocator */
-        if (zone_free_cnt > ZONE_RELEASE_THRESH)
-        {
-            register rt_base_t i;
-
-            z         = zone_free;
-            zone_free = z->z_next;
-            -- zone_free_cnt;
-
-            /* set message usage */
-            for (i = 0, kup = btokup(z); i < zone_page_cnt; i ++)
-            {
-                kup->type = PAGE_TYPE_FREE;
-                kup->size = 0;
-                kup ++;
-            }
+        return;
+    }
+#endif
 
-            /* unlock heap */
-            rt_sem_release(&heap_sem);
+    /* lock heap */
+    rt_sem_take(&heap_sem, RT_WAITING_FOREVER);
 
-            /* release pages */
-            rt_page_free(z, zone_size / RT_MM_PAGE_SIZE);
+    z = slab_chunk_free((slab_chunk *)ptr);
 
-            return;
-        }
-    }
     /* unlock heap */
     rt_sem_release(&heap_sem);
+
+    /* release zone pages */
+    if (z != RT_NULL)
+        rt_page_free(z, zone_size / RT_MM_PAGE_SIZE);
 }
 RTM_EXPORT(rt_free);
 
@@ -963,6 +1204,32 @@ FINSH_FUNCTION_EXPORT(list_mem, list memory usage information)
 #endif
 #endif
 
+#if defined(RT_USING_SLAB_MAGAZINE) && defined(RT_USING_FINSH)
+#include <finsh.h>
+
+void list_magazine(void)
+{
+    rt_uint32_t band, zi, cached, hit, miss;
+
+    rt_kprintf("chunk cached hit        miss\n");
+    rt_kprintf("----- ------ ---------- ----------\n");
+    for (zi = 0; zi < MAGAZINE_ZONES; zi ++)
+    {
+        cached = hit = miss = 0;
+        for (band = 0; band < RT_SLAB_MAGAZINE_BAND; band ++)
+        {
+            cached += magazine[band].count[zi];
+            hit    += magazine[band].hit[zi];
+            miss   += magazine[band].miss[zi];
+        }
+
+        rt_kprintf("%-5d %-6d %-10d %-10d\n",
+                   (zi + 1) * MIN_CHUNK_SIZE, cached, hit, miss);
+    }
+}
+FINSH_FUNCTION_EXPORT(list_magazine, list slab magazine hit and miss of each zone)
+#endif
+
 /*@}*/
 
 #endif
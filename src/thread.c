@@ -124,6 +124,20 @@ static rt_err_t _rt_thread_init(struct rt_thread *thread,
     thread->cleanup   = 0;
     thread->user_data = 0;
 
+#ifdef RT_USING_SCHED_STAT
+    /* clear scheduler statistics */
+    rt_memset(&(thread->sched_stat), 0, sizeof(thread->sched_stat));
+#endif
+
+#ifdef RT_USING_STACK_SAMPLER
+    /* no stack is known to be used before sampled */
+    thread->stack_scan = (rt_ubase_t *)RT_ALIGN((rt_ubase_t)thread->stack_addr,
+                                                sizeof(rt_ubase_t));
+    thread->stack_mark = (rt_ubase_t *)RT_ALIGN_DOWN((rt_ubase_t)thread->stack_addr +
+                                                     thread->stack_size,
+                                                     sizeof(rt_ubase_t));
+#endif
+
     /* init thread timer */
     rt_timer_init(&(thread->thread_timer),
                   thread->name,
@@ -670,16 +684,32 @@ RTM_EXPORT(rt_thread_timeout);
  */
 rt_thread_t rt_thread_find(char *name)
 {
-    struct rt_object_information *information;
     struct rt_object *object;
+#ifndef RT_USING_OBJECT_HASH
+    struct rt_object_information *information;
     struct rt_list_node *node;
+#endif
 
+#ifdef RT_USING_OBJECT_HASH
+    extern rt_object_t rt_object_hash_find(const char *name, rt_uint8_t type);
+#else
     extern struct rt_object_information rt_object_container[];
+#endif
 
     /* enter critical */
     if (rt_thread_self() != RT_NULL)
         rt_enter_critical();
 
+#ifdef RT_USING_OBJECT_HASH
+    /* try to find thread object in name hash index */
+    object = rt_object_hash_find(name, RT_Object_Class_Thread);
+
+    /* leave critical */
+    if (rt_thread_self() != RT_NULL)
+        rt_exit_critical();
+
+    return (rt_thread_t)object;
+#else
     /* try to find device object */
     information = &rt_object_container[RT_Object_Class_Thread];
     for (node  = information->object_list.next;
@@ -703,7 +733,82 @@ rt_thread_t rt_thread_find(char *name)
 
     /* not found */
     return RT_NULL;
+#endif
 }
 RTM_EXPORT(rt_thread_find);
 
+#ifdef RT_USING_STACK_SAMPLER
+/* the '#' fill pattern of thread stack in one word */
+#define STACK_FILL_WORD     ((~(rt_ubase_t)0 / 0xff) * '#')
+
+/**
+ * This function scans the thread stack from its bottom for the deepest used
+ * word, at most count words are checked in one call and the next call
+ * resumes the scan. When the scan reaches the deepest used word known
+ * before, a round is done and the next round starts from the bottom again.
+ *
+ * @param thread the thread to be scanned
+ * @param count the max numbers of words to be checked
+ *
+ * @return RT_TRUE if a round of scan is done
+ */
+rt_bool_t rt_thread_stack_scan(rt_thread_t thread, rt_size_t count)
+{
+    rt_ubase_t *ptr;
+
+    RT_ASSERT(thread != RT_NULL);
+
+    for (ptr = thread->stack_scan; ptr < thread->stack_mark; ptr ++)
+    {
+        if (count == 0)
+        {
+            thread->stack_scan = ptr;
+
+            return RT_FALSE;
+        }
+        count --;
+
+        /* the words above the first used word are not scanned */
+        if (*ptr != STACK_FILL_WORD)
+        {
+            thread->stack_mark = ptr;
+            break;
+        }
+    }
+
+    /* start a new round from the bottom */
+    thread->stack_scan = (rt_ubase_t *)RT_ALIGN((rt_ubase_t)thread->stack_addr,
+                                                sizeof(rt_ubase_t));
+
+    return RT_TRUE;
+}
+RTM_EXPORT(rt_thread_stack_scan);
+
+/**
+ * This function returns the max stack size ever used by a thread, the
+ * current round of scan is finished at once.
+ *
+ * @param thread the thread
+ *
+ * @return the max used stack size
+ */
+rt_size_t rt_thread_stack_used(rt_thread_t thread)
+{
+    rt_size_t used;
+
+    RT_ASSERT(thread != RT_NULL);
+
+    rt_enter_critical();
+
+    while (rt_thread_stack_scan(thread, thread->stack_size) == RT_FALSE) ;
+    used = (rt_uint8_t *)thread->stack_addr + thread->stack_size -
+           (rt_uint8_t *)thread->stack_mark;
+
+    rt_exit_critical();
+
+    return used;
+}
+RTM_EXPORT(rt_thread_stack_used);
+#endif
+
 /*@}*/
@@ -33,8 +33,39 @@
 #include <rtthread.h>
 #include <rthw.h>
 
+#ifdef RT_USING_TIMER_WHEEL
+#ifndef RT_TIMER_WHEEL_BITS
+#define RT_TIMER_WHEEL_BITS            6
+#endif
+
+#define RT_TIMER_WHEEL_SIZE            (1UL << RT_TIMER_WHEEL_BITS)
+#define RT_TIMER_WHEEL_MASK            (RT_TIMER_WHEEL_SIZE - 1)
+/* the number of levels to cover the whole 32bit tick */
+#define RT_TIMER_WHEEL_LEVEL           ((32 + RT_TIMER_WHEEL_BITS - 1) / RT_TIMER_WHEEL_BITS)
+
+/*
+ * hierarchical timing wheel
+ *
+ * Each level has RT_TIMER_WHEEL_SIZE slots and one slot on level n covers
+ * 2^(n * RT_TIMER_WHEEL_BITS) ticks. When the index of a level wraps around,
+ * the timers in the next slot of the upper level are cascaded down, so all
+ * the timers in the current slot of level 0 are timeout.
+ */
+struct rt_timer_wheel
+{
+    rt_tick_t   tick;                                   /* the next tick to be handled */
+    rt_uint32_t count;                                  /* the number of timers on the wheel */
+    rt_uint8_t  inited;                                 /* slots are initialized */
+
+    rt_list_t   slot[RT_TIMER_WHEEL_LEVEL][RT_TIMER_WHEEL_SIZE];
+};
+
+/* hard timer wheel */
+static struct rt_timer_wheel rt_timer_wheel;
+#else
 /* hard timer list */
 static rt_list_t rt_timer_list = RT_LIST_OBJECT_INIT(rt_timer_list);
+#endif
 
 #ifdef RT_USING_TIMER_SOFT
 #ifndef RT_TIMER_THREAD_STACK_SIZE
@@ -45,8 +76,13 @@ static rt_list_t rt_timer_list = RT_LIST_OBJECT_INIT(rt_timer_list);
 #define RT_TIMER_THREAD_PRIO           0
 #endif
 
+#ifdef RT_USING_TIMER_WHEEL
+/* soft timer wheel */
+static struct rt_timer_wheel rt_soft_timer_wheel;
+#else
 /* soft timer list */
 static rt_list_t rt_soft_timer_list;
+#endif
 static struct rt_thread timer_thread;
 ALIGN(RT_ALIGN_SIZE)
 static rt_uint8_t timer_thread_stack[RT_TIMER_THREAD_STACK_SIZE];
@@ -99,6 +135,236 @@ static void _rt_timer_init(rt_timer_t timer,
     rt_list_init(&(timer->list));
 }
 
+#ifdef RT_USING_TIMER_WHEEL
+static void rt_timer_wheel_init(struct rt_timer_wheel *wheel)
+{
+    rt_ubase_t level, index;
+
+    for (level = 0; level < RT_TIMER_WHEEL_LEVEL; level ++)
+    {
+        for (index = 0; index < RT_TIMER_WHEEL_SIZE; index ++)
+            rt_list_init(&(wheel->slot[level][index]));
+    }
+
+    wheel->tick   = rt_tick_get();
+    wheel->count  = 0;
+    wheel->inited = 1;
+}
+
+/* move all the nodes of list l to the empty list n */
+rt_inline void rt_timer_wheel_splice(rt_list_t *l, rt_list_t *n)
+{
+    rt_list_init(n);
+    if (rt_list_isempty(l))
+        return;
+
+    n->next = l->next;
+    n->prev = l->prev;
+    l->next->prev = n;
+    l->prev->next = n;
+    rt_list_init(l);
+}
+
+static rt_list_t *rt_timer_wheel_slot(struct rt_timer_wheel *wheel,
+                                      rt_tick_t              timeout_tick)
+{
+    rt_tick_t delta;
+    rt_ubase_t level;
+
+    delta = timeout_tick - wheel->tick;
+
+    /* the timer is already timeout, handle it in the next check */
+    if (delta >= RT_TICK_MAX / 2)
+        return &(wheel->slot[0][wheel->tick & RT_TIMER_WHEEL_MASK]);
+
+    for (level = 0; level < RT_TIMER_WHEEL_LEVEL - 1; level ++)
+    {
+        if (delta < RT_TIMER_WHEEL_SIZE)
+            break;
+
+        delta >>= RT_TIMER_WHEEL_BITS;
+    }
+
+    return &(wheel->slot[level][(timeout_tick >> (level * RT_TIMER_WHEEL_BITS)) &
+                                RT_TIMER_WHEEL_MASK]);
+}
+
+/*
+ * This function will put a timer to the wheel according to its timeout tick.
+ *
+ * @note the interrupt shall be disabled before invoking this function.
+ */
+static void rt_timer_wheel_insert(struct rt_timer_wheel *wheel,
+                                  struct rt_timer       *timer)
+{
+    if (!wheel->inited)
+        rt_timer_wheel_init(wheel);
+
+    /* an empty wheel has nothing to catch up with */
+    if (wheel->count == 0)
+        wheel->tick = rt_tick_get();
+    wheel->count ++;
+
+    /* the timer inserted early shall be called early */
+    rt_list_insert_before(rt_timer_wheel_slot(wheel, timer->timeout_tick),
+                          &(timer->list));
+}
+
+/*
+ * This function will remove a timer from the wheel.
+ *
+ * @note the interrupt shall be disabled before invoking this function.
+ */
+static void rt_timer_wheel_remove(struct rt_timer_wheel *wheel,
+                                  struct rt_timer       *timer)
+{
+    if (!rt_list_isempty(&(timer->list)))
+        wheel->count --;
+
+    rt_list_remove(&(timer->list));
+}
+
+/*
+ * This function will handle all the ticks which are not handled yet on the
+ * wheel, and invoke the timeout function of the timers timeout.
+ *
+ * The timeout function is invoked with the interrupt status of the caller.
+ */
+static void rt_timer_wheel_check(struct rt_timer_wheel *wheel)
+{
+    struct rt_timer *t;
+    rt_list_t timer_list;
+    rt_ubase_t level, index;
+    register rt_base_t temp;
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    if (!wheel->inited)
+        rt_timer_wheel_init(wheel);
+
+    while ((rt_tick_get() - wheel->tick) < RT_TICK_MAX / 2)
+    {
+        if (wheel->count == 0)
+        {
+            /* no timer on the wheel, skip the remaining ticks */
+            wheel->tick = rt_tick_get() + 1;
+            break;
+        }
+
+        /* cascade the upper levels when the lower level wraps around */
+        index = wheel->tick & RT_TIMER_WHEEL_MASK;
+        for (level = 1; index == 0 && level < RT_TIMER_WHEEL_LEVEL; level ++)
+        {
+            index = (wheel->tick >> (level * RT_TIMER_WHEEL_BITS)) &
+                    RT_TIMER_WHEEL_MASK;
+
+            rt_timer_wheel_splice(&(wheel->slot[level][index]), &timer_list);
+            while (!rt_list_isempty(&timer_list))
+            {
+                t = rt_list_entry(timer_list.next, struct rt_timer, list);
+                rt_list_remove(&(t->list));
+                rt_list_insert_before(rt_timer_wheel_slot(wheel, t->timeout_tick),
+                                      &(t->list));
+            }
+        }
+
+        /* move the timeout timers to the local list */
+        rt_timer_wheel_splice(&(wheel->slot[0][wheel->tick & RT_TIMER_WHEEL_MASK]),
+                              &timer_list);
+
+        /* the timer restarted in timeout function goes to the next tick */
+        wheel->tick ++;
+
+        while (!rt_list_isempty(&timer_list))
+        {
+            t = rt_list_entry(timer_list.next, struct rt_timer, list);
+
+            RT_OBJECT_HOOK_CALL(rt_timer_timeout_hook, (t));
+
+            /* remove timer from timer list firstly */
+            rt_timer_wheel_remove(wheel, t);
+
+            rt_hw_interrupt_enable(temp);
+
+            /* call timeout function */
+            t->timeout_func(t->parameter);
+
+            temp = rt_hw_interrupt_disable();
+
+            if ((t->parent.flag & RT_TIMER_FLAG_PERIODIC) &&
+                (t->parent.flag & RT_TIMER_FLAG_ACTIVATED))
+            {
+                /* start it */
+                t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+                rt_timer_start(t);
+            }
+            else
+            {
+                /* stop timer */
+                t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+            }
+        }
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+}
+
+static rt_tick_t rt_timer_wheel_next_timeout(struct rt_timer_wheel *wheel)
+{
+    struct rt_timer *t;
+    rt_list_t *slot, *n;
+    rt_ubase_t level, index, offset;
+    rt_tick_t timeout_tick;
+    rt_bool_t found;
+    register rt_base_t temp;
+
+    timeout_tick = RT_TICK_MAX;
+    found = RT_FALSE;
+
+    /* disable interrupt */
+    temp = rt_hw_interrupt_disable();
+
+    for (level = 0; wheel->inited && level < RT_TIMER_WHEEL_LEVEL; level ++)
+    {
+        index = (wheel->tick >> (level * RT_TIMER_WHEEL_BITS)) &
+                RT_TIMER_WHEEL_MASK;
+
+        /*
+         * The current slot of an upper level may hold the timers of this
+         * round (not cascaded yet) or of the next round, so it's always
+         * checked. For the other slots, the first non-empty one has the
+         * earliest timers on this level.
+         */
+        for (offset = 0; offset < RT_TIMER_WHEEL_SIZE; offset ++)
+        {
+            slot = &(wheel->slot[level][(index + offset) & RT_TIMER_WHEEL_MASK]);
+            if (rt_list_isempty(slot))
+                continue;
+
+            for (n = slot->next; n != slot; n = n->next)
+            {
+                t = rt_list_entry(n, struct rt_timer, list);
+                if (found == RT_FALSE ||
+                    (timeout_tick - t->timeout_tick) < RT_TICK_MAX / 2)
+                {
+                    timeout_tick = t->timeout_tick;
+                    found = RT_TRUE;
+                }
+            }
+
+            if (offset != 0)
+                break;
+        }
+    }
+
+    /* enable interrupt */
+    rt_hw_interrupt_enable(temp);
+
+    return timeout_tick;
+}
+#else
 static rt_tick_t rt_timer_list_next_timeout(rt_list_t *timer_list)
 {
     struct rt_timer *timer;
@@ -110,6 +376,22 @@ static rt_tick_t rt_timer_list_next_timeout(rt_list_t *timer_list)
 
     return timer->timeout_tick;
 }
+#endif
+
+/* remove the timer from the timer list or wheel, interrupt shall be disabled */
+rt_inline void rt_timer_remove(rt_timer_t timer)
+{
+#ifdef RT_USING_TIMER_WHEEL
+#ifdef RT_USING_TIMER_SOFT
+    if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
+        rt_timer_wheel_remove(&rt_soft_timer_wheel, timer);
+    else
+#endif
+        rt_timer_wheel_remove(&rt_timer_wheel, timer);
+#else
+    rt_list_remove(&(timer->list));
+#endif
+}
 
 /**
  * @addtogroup Clock
@@ -163,7 +445,7 @@ rt_err_t rt_timer_detach(rt_timer_t timer)
     level = rt_hw_interrupt_disable();
 
     /* remove it from timer list */
-    rt_list_remove(&(timer->list));
+    rt_timer_remove(timer);
 
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
@@ -225,7 +507,7 @@ rt_err_t rt_timer_delete(rt_timer_t timer)
     level = rt_hw_interrupt_disable();
 
     /* remove it from timer list */
-    rt_list_remove(&(timer->list));
+    rt_timer_remove(timer);
 
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
@@ -246,9 +528,13 @@ RTM_EXPORT(rt_timer_delete);
  */
 rt_err_t rt_timer_start(rt_timer_t timer)
 {
-    struct rt_timer *t;
     register rt_base_t level;
+#ifdef RT_USING_TIMER_WHEEL
+    struct rt_timer_wheel *timer_wheel;
+#else
+    struct rt_timer *t;
     rt_list_t *n, *timer_list;
+#endif
 
     /* timer check */
     RT_ASSERT(timer != RT_NULL);
@@ -267,6 +553,22 @@ rt_err_t rt_timer_start(rt_timer_t timer)
     /* disable interrupt */
     level = rt_hw_interrupt_disable();
 
+#ifdef RT_USING_TIMER_WHEEL
+#ifdef RT_USING_TIMER_SOFT
+    if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
+    {
+        /* insert timer to soft timer wheel */
+        timer_wheel = &rt_soft_timer_wheel;
+    }
+    else
+#endif
+    {
+        /* insert timer to system timer wheel */
+        timer_wheel = &rt_timer_wheel;
+    }
+
+    rt_timer_wheel_insert(timer_wheel, timer);
+#else
 #ifdef RT_USING_TIMER_SOFT
     if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
     {
@@ -305,6 +607,7 @@ rt_err_t rt_timer_start(rt_timer_t timer)
     {
         rt_list_insert_before(n, &(timer->list));
     }
+#endif
 
     timer->parent.flag |= RT_TIMER_FLAG_ACTIVATED;
 
@@ -350,7 +653,7 @@ rt_err_t rt_timer_stop(rt_timer_t timer)
     level = rt_hw_interrupt_disable();
 
     /* remove it from timer list */
-    rt_list_remove(&(timer->list));
+    rt_timer_remove(timer);
 
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
@@ -407,12 +710,20 @@ RTM_EXPORT(rt_timer_control);
  */
 void rt_timer_check(void)
 {
+#ifndef RT_USING_TIMER_WHEEL
     struct rt_timer *t;
     rt_tick_t current_tick;
+#endif
     register rt_base_t level;
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("timer check enter\n"));
 
+#ifdef RT_USING_TIMER_WHEEL
+    /* disable interrupt */
+    level = rt_hw_interrupt_disable();
+
+    rt_timer_wheel_check(&rt_timer_wheel);
+#else
     current_tick = rt_tick_get();
 
     /* disable interrupt */
@@ -457,6 +768,7 @@ void rt_timer_check(void)
         else
             break;
     }
+#endif
 
     /* enable interrupt */
     rt_hw_interrupt_enable(level);
@@ -471,7 +783,11 @@ void rt_timer_check(void)
  */
 rt_tick_t rt_timer_next_timeout_tick(void)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    return rt_timer_wheel_next_timeout(&rt_timer_wheel);
+#else
     return rt_timer_list_next_timeout(&rt_timer_list);
+#endif
 }
 
 #ifdef RT_USING_TIMER_SOFT
@@ -481,6 +797,11 @@ rt_tick_t rt_timer_next_timeout_tick(void)
  */
 void rt_soft_timer_check(void)
 {
+#ifdef RT_USING_TIMER_WHEEL
+    RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check enter\n"));
+
+    rt_timer_wheel_check(&rt_soft_timer_wheel);
+#else
     rt_tick_t current_tick;
     rt_list_t *n;
     struct rt_timer *t;
@@ -530,6 +851,7 @@ void rt_soft_timer_check(void)
         }
         else break; /* not check anymore */
     }
+#endif
 
     RT_DEBUG_LOG(RT_DEBUG_TIMER, ("software timer check leave\n"));
 }
@@ -542,7 +864,11 @@ static void rt_thread_timer_entry(void *parameter)
     while (1)
     {
         /* get the next timeout tick */
+#ifdef RT_USING_TIMER_WHEEL
+        next_timeout = rt_timer_wheel_next_timeout(&rt_soft_timer_wheel);
+#else
         next_timeout = rt_timer_list_next_timeout(&rt_soft_timer_list);
+#endif
         if (next_timeout == RT_TICK_MAX)
         {
             /* no software timer exist, suspend self. */
@@ -594,7 +920,11 @@ void rt_system_timer_init(void)
 void rt_system_timer_thread_init(void)
 {
 #ifdef RT_USING_TIMER_SOFT
+#ifdef RT_USING_TIMER_WHEEL
+    rt_timer_wheel_init(&rt_soft_timer_wheel);
+#else
     rt_list_init(&rt_soft_timer_list);
+#endif
 
     /* start software timer thread */
     rt_thread_init(&timer_thread,
@@ -0,0 +1,666 @@
+/*
+ * File      : tlsf.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2013, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Two-Level Segregated Fit memory allocator.
+ *
+ * The free blocks are kept in lists segregated by size: the first level is
+ * the power of two of the size, and the second level splits each power of two
+ * range into TLSF_SL_COUNT linear classes. Two levels of bitmaps record which
+ * lists are not empty, so a suitable free block is found by two bit scans,
+ * and a block is merged with its physical neighbours by the boundary tags.
+ * Both rt_malloc and rt_free are done in constant time.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#if defined (RT_USING_HEAP) && defined (RT_USING_TLSF)
+#if defined (RT_USING_SMALL_MEM) || defined (RT_USING_SLAB) || defined (RT_USING_MEMHEAP_AS_HEAP)
+#error "only one heap backend shall be selected"
+#endif
+
+#ifdef RT_USING_HOOK
+static void (*rt_malloc_hook)(void *ptr, rt_size_t size);
+static void (*rt_free_hook)(void *ptr);
+
+/**
+ * @addtogroup Hook
+ */
+
+/*@{*/
+
+/**
+ * This function will set a hook function, which will be invoked when a memory
+ * block is allocated from heap memory.
+ *
+ * @param hook the hook function
+ */
+void rt_malloc_sethook(void (*hook)(void *ptr, rt_size_t size))
+{
+    rt_malloc_hook = hook;
+}
+
+/**
+ * This function will set a hook function, which will be invoked when a memory
+ * block is released to heap memory.
+ *
+ * @param hook the hook function
+ */
+void rt_free_sethook(void (*hook)(void *ptr))
+{
+    rt_free_hook = hook;
+}
+
+/*@}*/
+
+#endif
+
+/* log2 of the number of second level classes */
+#define TLSF_SL_LOG2            4
+#define TLSF_SL_COUNT           (1 << TLSF_SL_LOG2)
+/* the blocks smaller than TLSF_SMALL_SIZE are in the first level 0 */
+#define TLSF_FL_SHIFT           (TLSF_SL_LOG2 + 3)
+#define TLSF_SMALL_SIZE         (1 << TLSF_FL_SHIFT)
+/* the max block size is 2^TLSF_FL_MAX */
+#define TLSF_FL_MAX             31
+#define TLSF_FL_COUNT           (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+/* the flags in the low bits of block size */
+#define TLSF_BLOCK_FREE         0x01
+#define TLSF_BLOCK_PREV_FREE    0x02
+#define TLSF_BLOCK_FLAGS        0x03
+
+struct tlsf_block
+{
+    /* the previous block in physical order */
+    struct tlsf_block *prev_phys;
+    /* the size of block data and the flags */
+    rt_size_t size;
+
+    /* the free list links, which are in block data of free block */
+    struct tlsf_block *next_free;
+    struct tlsf_block *prev_free;
+};
+
+#define TLSF_HEADER_SIZE        RT_ALIGN(2 * sizeof(void *), RT_ALIGN_SIZE)
+#define TLSF_MIN_SIZE           RT_ALIGN(2 * sizeof(void *), RT_ALIGN_SIZE)
+
+#define TLSF_BLOCK_SIZE(b)      ((b)->size & ~(rt_size_t)TLSF_BLOCK_FLAGS)
+#define TLSF_BLOCK_DATA(b)      ((void *)((rt_uint8_t *)(b) + TLSF_HEADER_SIZE))
+#define TLSF_DATA_BLOCK(p)      ((struct tlsf_block *)((rt_uint8_t *)(p) - TLSF_HEADER_SIZE))
+#define TLSF_BLOCK_NEXT(b)      ((struct tlsf_block *)((rt_uint8_t *)TLSF_BLOCK_DATA(b) + TLSF_BLOCK_SIZE(b)))
+
+static rt_uint32_t tlsf_fl_bitmap;
+static rt_uint32_t tlsf_sl_bitmap[TLSF_FL_COUNT];
+static struct tlsf_block *tlsf_free_list[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+/** the heap range, the last block is a used sentinel with no data */
+static rt_uint8_t *heap_ptr;
+static struct tlsf_block *heap_end;
+
+static rt_size_t mem_size_aligned;
+static rt_size_t used_mem, max_mem;
+
+/*
+ * This function will return the index of the most significant bit set, or -1
+ * if no bit is set.
+ */
+rt_inline int tlsf_fls(rt_uint32_t word)
+{
+    int bit = 31;
+
+    if (word == 0)
+        return -1;
+
+    if (!(word & 0xffff0000)) { word <<= 16; bit -= 16; }
+    if (!(word & 0xff000000)) { word <<= 8;  bit -= 8;  }
+    if (!(word & 0xf0000000)) { word <<= 4;  bit -= 4;  }
+    if (!(word & 0xc0000000)) { word <<= 2;  bit -= 2;  }
+    if (!(word & 0x80000000)) { bit -= 1; }
+
+    return bit;
+}
+
+/*
+ * This function will return the index of the least significant bit set, or -1
+ * if no bit is set.
+ */
+rt_inline int tlsf_ffs(rt_uint32_t word)
+{
+    return tlsf_fls(word & (~word + 1));
+}
+
+/*
+ * This function will get the list index of a block size.
+ */
+rt_inline void tlsf_mapping(rt_size_t size, int *fl, int *sl)
+{
+    if (size < TLSF_SMALL_SIZE)
+    {
+        *fl = 0;
+        *sl = (int)size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT);
+    }
+    else
+    {
+        *fl = tlsf_fls((rt_uint32_t)size);
+        *sl = (int)(size >> (*fl - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl -= TLSF_FL_SHIFT - 1;
+    }
+}
+
+/*
+ * This function will round up an allocation size to the next list, so that
+ * any block in the list is large enough.
+ */
+rt_inline rt_size_t tlsf_round_up(rt_size_t size)
+{
+    if (size < TLSF_SMALL_SIZE)
+        return RT_ALIGN(size, TLSF_SMALL_SIZE / TLSF_SL_COUNT);
+
+    return size + ((rt_size_t)1 << (tlsf_fls((rt_uint32_t)size) - TLSF_SL_LOG2)) - 1;
+}
+
+static void tlsf_insert_free(struct tlsf_block *block)
+{
+    int fl, sl;
+    struct tlsf_block *head;
+
+    tlsf_mapping(TLSF_BLOCK_SIZE(block), &fl, &sl);
+
+    head = tlsf_free_list[fl][sl];
+    block->next_free = head;
+    block->prev_free = RT_NULL;
+    if (head != RT_NULL)
+        head->prev_free = block;
+    tlsf_free_list[fl][sl] = block;
+
+    tlsf_fl_bitmap     |= 1UL << fl;
+    tlsf_sl_bitmap[fl] |= 1UL << sl;
+}
+
+static void tlsf_remove_free(struct tlsf_block *block)
+{
+    int fl, sl;
+
+    tlsf_mapping(TLSF_BLOCK_SIZE(block), &fl, &sl);
+
+    if (block->next_free != RT_NULL)
+        block->next_free->prev_free = block->prev_free;
+    if (block->prev_free != RT_NULL)
+        block->prev_free->next_free = block->next_free;
+    else
+    {
+        /* it's the head of list */
+        tlsf_free_list[fl][sl] = block->next_free;
+        if (block->next_free == RT_NULL)
+        {
+            tlsf_sl_bitmap[fl] &= ~(1UL << sl);
+            if (tlsf_sl_bitmap[fl] == 0)
+                tlsf_fl_bitmap &= ~(1UL << fl);
+        }
+    }
+}
+
+/*
+ * This function will find a free block not smaller than size, and remove it
+ * from the free list.
+ */
+static struct tlsf_block *tlsf_find_free(rt_size_t size)
+{
+    int fl, sl;
+    rt_uint32_t map;
+    struct tlsf_block *block;
+
+    tlsf_mapping(tlsf_round_up(size), &fl, &sl);
+    if (fl >= TLSF_FL_COUNT)
+        return RT_NULL;
+
+    /* the lists in the same first level */
+    map = tlsf_sl_bitmap[fl] & (~0UL << sl);
+    if (map == 0)
+    {
+        /* the lists in the larger first levels */
+        if (fl + 1 >= TLSF_FL_COUNT)
+            return RT_NULL;
+        map = tlsf_fl_bitmap & (~0UL << (fl + 1));
+        if (map == 0)
+            return RT_NULL;
+
+        fl  = tlsf_ffs(map);
+        map = tlsf_sl_bitmap[fl];
+    }
+    sl = tlsf_ffs(map);
+
+    block = tlsf_free_list[fl][sl];
+    tlsf_remove_free(block);
+
+    return block;
+}
+
+/*
+ * This function will split the tail of block beyond size into a free block.
+ */
+static void tlsf_split(struct tlsf_block *block, rt_size_t size)
+{
+    struct tlsf_block *remain, *next;
+    rt_size_t remain_size;
+
+    if (TLSF_BLOCK_SIZE(block) < size + TLSF_HEADER_SIZE + TLSF_MIN_SIZE)
+        return;
+
+    remain_size = TLSF_BLOCK_SIZE(block) - size - TLSF_HEADER_SIZE;
+    block->size = size | (block->size & TLSF_BLOCK_FLAGS);
+
+    remain = TLSF_BLOCK_NEXT(block);
+    remain->prev_phys = block;
+    remain->size = remain_size | TLSF_BLOCK_FREE;
+    if (block->size & TLSF_BLOCK_FREE)
+        remain->size |= TLSF_BLOCK_PREV_FREE;
+
+    next = TLSF_BLOCK_NEXT(remain);
+    next->prev_phys = remain;
+
+    /* merge the remainder with the next free block */
+    if (next->size & TLSF_BLOCK_FREE)
+    {
+        tlsf_remove_free(next);
+        remain->size += TLSF_HEADER_SIZE + TLSF_BLOCK_SIZE(next);
+        TLSF_BLOCK_NEXT(remain)->prev_phys = remain;
+    }
+    else
+    {
+        next->size |= TLSF_BLOCK_PREV_FREE;
+    }
+
+    tlsf_insert_free(remain);
+}
+
+/**
+ * @ingroup SystemInit
+ *
+ * This function will init system heap
+ *
+ * @param begin_addr the beginning address of system page
+ * @param end_addr the end address of system page
+ */
+void rt_system_heap_init(void *begin_addr, void *end_addr)
+{
+    struct tlsf_block *block;
+    rt_ubase_t begin_align = RT_ALIGN((rt_ubase_t)begin_addr, RT_ALIGN_SIZE);
+    rt_ubase_t end_align = RT_ALIGN_DOWN((rt_ubase_t)end_addr, RT_ALIGN_SIZE);
+
+    RT_DEBUG_NOT_IN_INTERRUPT;
+
+    /* one free block and the end sentinel */
+    if ((end_align > (2 * TLSF_HEADER_SIZE + TLSF_MIN_SIZE)) &&
+        ((end_align - 2 * TLSF_HEADER_SIZE - TLSF_MIN_SIZE) >= begin_align))
+    {
+        /* calculate the aligned memory size */
+        mem_size_aligned = end_align - begin_align - 2 * TLSF_HEADER_SIZE;
+    }
+    else
+    {
+        rt_kprintf("mem init, error begin address 0x%x, and end address 0x%x\n",
+                   (rt_uint32_t)begin_addr, (rt_uint32_t)end_addr);
+
+        return;
+    }
+
+    /* the max block size is limited by the first level */
+    if (mem_size_aligned >> TLSF_FL_MAX)
+        mem_size_aligned = RT_ALIGN_DOWN(((rt_size_t)1 << TLSF_FL_MAX) - 1, RT_ALIGN_SIZE);
+
+    /* point to begin address of heap */
+    heap_ptr = (rt_uint8_t *)begin_align;
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM, ("tlsf init, heap begin address 0x%x, size %d\n",
+                                (rt_uint32_t)heap_ptr, mem_size_aligned));
+
+    /* initialize the whole free block */
+    block = (struct tlsf_block *)heap_ptr;
+    block->prev_phys = RT_NULL;
+    block->size = mem_size_aligned | TLSF_BLOCK_FREE;
+
+    /* initialize the end of the heap */
+    heap_end = TLSF_BLOCK_NEXT(block);
+    heap_end->prev_phys = block;
+    heap_end->size = 0 | TLSF_BLOCK_PREV_FREE;
+
+    tlsf_insert_free(block);
+}
+
+/**
+ * @addtogroup MM
+ */
+
+/*@{*/
+
+/**
+ * Allocate a block of memory with a minimum of 'size' bytes.
+ *
+ * @param size is the minimum size of the requested block in bytes.
+ *
+ * @return pointer to allocated memory or NULL if no free memory was found.
+ */
+void *rt_malloc(rt_size_t size)
+{
+    register rt_base_t level;
+    struct tlsf_block *block;
+
+    if (size == 0)
+        return RT_NULL;
+
+    /* alignment size */
+    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    if (size < TLSF_MIN_SIZE)
+        size = TLSF_MIN_SIZE;
+
+    if (size > mem_size_aligned)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+
+    /* the operations are bounded, lock heap by disabling interrupt */
+    level = rt_hw_interrupt_disable();
+
+    block = tlsf_find_free(size);
+    if (block == RT_NULL)
+    {
+        rt_hw_interrupt_enable(level);
+
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("no memory\n"));
+
+        return RT_NULL;
+    }
+
+    tlsf_split(block, size);
+
+    /* mark the block as used */
+    block->size &= ~(rt_size_t)TLSF_BLOCK_FREE;
+    TLSF_BLOCK_NEXT(block)->size &= ~(rt_size_t)TLSF_BLOCK_PREV_FREE;
+
+    used_mem += TLSF_BLOCK_SIZE(block) + TLSF_HEADER_SIZE;
+    if (max_mem < used_mem)
+        max_mem = used_mem;
+
+    rt_hw_interrupt_enable(level);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM,
+                 ("allocate memory at 0x%x, size: %d\n",
+                  (rt_uint32_t)TLSF_BLOCK_DATA(block),
+                  (rt_uint32_t)TLSF_BLOCK_SIZE(block)));
+
+    RT_OBJECT_HOOK_CALL(rt_malloc_hook, (TLSF_BLOCK_DATA(block), size));
+    RT_MEM_PROFILE_ALLOC(TLSF_BLOCK_DATA(block), size);
+
+    return TLSF_BLOCK_DATA(block);
+}
+RTM_EXPORT(rt_malloc);
+
+/**
+ * This function will change the previously allocated memory block.
+ *
+ * @param rmem pointer to memory allocated by rt_malloc
+ * @param newsize the required new size
+ *
+ * @return the changed memory block address
+ */
+void *rt_realloc(void *rmem, rt_size_t newsize)
+{
+    register rt_base_t level;
+    struct tlsf_block *block, *next;
+    rt_size_t size;
+    void *nmem;
+
+    /* allocate a new memory block */
+    if (rmem == RT_NULL)
+    {
+        nmem = rt_malloc(newsize);
+        RT_MEM_PROFILE_ALLOC(nmem, newsize);
+
+        return nmem;
+    }
+
+    if (newsize == 0)
+    {
+        rt_free(rmem);
+
+        return RT_NULL;
+    }
+
+    /* alignment size */
+    newsize = RT_ALIGN(newsize, RT_ALIGN_SIZE);
+    if (newsize < TLSF_MIN_SIZE)
+        newsize = TLSF_MIN_SIZE;
+    if (newsize > mem_size_aligned)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("realloc: out of memory\n"));
+
+        return RT_NULL;
+    }
+
+    if ((rt_uint8_t *)rmem < (rt_uint8_t *)heap_ptr ||
+        (rt_uint8_t *)rmem >= (rt_uint8_t *)heap_end)
+    {
+        /* illegal memory */
+        return rmem;
+    }
+
+    block = TLSF_DATA_BLOCK(rmem);
+
+    level = rt_hw_interrupt_disable();
+
+    size = TLSF_BLOCK_SIZE(block);
+    next = TLSF_BLOCK_NEXT(block);
+
+    /* expand the block to the next free block in place */
+    if (newsize > size && (next->size & TLSF_BLOCK_FREE) &&
+        size + TLSF_HEADER_SIZE + TLSF_BLOCK_SIZE(next) >= newsize)
+    {
+        tlsf_remove_free(next);
+        block->size += TLSF_HEADER_SIZE + TLSF_BLOCK_SIZE(next);
+        next = TLSF_BLOCK_NEXT(block);
+        next->prev_phys = block;
+        next->size &= ~(rt_size_t)TLSF_BLOCK_PREV_FREE;
+    }
+
+    if (newsize <= TLSF_BLOCK_SIZE(block))
+    {
+        /* shrink the block in place */
+        tlsf_split(block, newsize);
+
+        used_mem = used_mem - size + TLSF_BLOCK_SIZE(block);
+        if (max_mem < used_mem)
+            max_mem = used_mem;
+
+        rt_hw_interrupt_enable(level);
+
+        RT_MEM_PROFILE_ALLOC(rmem, newsize);
+
+        return rmem;
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    /* move to a new memory block */
+    nmem = rt_malloc(newsize);
+    if (nmem != RT_NULL)
+    {
+        rt_memcpy(nmem, rmem, size < newsize ? size : newsize);
+        rt_free(rmem);
+    }
+    RT_MEM_PROFILE_ALLOC(nmem, newsize);
+
+    return nmem;
+}
+RTM_EXPORT(rt_realloc);
+
+/**
+ * This function will contiguously allocate enough space for count objects
+ * that are size bytes of memory each and returns a pointer to the allocated
+ * memory.
+ *
+ * The allocated memory is filled with bytes of value zero.
+ *
+ * @param count number of objects to allocate
+ * @param size size of the objects to allocate
+ *
+ * @return pointer to allocated memory / NULL pointer if there is an error
+ */
+void *rt_calloc(rt_size_t count, rt_size_t size)
+{
+    void *p;
+
+    /* allocate 'count' objects of size 'size' */
+    p = rt_malloc(count * size);
+
+    /* zero the memory */
+    if (p)
+        rt_memset(p, 0, count * size);
+    RT_MEM_PROFILE_ALLOC(p, count * size);
+
+    return p;
+}
+RTM_EXPORT(rt_calloc);
+
+/**
+ * This function will release the previously allocated memory block by
+ * rt_malloc. The released memory block is taken back to system heap.
+ *
+ * @param rmem the address of memory which will be released
+ */
+void rt_free(void *rmem)
+{
+    register rt_base_t level;
+    struct tlsf_block *block, *prev, *next;
+
+    if (rmem == RT_NULL)
+        return;
+    RT_ASSERT((((rt_ubase_t)rmem) & (RT_ALIGN_SIZE-1)) == 0);
+    RT_ASSERT((rt_uint8_t *)rmem >= (rt_uint8_t *)heap_ptr &&
+              (rt_uint8_t *)rmem < (rt_uint8_t *)heap_end);
+
+    RT_OBJECT_HOOK_CALL(rt_free_hook, (rmem));
+    RT_MEM_PROFILE_FREE(rmem);
+
+    if ((rt_uint8_t *)rmem < (rt_uint8_t *)heap_ptr ||
+        (rt_uint8_t *)rmem >= (rt_uint8_t *)heap_end)
+    {
+        RT_DEBUG_LOG(RT_DEBUG_MEM, ("illegal memory\n"));
+
+        return;
+    }
+
+    block = TLSF_DATA_BLOCK(rmem);
+
+    RT_DEBUG_LOG(RT_DEBUG_MEM,
+                 ("release memory 0x%x, size: %d\n",
+                  (rt_uint32_t)rmem,
+                  (rt_uint32_t)TLSF_BLOCK_SIZE(block)));
+
+    level = rt_hw_interrupt_disable();
+
+    /* it has to be in a used state */
+    RT_ASSERT(!(block->size & TLSF_BLOCK_FREE));
+
+    used_mem -= TLSF_BLOCK_SIZE(block) + TLSF_HEADER_SIZE;
+    block->size |= TLSF_BLOCK_FREE;
+
+    /* merge with the previous free block */
+    if (block->size & TLSF_BLOCK_PREV_FREE)
+    {
+        prev = block->prev_phys;
+        tlsf_remove_free(prev);
+        prev->size += TLSF_HEADER_SIZE + TLSF_BLOCK_SIZE(block);
+        block = prev;
+        TLSF_BLOCK_NEXT(block)->prev_phys = block;
+    }
+
+    /* merge with the next free block */
+    next = TLSF_BLOCK_NEXT(block);
+    if (next->size & TLSF_BLOCK_FREE)
+    {
+        tlsf_remove_free(next);
+        block->size += TLSF_HEADER_SIZE + TLSF_BLOCK_SIZE(next);
+        next = TLSF_BLOCK_NEXT(block);
+        next->prev_phys = block;
+    }
+    next->size |= TLSF_BLOCK_PREV_FREE;
+
+    tlsf_insert_free(block);
+
+    rt_hw_interrupt_enable(level);
+}
+RTM_EXPORT(rt_free);
+
+void rt_memory_info(rt_uint32_t *total,
+                    rt_uint32_t *used,
+                    rt_uint32_t *max_used)
+{
+    if (total != RT_NULL)
+        *total = mem_size_aligned;
+    if (used  != RT_NULL)
+        *used = used_mem;
+    if (max_used != RT_NULL)
+        *max_used = max_mem;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+void list_mem(void)
+{
+    rt_uint32_t fl, sl, count;
+    rt_size_t largest;
+    struct tlsf_block *block;
+    register rt_base_t level;
+
+    /* the largest free block is in the highest non-empty list */
+    count = 0;
+    largest = 0;
+    level = rt_hw_interrupt_disable();
+    for (fl = 0; fl < TLSF_FL_COUNT; fl ++)
+    {
+        for (sl = 0; sl < TLSF_SL_COUNT; sl ++)
+        {
+            for (block = tlsf_free_list[fl][sl]; block != RT_NULL; block = block->next_free)
+            {
+                if (TLSF_BLOCK_SIZE(block) > largest)
+                    largest = TLSF_BLOCK_SIZE(block);
+                count ++;
+            }
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    rt_kprintf("total memory: %d\n", mem_size_aligned);
+    rt_kprintf("used memory : %d\n", used_mem);
+    rt_kprintf("maximum allocated memory: %d\n", max_mem);
+    rt_kprintf("free blocks : %d, largest free block: %d\n", count, largest);
+}
+FINSH_FUNCTION_EXPORT(list_mem, list memory usage information)
+#endif
+
+/*@}*/
+
+#endif /* end of RT_USING_HEAP && RT_USING_TLSF */
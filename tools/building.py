@@ -114,6 +114,14 @@ def PrepareBuilding(env, root_directory, has_libcpu=False, remove_components = [
         # found or something like that).
         rtconfig.POST_ACTION = ''
 
+    # add memory budget option
+    AddOption('--mem-budget',
+                      dest='mem-budget',
+                      action='store_true',
+                      default=False,
+                      help='print RAM/ROM usage of each component from the map file after linking. '+\
+                           'The build fails if MEM_BUDGET in rtconfig.py is exceeded.')
+
     # add build library option
     AddOption('--buildlib', 
                       dest='buildlib', 
@@ -349,6 +357,10 @@ def EndBuilding(target, program = None):
 
     Env.AddPostAction(target, rtconfig.POST_ACTION)
 
+    if (GetOption('mem-budget') or hasattr(rtconfig, 'MEM_BUDGET')) and not GetOption('buildlib'):
+        from membudget import MemBudgetAction
+        Env.AddPostAction(target, Action(MemBudgetAction(Projects), None))
+
     if GetOption('target') == 'mdk':
         template = os.path.isfile('template.Uv2')
         if template:
@@ -0,0 +1,319 @@
+#
+# Memory budget report of components, which is generated from the map file
+# of linker after the program is linked.
+#
+# Each input section in the map file is charged to the component (the name of
+# DefineGroup in SConscript) which its object file belongs to:
+#   ROM = code + read-only data + initialized data (the load image of .data)
+#   RAM = initialized data + zero-initialized data (.bss, COMMON, stack)
+# The fill and space reserved by linker script (such as the system stack) is
+# charged to 'Linker', and the members of libraries out of the project (libc
+# etc.) are charged to 'Libraries'.
+#
+# The budget is configured in rtconfig.py of BSP, for example:
+#
+#   MEM_BUDGET = {
+#       'Total'  : (48 * 1024, 256 * 1024),  # (RAM, ROM) in bytes
+#       'Kernel' : (4 * 1024, None),         # None means no budget
+#   }
+#
+# The build fails if any component exceeds its budget. The report is printed
+# when MEM_BUDGET is defined or scons is invoked with --mem-budget.
+#
+# The GNU ld map (-Wl,-Map=xxx.map) and the armlink listing
+# (--info sizes --list xxx.map) are supported.
+#
+
+import os
+import re
+
+from SCons.Script import *
+
+def _is_ram(name):
+    for key in ('bss', 'noinit', 'stack', 'heap', 'COMMON'):
+        if name.find(key) >= 0:
+            return True
+    return False
+
+def _is_data(name):
+    return name.find('data') >= 0 and name.find('rodata') < 0
+
+def _is_debug(name):
+    for key in ('.debug', '.comment', '.stab', '.note', '.ARM.attributes', '.gnu_debug'):
+        if name.startswith(key):
+            return True
+    return False
+
+class Component:
+    def __init__(self, name):
+        self.name = name
+        self.ram  = 0
+        self.rom  = 0
+        self.objs = {}
+
+    def add(self, obj, ram, rom):
+        self.ram = self.ram + ram
+        self.rom = self.rom + rom
+
+        if not self.objs.has_key(obj):
+            self.objs[obj] = [0, 0]
+        self.objs[obj][0] = self.objs[obj][0] + ram
+        self.objs[obj][1] = self.objs[obj][1] + rom
+
+class ObjectMap:
+    def __init__(self, projects, objsuffix):
+        self.path = {}
+        self.base = {}
+
+        for group in projects:
+            for item in group['src']:
+                if type(item) == type('str'):
+                    fn = os.path.abspath(item)
+                else:
+                    fn = item.abspath
+                fn = os.path.splitext(fn)[0] + objsuffix
+
+                self.path[os.path.normcase(fn)] = group['name']
+                self.base[os.path.basename(fn)] = group['name']
+
+    def group(self, obj):
+        # member of archive: libxxx.a(obj.o)
+        member = re.match(r'^(.*)\((.*)\)$', obj)
+        if member:
+            if self.base.has_key(member.group(2)):
+                return self.base[member.group(2)]
+            return 'Libraries'
+
+        fn = os.path.normcase(os.path.abspath(obj))
+        if self.path.has_key(fn):
+            return self.path[fn]
+        if self.base.has_key(os.path.basename(obj)):
+            return self.base[os.path.basename(obj)]
+
+        return 'Others'
+
+# charge the input section to component
+def _charge(comps, objmap, section, obj, size, name = None):
+    if size == 0 or _is_debug(section):
+        return
+
+    if _is_ram(section):
+        ram, rom = size, 0
+    elif _is_data(section):
+        ram, rom = size, size
+    else:
+        ram, rom = 0, size
+
+    if name == None:
+        name = objmap.group(obj)
+    if not comps.has_key(name):
+        comps[name] = Component(name)
+    comps[name].add(obj, ram, rom)
+
+# parse the memory map of GNU ld
+def ParseGNUMap(fn, objmap):
+    comps = {}
+    output = None
+    output_size = 0
+    input_size = 0
+    pending = None
+
+    lines = open(fn, 'r').readlines()
+    try:
+        start = [i for i, l in enumerate(lines) if l.startswith('Linker script and memory map')][0]
+    except IndexError:
+        return None
+
+    def _end_output():
+        # the rest of output section is fill or reserved by linker script
+        if output and output_size > input_size:
+            _charge(comps, objmap, output, output, output_size - input_size, 'Linker')
+
+    for line in lines[start + 1:]:
+        line = line.rstrip()
+        if not line:
+            continue
+
+        if line.startswith('OUTPUT('):
+            break
+
+        # output section: at the first column
+        if not line[0].isspace():
+            items = line.split()
+            if items[0] in ('LOAD', 'START', 'END') or not items[0].startswith('.'):
+                pending = None
+                continue
+
+            _end_output()
+            output = items[0]
+            output_size = 0
+            input_size = 0
+            pending = 'output'
+
+            if len(items) >= 3:
+                output_size = int(items[2], 16)
+                pending = None
+            continue
+
+        items = line.split()
+
+        # the long section name is wrapped to next line
+        if pending == 'output':
+            if len(items) >= 2 and items[0].startswith('0x'):
+                output_size = int(items[1], 16)
+            pending = None
+            continue
+
+        if pending:
+            pending = None
+            if len(items) >= 3 and items[0].startswith('0x') and items[1].startswith('0x'):
+                size = int(items[1], 16)
+                input_size = input_size + size
+                _charge(comps, objmap, output, ' '.join(items[2:]), size)
+            continue
+
+        # input section: ' .text  0x08000000  0x100 build/src/thread.o'
+        if items[0].startswith('.') or items[0] == 'COMMON' or items[0] == '*fill*':
+            if len(items) == 1:
+                pending = items[0]
+                continue
+
+            if len(items) >= 3 and items[1].startswith('0x') and items[2].startswith('0x'):
+                size = int(items[2], 16)
+                input_size = input_size + size
+                if items[0] != '*fill*' and len(items) >= 4:
+                    _charge(comps, objmap, output, ' '.join(items[3:]), size)
+                else:
+                    _charge(comps, objmap, output, output, size, 'Linker')
+
+    _end_output()
+
+    return comps
+
+# parse the image component sizes of armlink listing (--info sizes)
+def ParseArmccMap(fn, objmap):
+    comps = {}
+    found = False
+    library = False
+
+    pattern = re.compile(r'^\s*(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\S+)\s*$')
+    for line in open(fn, 'r').readlines():
+        if line.find('Library Member Name') >= 0:
+            library = True
+            found = True
+            continue
+        if line.find('Object Name') >= 0:
+            library = False
+            found = True
+            continue
+
+        m = pattern.match(line)
+        if not m:
+            continue
+
+        code, inc, ro, rw, zi, debug, obj = m.groups()
+        if library:
+            obj = 'library(' + obj + ')'
+
+        name = objmap.group(obj)
+        if not comps.has_key(name):
+            comps[name] = Component(name)
+        comps[name].add(obj, int(rw) + int(zi), int(code) + int(ro) + int(rw))
+
+    if not found:
+        return None
+    return comps
+
+def _map_file(lflags):
+    m = re.search(r'-Map[=,]([^\s,]+)', lflags)
+    if m:
+        return m.group(1), ParseGNUMap
+    m = re.search(r'--list\s+(\S+)', lflags)
+    if m:
+        return m.group(1), ParseArmccMap
+    return None, None
+
+def _over(used, budget):
+    return budget != None and used > budget
+
+def _budget(budgets, name):
+    if not budgets or not budgets.has_key(name):
+        return (None, None)
+    return budgets[name]
+
+def _show(value):
+    if value == None:
+        return '-'
+    return str(value)
+
+def MemBudgetReport(comps, budgets, verbose = False):
+    failed = []
+    names = comps.keys()
+    names.sort()
+
+    print '%-20s %10s %10s %10s %10s' % ('component', 'RAM', 'budget', 'ROM', 'budget')
+    print '-' * 64
+
+    total_ram = 0
+    total_rom = 0
+    for name in names:
+        comp = comps[name]
+        ram_budget, rom_budget = _budget(budgets, name)
+        flag = ''
+        if _over(comp.ram, ram_budget) or _over(comp.rom, rom_budget):
+            flag = ' <- over budget'
+            failed.append(name)
+
+        print '%-20s %10d %10s %10d %10s%s' % (name, comp.ram, _show(ram_budget),
+            comp.rom, _show(rom_budget), flag)
+
+        if verbose:
+            objs = comp.objs.keys()
+            objs.sort()
+            for obj in objs:
+                print '    %-36s %10d %10d' % (os.path.basename(obj), comp.objs[obj][0], comp.objs[obj][1])
+
+        total_ram = total_ram + comp.ram
+        total_rom = total_rom + comp.rom
+
+    ram_budget, rom_budget = _budget(budgets, 'Total')
+    flag = ''
+    if _over(total_ram, ram_budget) or _over(total_rom, rom_budget):
+        flag = ' <- over budget'
+        failed.append('Total')
+
+    print '-' * 64
+    print '%-20s %10d %10s %10d %10s%s' % ('Total', total_ram, _show(ram_budget),
+        total_rom, _show(rom_budget), flag)
+
+    for name in budgets or {}:
+        if name != 'Total' and not comps.has_key(name):
+            print 'warning: no component named %s in budget' % name
+
+    return failed
+
+def MemBudgetAction(projects):
+    import rtconfig
+
+    def action(target, source, env):
+        budgets = getattr(rtconfig, 'MEM_BUDGET', None)
+
+        fn, parse = _map_file(env.subst('$LINKFLAGS'))
+        if not fn or not os.path.isfile(fn):
+            print 'memory budget: no map file of linker is found, skipped.'
+            return 0
+
+        comps = parse(fn, ObjectMap(projects, env.subst('$OBJSUFFIX')))
+        if comps == None:
+            print 'memory budget: unknown format of map file %s, skipped.' % fn
+            return 0
+
+        print 'memory budget of %s (from %s):' % (str(target[0]), fn)
+        failed = MemBudgetReport(comps, budgets, GetOption('verbose'))
+        if failed:
+            print 'memory budget exceeded: %s' % ', '.join(failed)
+            return 1
+
+        return 0
+
+    return action